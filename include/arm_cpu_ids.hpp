@@ -0,0 +1,227 @@
+#ifndef _ARM_CPU_IDS_HPP
+#define _ARM_CPU_IDS_HPP
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// generated by scripts/generate_arm_cpu_ids.py from util-linux lscpu-arm.c
+
+struct arm_cpu_part_t
+{
+    std::uint32_t    midr = 0;  // (implementer << 12) | part
+    std::string_view vendor;
+    std::string_view name;
+};
+
+inline constexpr std::array<arm_cpu_part_t, 161> arm_cpu_parts_array = { {
+    { 0x41810, "ARM", "ARM810" },
+    { 0x41920, "ARM", "ARM920" },
+    { 0x41922, "ARM", "ARM922" },
+    { 0x41926, "ARM", "ARM926" },
+    { 0x41940, "ARM", "ARM940" },
+    { 0x41946, "ARM", "ARM946" },
+    { 0x41966, "ARM", "ARM966" },
+    { 0x41a20, "ARM", "ARM1020" },
+    { 0x41a22, "ARM", "ARM1022" },
+    { 0x41a26, "ARM", "ARM1026" },
+    { 0x41b02, "ARM", "ARM11 MPCore" },
+    { 0x41b36, "ARM", "ARM1136" },
+    { 0x41b56, "ARM", "ARM1156" },
+    { 0x41b76, "ARM", "ARM1176" },
+    { 0x41c05, "ARM", "Cortex-A5" },
+    { 0x41c07, "ARM", "Cortex-A7" },
+    { 0x41c08, "ARM", "Cortex-A8" },
+    { 0x41c09, "ARM", "Cortex-A9" },
+    { 0x41c0d, "ARM", "Cortex-A17" },
+    { 0x41c0e, "ARM", "Cortex-A17" },
+    { 0x41c0f, "ARM", "Cortex-A15" },
+    { 0x41c14, "ARM", "Cortex-R4" },
+    { 0x41c15, "ARM", "Cortex-R5" },
+    { 0x41c17, "ARM", "Cortex-R7" },
+    { 0x41c18, "ARM", "Cortex-R8" },
+    { 0x41c20, "ARM", "Cortex-M0" },
+    { 0x41c21, "ARM", "Cortex-M1" },
+    { 0x41c23, "ARM", "Cortex-M3" },
+    { 0x41c24, "ARM", "Cortex-M4" },
+    { 0x41c27, "ARM", "Cortex-M7" },
+    { 0x41c60, "ARM", "Cortex-M0+" },
+    { 0x41d01, "ARM", "Cortex-A32" },
+    { 0x41d02, "ARM", "Cortex-A34" },
+    { 0x41d03, "ARM", "Cortex-A53" },
+    { 0x41d04, "ARM", "Cortex-A35" },
+    { 0x41d05, "ARM", "Cortex-A55" },
+    { 0x41d06, "ARM", "Cortex-A65" },
+    { 0x41d07, "ARM", "Cortex-A57" },
+    { 0x41d08, "ARM", "Cortex-A72" },
+    { 0x41d09, "ARM", "Cortex-A73" },
+    { 0x41d0a, "ARM", "Cortex-A75" },
+    { 0x41d0b, "ARM", "Cortex-A76" },
+    { 0x41d0c, "ARM", "Neoverse-N1" },
+    { 0x41d0d, "ARM", "Cortex-A77" },
+    { 0x41d0e, "ARM", "Cortex-A76AE" },
+    { 0x41d13, "ARM", "Cortex-R52" },
+    { 0x41d15, "ARM", "Cortex-R82" },
+    { 0x41d20, "ARM", "Cortex-M23" },
+    { 0x41d21, "ARM", "Cortex-M33" },
+    { 0x41d22, "ARM", "Cortex-M55" },
+    { 0x41d23, "ARM", "Cortex-M85" },
+    { 0x41d40, "ARM", "Neoverse-V1" },
+    { 0x41d41, "ARM", "Cortex-A78" },
+    { 0x41d42, "ARM", "Cortex-A78AE" },
+    { 0x41d43, "ARM", "Cortex-A65AE" },
+    { 0x41d44, "ARM", "Cortex-X1" },
+    { 0x41d46, "ARM", "Cortex-A510" },
+    { 0x41d47, "ARM", "Cortex-A710" },
+    { 0x41d48, "ARM", "Cortex-X2" },
+    { 0x41d49, "ARM", "Neoverse-N2" },
+    { 0x41d4a, "ARM", "Neoverse-E1" },
+    { 0x41d4b, "ARM", "Cortex-A78C" },
+    { 0x41d4c, "ARM", "Cortex-X1C" },
+    { 0x41d4d, "ARM", "Cortex-A715" },
+    { 0x41d4e, "ARM", "Cortex-X3" },
+    { 0x41d4f, "ARM", "Neoverse-V2" },
+    { 0x41d80, "ARM", "Cortex-A520" },
+    { 0x41d81, "ARM", "Cortex-A720" },
+    { 0x41d82, "ARM", "Cortex-X4" },
+    { 0x41d84, "ARM", "Neoverse-V3" },
+    { 0x41d85, "ARM", "Cortex-X925" },
+    { 0x41d87, "ARM", "Cortex-A725" },
+    { 0x41d8e, "ARM", "Neoverse-N3" },
+    { 0x4200f, "Broadcom", "Brahma-B15" },
+    { 0x42100, "Broadcom", "Brahma-B53" },
+    { 0x42516, "Broadcom", "ThunderX2" },
+    { 0x430a0, "Cavium", "ThunderX" },
+    { 0x430a1, "Cavium", "ThunderX-88XX" },
+    { 0x430a2, "Cavium", "ThunderX-81XX" },
+    { 0x430a3, "Cavium", "ThunderX-83XX" },
+    { 0x430af, "Cavium", "ThunderX2-99xx" },
+    { 0x430b8, "Cavium", "ThunderX3-T110" },
+    { 0x44a10, "DEC", "SA110" },
+    { 0x44a11, "DEC", "SA1100" },
+    { 0x46001, "FUJITSU", "A64FX" },
+    { 0x48d01, "HiSilicon", "TaiShan-v110" },
+    { 0x48d02, "HiSilicon", "TaiShan-v120" },
+    { 0x48d40, "HiSilicon", "Cortex-A76" },
+    { 0x48d41, "HiSilicon", "Cortex-A77" },
+    { 0x4e000, "NVIDIA", "Denver" },
+    { 0x4e003, "NVIDIA", "Denver 2" },
+    { 0x4e004, "NVIDIA", "Carmel" },
+    { 0x50000, "APM", "X-Gene" },
+    { 0x51001, "Qualcomm", "Oryon" },
+    { 0x5100f, "Qualcomm", "Scorpion" },
+    { 0x5102d, "Qualcomm", "Scorpion" },
+    { 0x5104d, "Qualcomm", "Krait" },
+    { 0x5106f, "Qualcomm", "Krait" },
+    { 0x51201, "Qualcomm", "Kryo" },
+    { 0x51205, "Qualcomm", "Kryo" },
+    { 0x51211, "Qualcomm", "Kryo" },
+    { 0x51800, "Qualcomm", "Falkor-V1/Kryo" },
+    { 0x51801, "Qualcomm", "Kryo-V2" },
+    { 0x51802, "Qualcomm", "Kryo-3XX-Gold" },
+    { 0x51803, "Qualcomm", "Kryo-3XX-Silver" },
+    { 0x51804, "Qualcomm", "Kryo-4XX-Gold" },
+    { 0x51805, "Qualcomm", "Kryo-4XX-Silver" },
+    { 0x51c00, "Qualcomm", "Falkor" },
+    { 0x51c01, "Qualcomm", "Saphira" },
+    { 0x53001, "Samsung", "exynos-m1" },
+    { 0x53002, "Samsung", "exynos-m3" },
+    { 0x53003, "Samsung", "exynos-m4" },
+    { 0x53004, "Samsung", "exynos-m5" },
+    { 0x56131, "Marvell", "Feroceon-88FR131" },
+    { 0x56581, "Marvell", "PJ4/PJ4b" },
+    { 0x56584, "Marvell", "PJ4B-MP" },
+    { 0x61020, "Apple", "Icestorm-A14" },
+    { 0x61021, "Apple", "Firestorm-A14" },
+    { 0x61022, "Apple", "Icestorm-M1" },
+    { 0x61023, "Apple", "Firestorm-M1" },
+    { 0x61024, "Apple", "Icestorm-M1-Pro" },
+    { 0x61025, "Apple", "Firestorm-M1-Pro" },
+    { 0x61028, "Apple", "Icestorm-M1-Max" },
+    { 0x61029, "Apple", "Firestorm-M1-Max" },
+    { 0x61030, "Apple", "Blizzard-A15" },
+    { 0x61031, "Apple", "Avalanche-A15" },
+    { 0x61032, "Apple", "Blizzard-M2" },
+    { 0x61033, "Apple", "Avalanche-M2" },
+    { 0x66526, "Faraday", "FA526" },
+    { 0x66626, "Faraday", "FA626" },
+    { 0x69200, "Intel", "i80200" },
+    { 0x69210, "Intel", "PXA250A" },
+    { 0x69212, "Intel", "PXA210A" },
+    { 0x69242, "Intel", "i80321-400" },
+    { 0x69243, "Intel", "i80321-600" },
+    { 0x69290, "Intel", "PXA250B/PXA26x" },
+    { 0x69292, "Intel", "PXA210B" },
+    { 0x692c2, "Intel", "i80321-400-B0" },
+    { 0x692c3, "Intel", "i80321-600-B0" },
+    { 0x692d0, "Intel", "PXA250C/PXA255/PXA26x" },
+    { 0x692d2, "Intel", "PXA210C" },
+    { 0x69411, "Intel", "PXA27x" },
+    { 0x6941c, "Intel", "IPX425-533" },
+    { 0x6941d, "Intel", "IPX425-400" },
+    { 0x6941f, "Intel", "IPX425-266" },
+    { 0x69682, "Intel", "PXA32x" },
+    { 0x69683, "Intel", "PXA930/PXA935" },
+    { 0x69688, "Intel", "PXA30x" },
+    { 0x69689, "Intel", "PXA31x" },
+    { 0x69b11, "Intel", "SA1110" },
+    { 0x69c12, "Intel", "IPX1200" },
+    { 0x6dd49, "Microsoft", "Azure-Cobalt-100" },
+    { 0x70303, "Phytium", "FTC310" },
+    { 0x70660, "Phytium", "FTC660" },
+    { 0x70661, "Phytium", "FTC661" },
+    { 0x70662, "Phytium", "FTC662" },
+    { 0x70663, "Phytium", "FTC663" },
+    { 0x70664, "Phytium", "FTC664" },
+    { 0x70862, "Phytium", "FTC862" },
+    { 0xc0ac3, "Ampere", "Ampere-1" },
+    { 0xc0ac4, "Ampere", "Ampere-1a" },
+} };
+
+// open addressing hash table built at compile time from the array above.
+// each slot contains the index + 1 in arm_cpu_parts_array, 0 = empty slot
+inline constexpr std::size_t arm_cpu_table_size = 512;
+
+constexpr std::size_t arm_cpu_hash(const std::uint32_t midr)
+{
+    // Fibonacci hashing
+    return (static_cast<std::uint64_t>(midr) * 0x9E3779B97F4A7C15ULL) >> 40 & (arm_cpu_table_size - 1);
+}
+
+constexpr std::array<std::uint16_t, arm_cpu_table_size> build_arm_cpu_table()
+{
+    std::array<std::uint16_t, arm_cpu_table_size> table{};
+    for (std::size_t i = 0; i < arm_cpu_parts_array.size(); ++i)
+    {
+        std::size_t slot = arm_cpu_hash(arm_cpu_parts_array[i].midr);
+        while (table[slot] != 0)
+            slot = (slot + 1) & (arm_cpu_table_size - 1);
+
+        table[slot] = static_cast<std::uint16_t>(i + 1);
+    }
+    return table;
+}
+
+inline constexpr std::array<std::uint16_t, arm_cpu_table_size> arm_cpu_table = build_arm_cpu_table();
+
+/* Get the vendor and part name from the "CPU implementer" and "CPU part" values of /proc/cpuinfo
+ * @param implementer The implementer code (e.g 0x41)
+ * @param part The part number (e.g 0xd08)
+ * @return the entry, or an entry with empty vendor and name if not found
+ */
+constexpr arm_cpu_part_t arm_cpu_lookup(const std::uint32_t implementer, const std::uint32_t part)
+{
+    const std::uint32_t midr = (implementer << 12) | part;
+    for (std::size_t slot = arm_cpu_hash(midr); arm_cpu_table[slot] != 0; slot = (slot + 1) & (arm_cpu_table_size - 1))
+    {
+        if (arm_cpu_parts_array[arm_cpu_table[slot] - 1].midr == midr)
+            return arm_cpu_parts_array[arm_cpu_table[slot] - 1];
+    }
+
+    return {};
+}
+
+static_assert(arm_cpu_lookup(0x41, 0xd08).name == "Cortex-A72");
+static_assert(arm_cpu_lookup(0x41, 0xfff).name.empty());
+
+#endif  // _ARM_CPU_IDS_HPP
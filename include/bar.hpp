@@ -0,0 +1,22 @@
+#ifndef _BAR_HPP
+#define _BAR_HPP
+
+#include "config.hpp"
+
+namespace Bar
+{
+
+/*
+ * Print the layout lines as the blocks of a status bar, without colors, until stdout gets closed.
+ * One JSON line every config.m_watch_interval milliseconds (1 second by default),
+ * only the lines with values that change over time (e.g RAM, disks, CPU usage) get parsed again.
+ * config.m_bar is the protocol: "i3bar" for i3bar/swaybar/i3blocks,
+ * or "waybar" for a waybar custom module with "return-type": "json"
+ * @param config The config class
+ * @param colors The colors
+ */
+void run(const Config& config, const colors_t& colors);
+
+}  // namespace Bar
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef _BATCH_HPP
+#define _BATCH_HPP
+
+#include <functional>
+#include <string>
+
+#include "config.hpp"
+
+namespace Batch
+{
+
+/*
+ * Render many configs in one go (e.g the MOTD of each user) from a manifest,
+ * with a line for each render: <config file> <output file> [cufetch options...]
+ * ("-" for the default config file, quotes for spaces, # for comments).
+ * The modules of all the layouts are queried once, then rendered in parallel
+ * without the logo images, and each output file is replaced only once written completely
+ * @param manifest The manifest path
+ * @param configDir The config folder, for the default config file
+ * @param parse_args Set the options of a manifest line to its config, returns false if invalid
+ * @return The exit code, 1 if any render failed
+ */
+int run(const std::string& manifest, const std::string& configDir,
+        const std::function<bool(int argc, char* argv[], Config& config, const std::string& configFile)>& parse_args);
+
+}  // namespace Batch
+
+#endif
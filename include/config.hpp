@@ -4,6 +4,7 @@
 #define TOML_HEADER_ONLY 0
 
 #include <cstdint>
+#include <unordered_map>
 
 #include "toml++/toml.hpp"
 #include "util.hpp"
@@ -45,13 +46,19 @@ public:
     std::string   builtin_title_sep;
     std::string   gui_bg_image;
     std::string   ascii_logo_type;
+    std::string   color_depth;
     std::uint16_t offset             = 0;
     std::uint16_t logo_padding_left  = 0;
     std::uint16_t logo_padding_top   = 0;
     std::uint16_t layout_padding_top = 0;
+    std::uint16_t sampler_interval   = 250;
+    std::uint16_t daemon_refresh     = 2000;
+    std::uint16_t shared_results_ttl = 2000;
+    std::uint16_t frame_cache_size   = 0;
     bool          gui                = false;
     bool          sep_reset_after    = false;
     bool          slow_query_warnings= false;
+    bool          progressive        = false;
     bool          use_SI_unit        = false;
 
     // modules specific config
@@ -66,6 +73,20 @@ public:
     std::vector<std::string> dpkg_files;
     std::vector<std::string> apk_files;
 
+    std::uint16_t disk_timeout = 1000;
+
+    // [deadline], 0 for no deadline
+    std::uint16_t render_deadline = 0;
+    std::uint16_t module_deadline = 0;
+    std::string   deadline_fallback;
+    std::string   deadline_placeholder;
+
+    // the modules slower than this (in ms) for the last runs use their cached values, 0 for never
+    std::uint16_t slow_threshold = 0;
+
+    // the deadlines of single modules, e.g "theme" = 300
+    std::unordered_map<std::string, std::uint16_t> module_deadlines;
+
     // inner management / argument configs
     std::vector<std::string> m_args_layout;
     std::string m_custom_distro;
@@ -74,6 +95,30 @@ public:
     bool        m_disable_colors  = false;
     bool        m_display_distro  = true;
     bool        m_print_logo_only = false;
+    bool        m_daemon          = false;
+    bool        m_verbose         = false;
+    bool        m_explain_timing  = false;
+
+    // --watch, 0 for rendering only once
+    std::uint32_t m_watch_interval = 0;
+
+    // --bar, the status bar protocol
+    std::string m_bar;
+
+    // --batch, the manifest path
+    std::string m_batch;
+
+    // --dump-snapshot and --from-snapshot paths
+    std::string m_dump_snapshot;
+    std::string m_from_snapshot;
+
+    // the hash of the config file and the arguments, for sharing the values with the
+    // other runs started at the same time and for caching the frames. 0 for neither
+    std::uint64_t m_shared_key = 0;
+
+    // --format json
+    std::string              m_format;
+    std::vector<std::string> m_modules;
 
     void        loadConfigFile(const std::string_view filename, colors_t& colors);
     std::string getThemeValue(const std::string_view value, const std::string_view fallback) const;
@@ -228,9 +273,44 @@ sep-reset-after = false
 # e.g. falling back to gsettings when we can't find the config file for GTK
 slow-query-warnings = false
 
+# How many colors the terminal supports: "auto", "truecolor", "256" or "16".
+# With "auto" it's detected from $COLORTERM, $TERM and terminfo.
+# Hex colors are converted to the nearest color supported by the terminal.
+color-depth = "auto"
+
 # Offset between the ascii art and the layout
 offset = 5
 
+# Interval (in milliseconds) between the 2 samples used by the rate members
+# such as $<cpu.usage>, $<disk(/).read_rate> and $<net(eth0).rx_rate>.
+# The interval overlaps with the rest of the queries,
+# so it will only wait for what's left of it.
+sampler-interval = 250
+
+# Print the whole output right away in a terminal, with "..." in place of the slow tags
+# (e.g $() or $<user.de_version>), then rewrite those lines as soon as they're queried.
+progressive = false
+
+# How often (in milliseconds) `cufetch --daemon` queries again the values that change
+# (e.g uptime, RAM, disks and the rate members), for the frames sent to `cufetch --client`.
+# 0 for never.
+daemon-refresh = 2000
+
+# When many cufetch start at the same time (e.g a terminal multiplexer restoring its panes),
+# only the first one queries the system, the others wait for it and use its values.
+# For how long (in milliseconds) the values are shared with the next runs. 0 for never.
+# The values that change (e.g uptime, RAM, disks and the rate members) are always queried.
+shared-results-ttl = 2000
+
+# Max size (in KiB) of the cache of the whole outputs, in $XDG_CACHE_HOME/customfetch/frames.
+# When the config, the logo, the terminal and the values that change (e.g uptime, RAM and disks)
+# are the same as a previous run, its output is printed as it was, without querying nor parsing anything else.
+# A cached output is used for an hour at most.
+# It's not used with $() commands, theme members or the shell, terminal, WM and DE versions
+# (in the layout or the logo), rate members or images as logo.
+# 0 for disabled.
+frame-cache-size = 0
+
 # Padding between the start and the ascii art
 logo-padding-left = 0
 
@@ -300,6 +380,40 @@ dpkg-files   = ["/var/lib/dpkg/status"]
 flatpak-dirs = ["/var/lib/flatpak/app/", "~/.local/share/flatpak/app/"]
 apk-files    = ["/var/lib/apk/db/installed"]
 
+# $<disk(/path)> and $<disks> config
+[disk]
+# Time (in milliseconds) to wait for a filesystem to answer (e.g a hung NFS or CIFS mount).
+# After that, the mount is marked as stale instead of freezing the whole output
+timeout = 1000
+
+# Deadlines (in milliseconds) for querying the modules of the layout,
+# so a stalled query (e.g gsettings, getpwuid() or a WM ignoring --version) can't freeze the output.
+# The modules are queried on other threads, and the ones over their deadline get replaced.
+# Use --verbose for knowing which modules timed out.
+# 0 for no deadline.
+[deadline]
+# For all the modules, since cufetch started
+render = 0
+
+# For each module
+module = 0
+
+# What the members of a module over its deadline print: "placeholder" for the placeholder below,
+# "cached" for their value of the last time with the same config and arguments (or the placeholder),
+# "hide" for removing their layout line
+on-timeout = "placeholder"
+placeholder = "(timed out)"
+
+# The modules that took longer than this for the last runs get their value of the last time,
+# and are queried again every few runs for knowing if they're still slow.
+# The modules that take the longest also get queried first.
+# Use --explain-timing for how long each module took. 0 for always querying them.
+slow-threshold = 0
+
+# The deadline of a single module, instead of "module", e.g:
+# theme = 300
+# user = 500
+
 # GUI options
 # note: customfetch needs to be compiled with GUI_MODE=1 (check with "cufetch --version" if GUI mode was enabled)
 [gui]
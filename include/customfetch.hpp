@@ -0,0 +1,95 @@
+#ifndef _CUSTOMFETCH_HPP
+#define _CUSTOMFETCH_HPP
+
+/*
+ * libcustomfetch, the queries and the rendering of cufetch for using them in-process
+ * (e.g status bars, login greeters or monitoring agents), without running cufetch each time.
+ * Only depends on the standard library: compile with `pkg-config --cflags --libs customfetch`
+ */
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#define CUSTOMFETCH_API __attribute__((visibility("default")))
+
+namespace customfetch
+{
+
+// bumped on every incompatible change of this header
+inline constexpr int API_VERSION = 1;
+
+// thrown on the errors in the config or in the tags (e.g an unknown module), which are fatal in cufetch
+class CUSTOMFETCH_API error : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/*
+ * A config and the values queried with it.
+ * The values are kept until refresh(), so querying them again is cheap.
+ * A Context can be used from many threads, and many Contexts at once,
+ * though the queries of all of them are done one at a time.
+ * The errors in the config or in the tags throw a customfetch::error, the Context can still be used after
+ */
+class CUSTOMFETCH_API Context
+{
+public:
+    /*
+     * @param configFile The config file path, the default one if empty
+     *                   (~/.config/customfetch/config.toml, generated if it doesn't exist)
+     * @throws customfetch::error if the config is invalid
+     */
+    explicit Context(const std::string& configFile = "");
+    ~Context();
+
+    Context(Context&&) noexcept;
+    Context& operator=(Context&&) noexcept;
+    Context(const Context&)            = delete;
+    Context& operator=(const Context&) = delete;
+
+    /*
+     * Get a module member value, e.g get("ram", "used") or get("disk(/)", "free_perc").
+     * Same as $<module.member> in the layout, without colors
+     * @throws customfetch::error if there's no such module or member
+     */
+    std::string get(const std::string& module, const std::string& member);
+
+    /*
+     * Parse a string with the tags of the layout, e.g "$<os.name> up $<os.uptime>"
+     * @param colors If to color it with ANSI escape sequences, else plain text
+     * @throws customfetch::error if a tag is invalid
+     */
+    std::string parse(const std::string& line, const bool colors = true);
+
+    /*
+     * Parse the layout of the config
+     * @param colors If to color it with ANSI escape sequences, else plain text
+     * @throws customfetch::error if a tag is invalid
+     */
+    std::vector<std::string> render_layout(const bool colors = true);
+
+    /*
+     * Render the layout along side the ASCII art, as printed by cufetch.
+     * Images can only be drawn in a terminal, thus with an image there's only the layout
+     * @param colors If to color it with ANSI escape sequences, else plain text
+     * @throws customfetch::error if a tag of the layout or the logo is invalid
+     */
+    std::vector<std::string> render(const bool colors = true);
+
+    /*
+     * Drop the values that change over time (e.g uptime, RAM, disks, CPU usage),
+     * so they get queried again. The rest (e.g OS name, packages) is kept
+     */
+    void refresh();
+
+private:
+    struct impl;
+    std::unique_ptr<impl> m_impl;
+};
+
+}  // namespace customfetch
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef _DAEMON_HPP
+#define _DAEMON_HPP
+
+#include <functional>
+#include <string>
+
+#include "config.hpp"
+
+namespace Daemon
+{
+
+// returned by the render function when the client has to render by itself (e.g images or GUI mode)
+constexpr int FALLBACK = -1;
+
+/*
+ * Get the path of the socket of the daemon of the current user,
+ * $XDG_RUNTIME_DIR/customfetch.sock or /run/user/<uid>/customfetch.sock
+ * @return The path, empty if the directory isn't ours or others can access it
+ */
+std::string socket_path();
+
+/*
+ * Ask the running daemon to render with our arguments, environment (only what the rendering needs) and working directory,
+ * and write the frame it sends back to stdout
+ * @param argc The arguments count
+ * @param argv The arguments, --client included
+ * @return false if there's no daemon or it can't render it, for rendering by ourselves
+ */
+bool client(int argc, char* argv[]);
+
+/*
+ * Keep the config and the queried values in memory and render a frame for each client.
+ * Each client is served by a fork(), so it gets the values already queried,
+ * the ones that change are queried again every config.daemon_refresh milliseconds.
+ * On changes to the config file, os-release or the package databases it restarts itself.
+ * @param config The config class
+ * @param colors The colors
+ * @param configFile The config file path, for watching it
+ * @param argv Our arguments, for restarting
+ * @param render Parse the client arguments and display the frame to stdout,
+ *               returns the exit code or Daemon::FALLBACK
+ */
+[[noreturn]] void serve(const Config& config, const colors_t& colors, const std::string& configFile, char* argv[],
+                        const std::function<int(int argc, char* argv[])>& render);
+
+}  // namespace Daemon
+
+#endif
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "config.hpp"
+#include "query.hpp"
 
 namespace Display
 {
@@ -15,9 +16,16 @@ namespace Display
  * @param colors The colors
  * @param already_analyzed_path If already checked that the source path is not a binary file
  * @param path Path to source file
+ * @param systemInfo The values already queried (e.g from a snapshot)
  */
 std::vector<std::string> render(const Config& config, const colors_t& colors, const bool already_analyzed_path,
-                                const std::string_view path);
+                                const std::string_view path, const systemInfo_t& systemInfo = {});
+
+/*
+ * Join the rendered lines into the output as printed, with the escape sequences minimized
+ * @param renderResult The rendered vector usually by Display::render()
+ */
+std::string to_string(const std::vector<std::string>& renderResult);
 
 /*
  * Display the ascii art and layout
@@ -25,12 +33,40 @@ std::vector<std::string> render(const Config& config, const colors_t& colors, co
  */
 void display(const std::vector<std::string>& renderResult);
 
+/*
+ * Display the ascii art and layout right away, with the slow tags (e.g $<os.pkgs> or $(cmd)) as "...",
+ * then rewrite in place the lines with them once queried.
+ * It's like Display::display(Display::render()) if not in a terminal or the output doesn't fit in it
+ * @param config The config class
+ * @param colors The colors
+ * @param path Path to source file
+ */
+void display_progressive(const Config& config, const colors_t& colors, const std::string_view path);
+
+/*
+ * Display the ascii art and layout from the top of the terminal and keep it updated,
+ * every config.m_watch_interval milliseconds until interrupted.
+ * Only the values that change over time (e.g uptime, RAM, disks, CPU usage) are queried again,
+ * and only the cells of the terminal that changed are printed
+ * @param config The config class
+ * @param colors The colors
+ * @param path Path to source file
+ */
+void watch(const Config& config, const colors_t& colors, const std::string_view path);
+
 /*
  * Detect the distro you are using and return the path to the ASCII art
  * @param config The config class
  */
 std::string detect_distro(const Config& config);
 
+/*
+ * Get the path of the ASCII art or image to display, from config.source_path.
+ * It also sets config.m_disable_source and config.m_display_distro
+ * @param config The config class
+ */
+std::string get_source_path(Config& config);
+
 }  // namespace Display
 
 #endif
@@ -0,0 +1,23 @@
+#ifndef _DISPLAY_WIDTH_HPP
+#define _DISPLAY_WIDTH_HPP
+
+#include <cstddef>
+#include <string_view>
+
+/*
+ * Get how many terminal columns a codepoint takes, like wcwidth(3)
+ * but without depending on the locale
+ * @param cp The unicode codepoint
+ * @return 0 for combining marks and format characters, 2 for East Asian wide/fullwidth and emoji, else 1
+ */
+int codepoint_width(const char32_t cp);
+
+/*
+ * Get how many terminal columns an UTF-8 string takes.
+ * The string must not contain escape sequences (e.g colors),
+ * invalid UTF-8 bytes are counted as 1 column each
+ * @param str The UTF-8 string
+ */
+size_t display_width(const std::string_view str);
+
+#endif
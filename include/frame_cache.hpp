@@ -0,0 +1,26 @@
+#ifndef _FRAME_CACHE_HPP
+#define _FRAME_CACHE_HPP
+
+#include <string>
+
+#include "config.hpp"
+
+namespace FrameCache
+{
+
+/*
+ * Display the frame as Display::display(Display::render()) would, but from the cache if a previous run
+ * had the same config file, arguments, logo, terminal (width and colors) and values that change (e.g uptime or RAM),
+ * on the same host and kernel, from the same shell and terminal, within the same hour.
+ * Else it's rendered and cached, the oldest frames get removed when over config.frame_cache_size
+ * @param config The config class
+ * @param colors The colors
+ * @param path The logo path, from Display::get_source_path()
+ * @return false if it can't be cached (e.g images, rate members, $() commands, theme or version tags, or disabled),
+ *         for rendering as usual
+ */
+bool display(const Config& config, const colors_t& colors, const std::string& path);
+
+}  // namespace FrameCache
+
+#endif
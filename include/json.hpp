@@ -0,0 +1,36 @@
+#ifndef _JSON_HPP
+#define _JSON_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "config.hpp"
+#include "query.hpp"
+
+namespace JSON
+{
+
+/*
+ * Query the modules and print their members as a JSON object of module -> member -> value,
+ * without any logo or color. Numbers are printed as numbers and the amounts of bytes in bytes
+ * @param config The config class
+ * @param colors The colors
+ * @param modules The modules (e.g "ram", "disk(/)") or module members (e.g "cpu.name") to print,
+ *                all the modules if empty
+ */
+void print(const Config& config, const colors_t& colors, const std::vector<std::string>& modules);
+
+/*
+ * Query every module member printed by JSON::print(), plus the amounts of bytes in bytes (e.g used-B)
+ * @param systemInfo Where the values go
+ * @param config The config class
+ * @param colors The colors
+ * @param instances Other modules to query all the members of, e.g "disk(/home)" or "gpu1"
+ */
+void query(systemInfo_t& systemInfo, const Config& config, const colors_t& colors,
+           const std::vector<std::string>& instances);
+
+}  // namespace JSON
+
+#endif
@@ -0,0 +1,175 @@
+#ifndef _OUTPUT_SINK_HPP
+#define _OUTPUT_SINK_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "config.hpp"
+
+/* parse() resolves every tag first, and module values can contain colors too (e.g $<ram.ram>),
+ * so the colors are kept in the resolved string as events between these 2 control characters:
+ * "\x1e" <kind> <payload> "\x1f". They are then written to a sink in a single pass by write_events()
+ */
+constexpr char EVENT_START = '\x1e';
+constexpr char EVENT_END   = '\x1f';
+
+enum event_kind_t : char
+{
+    EVENT_STYLE       = 'S',  // payload: the color tag, e.g "red", "!u#ff0000" or "\e[1;31m"
+    EVENT_RESET       = 'R',  // ${0}
+    EVENT_RESET_BOLD  = 'B',  // ${1}
+    EVENT_RAW         = 'X',  // payload: text written as it is and without width, e.g $(!cmd)
+    EVENT_SCOPE_OPEN  = 'O',  // the start of a string parsed on its own (e.g a module value)
+    EVENT_SCOPE_CLOSE = 'C',  // its end, the styles it left set get popped
+};
+
+/*
+ * Get the in-band representation of an event
+ * @param kind The event kind
+ * @param payload The payload (only for styles and raw text)
+ */
+std::string make_event(const event_kind_t kind, const std::string_view payload = "");
+
+/* Where the output of parse() is written to.
+ * Each backend only has to implement how to write text and styles,
+ * the stack of the styles and the width of the text are tracked here
+ */
+class OutputSink
+{
+public:
+    OutputSink(const Config& config, const colors_t& colors);
+    virtual ~OutputSink() = default;
+
+    void text(const std::string_view str);
+    void raw(const std::string_view str);
+    void push_style(const std::string_view spec);
+    void reset(const bool bold);
+    void open_scope();
+    void close_scope();
+
+    // the rendered output
+    virtual std::string str() const
+    { return m_output; }
+
+    // the width in terminal columns of the text written so far
+    size_t width() const noexcept
+    { return m_width; }
+
+protected:
+    struct style_t
+    {
+        std::string spec;
+
+        // the bold of ${1}
+        bool bold = false;
+    };
+
+    virtual void on_text(const std::string_view str) = 0;
+    virtual void on_raw(const std::string_view str) = 0;
+    virtual void on_push(const style_t& style) = 0;
+
+    // the last n styles got popped, m_styles is what's left
+    virtual void on_pop(const size_t n) = 0;
+
+    // all the n styles got popped by ${0} or ${1}
+    virtual void on_reset(const size_t n) = 0;
+
+    const Config&        m_config;
+    const colors_t&      m_colors;
+    std::string          m_output;
+    std::vector<style_t> m_styles;
+
+private:
+    // the size of m_styles when each scope was opened
+    std::vector<size_t> m_scopes;
+    size_t              m_width = 0;
+};
+
+// terminal escape sequences
+class AnsiSink : public OutputSink
+{
+public:
+    using OutputSink::OutputSink;
+
+protected:
+    void on_text(const std::string_view str) override;
+    void on_raw(const std::string_view str) override;
+    void on_push(const style_t& style) override;
+    void on_pop(const size_t n) override;
+    void on_reset(const size_t n) override;
+
+private:
+    std::string get_sgr(const style_t& style) const;
+};
+
+// pango markup for GUI mode
+class PangoSink : public OutputSink
+{
+public:
+    using OutputSink::OutputSink;
+
+protected:
+    void on_text(const std::string_view str) override;
+    void on_raw(const std::string_view str) override;
+    void on_push(const style_t& style) override;
+    void on_pop(const size_t n) override;
+    void on_reset(const size_t n) override;
+};
+
+// only the text, without any color
+class PlainSink : public OutputSink
+{
+public:
+    using OutputSink::OutputSink;
+
+protected:
+    void on_text(const std::string_view str) override;
+    void on_raw(const std::string_view str) override;
+    void on_push(const style_t&) override {}
+    void on_pop(const size_t) override {}
+    void on_reset(const size_t) override {}
+};
+
+// the text split in segments with the styles applied to each, str() returns them as a JSON array
+class StructuredSink : public OutputSink
+{
+public:
+    struct segment_t
+    {
+        std::string              text;
+        std::vector<std::string> styles;
+    };
+
+    using OutputSink::OutputSink;
+
+    std::string str() const override;
+
+    const std::vector<segment_t>& segments() const noexcept
+    { return m_segments; }
+
+protected:
+    void on_text(const std::string_view str) override;
+    void on_raw(const std::string_view) override {}
+    void on_push(const style_t&) override {}
+    void on_pop(const size_t) override {}
+    void on_reset(const size_t) override {}
+
+private:
+    std::vector<segment_t> m_segments;
+};
+
+/*
+ * Get the sink for the config: Pango in GUI mode, plain text with colors disabled, else ANSI
+ */
+std::unique_ptr<OutputSink> make_output_sink(const Config& config, const colors_t& colors);
+
+/*
+ * Write a string resolved by parse(), with its events, to a sink
+ * @param str The resolved string
+ * @param sink The sink
+ */
+void write_events(const std::string_view str, OutputSink& sink);
+
+#endif
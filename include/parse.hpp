@@ -2,6 +2,7 @@
 #define _PARSE_HPP
 
 #include "config.hpp"
+#include "output_sink.hpp"
 #include "query.hpp"
 
 /* the additional args that parse() needs for getting the necessary infos/configs.
@@ -11,23 +12,28 @@
 struct parse_args_t
 {
     systemInfo_t&   systemInfo;
-    std::string&    pureOutput;
     const Config&   config;
     const colors_t& colors;
     const bool&     parsingLayout;
 };
 
-/* Parse input, in-place, with data from systemInfo.
+/* Parse input, in-place, with data from systemInfo, and write it to a sink.
  * Documentation on formatting is in the default config.toml file or the cufetch.1 manual.
  * @param input The string to parse
  * @param systemInfo The system infos
- * @param pureOutput The output of the string but without tags
+ * @param sink Where to write the text and its colors, it also keeps the width of the text
  * @param config The config
  * @param colors The colors
  * @param parsingLayout If we are parsing layout or not
- * @param is_image If the source path is an image (used for GUI mode only)
  */
-std::string parse(const std::string_view input, systemInfo_t& systemInfo, std::string& pureOutput, const Config& config,
+void parse(const std::string_view input, systemInfo_t& systemInfo, OutputSink& sink, const Config& config,
+           const colors_t& colors, const bool parsingLayout);
+
+/* Parse input with data from systemInfo.
+ * Same as above, but written to the sink of the config (ANSI, Pango or plain text)
+ * @return The rendered string
+ */
+std::string parse(const std::string_view input, systemInfo_t& systemInfo, const Config& config,
                   const colors_t& colors, const bool parsingLayout);
 
 /* Set module members values to a systemInfo_t map.
@@ -40,12 +46,69 @@ std::string parse(const std::string_view input, systemInfo_t& systemInfo, std::s
 void addValueFromModule(const std::string& moduleName, const std::string& moduleMemberName,
                         parse_args_t& parse_args);
 
+/*
+ * Check if it's a unit for the amounts of bytes of the module members, e.g "GiB" of $<ram.used-GiB>
+ */
+bool is_bytes_unit(const std::string_view unit);
+
 /*
  * Return a module member value
  */
 std::string getInfoFromName(const systemInfo_t& systemInfo, const std::string_view moduleName,
                             const std::string_view moduleMemberName);
 
+// the Query classes whose values change over time
+enum dynamic_dep_t : std::uint8_t
+{
+    DEP_SYSTEM  = 1 << 0,  // uptime
+    DEP_CPU     = 1 << 1,  // current frequency
+    DEP_RAM     = 1 << 2,  // ram, swap and zram
+    DEP_DISK    = 1 << 3,
+    DEP_SAMPLER = 1 << 4,  // the rate members
+};
+
+// a module member in a layout line whose value changes over time, e.g $<ram.used>
+struct dynamic_tag_t
+{
+    std::string  module;
+    std::string  member;
+    std::uint8_t deps;
+};
+
+/*
+ * Get the module members of a layout line whose values change over time (e.g uptime, RAM, disks or rates),
+ * for parsing again only the lines that have any
+ * @param line The layout line, not parsed
+ */
+std::vector<dynamic_tag_t> get_dynamic_tags(const std::string_view line);
+
+/*
+ * Forget the colors of the ascii art parsed until now, for ${auto}.
+ * Only needed when rendering more than once in the same thread
+ */
+void clear_auto_colors();
+
+/*
+ * Query the module members of the layout tags once, without colors,
+ * so the Query classes caches are filled before rendering (e.g in another process or thread)
+ * @param systemInfo Where the values go
+ * @param layout The layout lines, not parsed
+ * @param skip The modules not to query, e.g "user." or "theme"
+ */
+void query_layout_tags(systemInfo_t& systemInfo, const std::vector<std::string>& layout, const Config& config,
+                       const colors_t& colors, const std::vector<std::string_view>& skip);
+
+/*
+ * Drop the values of the tags, and the Query classes caches they depend on,
+ * so the next parse() of their lines queries them again.
+ * The sampler starts over, so the rates of the next parse() are over the time until then
+ * @param systemInfo The system infos the lines are parsed with
+ * @param tags The tags of the lines
+ * @param interval_ms About the time until the next parse(), the least the rates get sampled over
+ */
+void invalidate_dynamic_tags(systemInfo_t& systemInfo, const std::vector<dynamic_tag_t>& tags,
+                             const std::uint32_t interval_ms);
+
 // Function to combine multiple fmt::text_style arguments
 template <typename... Styles>
 void append_styles(fmt::text_style& current_style, Styles&&... styles)
@@ -1,6 +1,7 @@
 #ifndef _QUERY_HPP
 #define _QUERY_HPP
 
+#include <chrono>
 #include <cstdint>
 #include <fstream>
 #include <string>
@@ -12,10 +13,8 @@
 #include "util.hpp"
 
 extern "C" {
-#include <mntent.h>
 #include <pwd.h>
 #include <sys/stat.h>
-#include <sys/statvfs.h>
 #include <sys/sysinfo.h>
 #include <sys/utsname.h>
 #include <unistd.h>
@@ -50,6 +49,9 @@ public:
 
     System();
 
+    // drop the uptime, it gets queried again
+    static void invalidate() noexcept;
+
     std::string  kernel_name() noexcept;
     std::string  kernel_version() noexcept;
     std::string  hostname() noexcept;
@@ -73,6 +75,7 @@ public:
 private:
     static System_t       m_system_infos;
     static bool           m_bInit;
+    static bool           m_bSysInfoInit;
     static struct utsname m_uname_infos;
     static struct sysinfo m_sysInfos;
 };
@@ -109,6 +112,9 @@ public:
 
     static bool m_bDont_query_dewm;
 
+    // the process the terminal is found from, 0 for our parent (e.g a `cufetch --client` shell for the daemon)
+    static pid_t m_parent_pid;
+
 private:
     static bool           m_bInit;
     static User_t         m_users_infos;
@@ -127,23 +133,57 @@ public:
         std::string cursor_size{ UNKNOWN };
     };
 
-    Theme(const std::uint8_t ver, systemInfo_t& queried_themes, std::vector<std::string>& queried_themes_names,
-          const std::string& theme_name_version, const Config& config, const bool gsettings_only = false);
+    /* GTK theme, icons and font of a GTK version, or of the dconf/gsettings database.
+     * Every source is queried only once per run, the other instances just look it up
+     */
+    Theme(const std::uint8_t ver, const Config& config, const bool gsettings_only = false);
+
+    // only use it for cursor
+    Theme(const Config& config, const bool gsettings_only = false);
+
+    std::string& gtk_theme() noexcept;
+    std::string& gtk_icon_theme() noexcept;
+    std::string& gtk_font() noexcept;
+    std::string& cursor() noexcept;
+    std::string& cursor_size() noexcept;
+
+private:
+    static std::string& wmde_name();
+
+    // "gtk2", "gtk3", "gtk4", "gsettings", "cursor", "cursor-gsettings"
+    static std::unordered_map<std::string, Theme_t> m_themes;
+    static std::string                              m_wmde_name;
+    Theme_t*                                        m_pTheme = nullptr;
+};
+
+class ThemeQt
+{
+public:
+    struct ThemeQt_t
+    {
+        std::string style{ MAGIC_LINE };
+        std::string color_scheme{ MAGIC_LINE };
+        std::string icon_theme{ MAGIC_LINE };
+        std::string font{ MAGIC_LINE };
+        std::string cursor{ MAGIC_LINE };
+        std::string cursor_size{ UNKNOWN };
+    };
 
-    Theme(systemInfo_t& queried_themes, const Config& config, const bool gsettings_only = false);
+    /* Qt/KDE widget style, color scheme, icons, font and cursor.
+     * Read from kdeglobals, kcminputrc and the qt5ct/qt6ct configs, only once per run
+     */
+    ThemeQt();
 
-    std::string  gtk_theme() noexcept;
-    std::string  gtk_icon_theme() noexcept;
-    std::string  gtk_font() noexcept;
+    std::string& style() noexcept;
+    std::string& color_scheme() noexcept;
+    std::string& icon_theme() noexcept;
+    std::string& font() noexcept;
     std::string& cursor() noexcept;
     std::string& cursor_size() noexcept;
 
 private:
-    User              query_user;
-    static Theme_t    m_theme_infos;
-    systemInfo_t&     m_queried_themes;
-    const std::string m_theme_name_version;
-    std::string       m_wmde_name;
+    static bool      m_bInit;
+    static ThemeQt_t m_qt_infos;
 };
 
 class CPU
@@ -165,6 +205,9 @@ public:
 
     CPU() noexcept;
 
+    // drop the cached infos, e.g for the current frequency in the daemon
+    static void invalidate() noexcept;
+
     std::string& name() noexcept;
     std::string& nproc() noexcept;
     double&       freq_max() noexcept;
@@ -211,9 +254,29 @@ public:
         std::string typefs;
         std::string device;
         std::string mountdir;
+        bool        stale = false;  // statvfs() didn't answer in time (e.g hung NFS)
     };
 
-    Disk(const std::string_view path, std::vector<std::string>& paths);
+    // an entry of /proc/self/mountinfo
+    struct mount_t
+    {
+        std::string root;
+        std::string mountdir;
+        std::string typefs;
+        std::string device;
+    };
+
+    Disk(const std::string& path, const std::uint16_t timeout_ms);
+
+    // drop the cached amounts of every disk, they get queried again
+    static void invalidate() noexcept;
+
+    /* Query every real (non-pseudo) filesystem, each at most once.
+     * All the statvfs() calls run in parallel and share the same deadline
+     * @param timeout_ms Time to wait before marking the remaining mounts as stale
+     * @return the list of disks, in mount order
+     */
+    static std::vector<Disk_t*>& all_disks(const std::uint16_t timeout_ms);
 
     double&       total_amount() noexcept;
     double&       free_amount() noexcept;
@@ -221,15 +284,20 @@ public:
     std::string& typefs() noexcept;
     std::string& device() noexcept;
     std::string& mountdir() noexcept;
+    bool&        stale() noexcept;
 
 private:
-    static struct statvfs m_statvfs;
-    static Disk_t         m_disk_infos;
+    Disk_t* m_pDisk = nullptr;
+
+    static bool                                    m_bAllInit;
+    static std::vector<Disk_t*>                    m_all_disks;
+    static std::unordered_map<std::string, Disk_t> m_disks_infos;
 };
 
 class RAM
 {
 public:
+    // all the amounts are in KiB, as in /proc/meminfo
     struct RAM_t
     {
         double total_amount      = 0;
@@ -238,20 +306,119 @@ public:
         double swap_free_amount  = 0;
         double swap_used_amount  = 0;
         double swap_total_amount = 0;
+        double cached_amount     = 0;
+        double buffers_amount    = 0;
+        double shmem_amount      = 0;
+        double dirty_amount      = 0;
+        double writeback_amount  = 0;
+        double zswap_amount      = 0;  // compressed size in the zswap pool
+        double zswapped_amount   = 0;  // uncompressed size of the pages in the pool
+        double hugetlb_amount    = 0;
+        double hugepage_size     = 0;
+        size_t hugepages_total   = 0;
+        size_t hugepages_free    = 0;
+        double pressure_some     = 0;  // avg10 percentages of /proc/pressure/memory
+        double pressure_full     = 0;
+    };
+
+    // amounts are in bytes, as in /sys/block/zram*/mm_stat
+    struct zram_t
+    {
+        double orig_amount  = 0;
+        double compr_amount = 0;
+        double used_amount  = 0;
+        double total_amount = 0;
+        bool   exists       = false;
     };
 
     RAM() noexcept;
 
+    // drop the cached amounts, zram and pressure stats, they get queried again
+    static void invalidate() noexcept;
+
+    /* Get the compression stats of a zram device
+     * @param name The device name (e.g zram0), or empty for all the devices together
+     */
+    static zram_t& zram(const std::string& name);
+
     double& total_amount() noexcept;
     double& free_amount() noexcept;
     double& used_amount() noexcept;
     double& swap_free_amount() noexcept;
     double& swap_used_amount() noexcept;
     double& swap_total_amount() noexcept;
+    double& cached_amount() noexcept;
+    double& buffers_amount() noexcept;
+    double& shmem_amount() noexcept;
+    double& dirty_amount() noexcept;
+    double& writeback_amount() noexcept;
+    double& zswap_amount() noexcept;
+    double& zswapped_amount() noexcept;
+    double& hugetlb_amount() noexcept;
+    double& hugepage_size() noexcept;
+    size_t& hugepages_total() noexcept;
+    size_t& hugepages_free() noexcept;
+    double& pressure_some();
+    double& pressure_full();
 
 private:
-    static bool  m_bInit;
-    static RAM_t m_memory_infos;
+    static bool                                    m_bInit;
+    static bool                                    m_bPressureInit;
+    static RAM_t                                   m_memory_infos;
+    static std::unordered_map<std::string, zram_t> m_zram_infos;
+};
+
+/* Takes 2 snapshots of /proc/stat, /proc/diskstats and /proc/net/dev
+ * for calculating rates (CPU usage, disk I/O, network throughput).
+ * The first snapshot is taken at render start with Sampler::start(),
+ * the second just before the first tag that needs it gets evaluated,
+ * so the interval overlaps with the rest of the queries instead of being a blocking sleep.
+ */
+class Sampler
+{
+public:
+    struct cpu_stat_t
+    {
+        size_t idle  = 0;
+        size_t total = 0;
+    };
+
+    // read/write bytes for disks, rx/tx bytes for network interfaces
+    struct io_stat_t
+    {
+        size_t read  = 0;
+        size_t write = 0;
+    };
+
+    struct Sample_t
+    {
+        std::chrono::steady_clock::time_point      time;
+        cpu_stat_t                                 cpu;
+        std::unordered_map<std::string, io_stat_t> disks;
+        std::unordered_map<std::string, io_stat_t> nets;
+    };
+
+    Sampler(const std::uint16_t interval_ms);
+
+    static void start(const std::uint16_t interval_ms);
+
+    // drop both samples, the next start() begins a new interval
+    static void invalidate() noexcept;
+
+    double seconds() noexcept;
+    double cpu_usage() noexcept;
+    double disk_read_rate(const std::string_view device);
+    double disk_write_rate(const std::string_view device);
+    double net_rx_rate(const std::string& iface);
+    double net_tx_rate(const std::string& iface);
+    bool   has_net_iface(const std::string& iface) noexcept;
+
+private:
+    static bool                      m_bInit;
+    static bool                      m_bStarted;
+    static std::chrono::milliseconds m_interval;
+    static Sample_t                  m_first;
+    static Sample_t                  m_second;
 };
 
 }  // namespace Query
@@ -0,0 +1,66 @@
+#ifndef _SCHEDULER_HPP
+#define _SCHEDULER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "query.hpp"
+
+namespace Scheduler
+{
+
+// if the config has any deadline or a slow-threshold, for querying on other threads in Scheduler::query()
+bool enabled(const Config& config);
+
+/*
+ * If a query of the same Query classes as the module (e.g "theme" and "user") timed out and is stuck on another thread.
+ * Their static caches are off-limits for the rest of the run, the module gets config.deadline_placeholder instead
+ */
+bool is_poisoned(const std::string& module);
+
+/*
+ * Return from main() with this, it exits right away if a query is stuck on another thread,
+ * else the static destructors of its Query classes would race with it.
+ * The other exit() calls (e.g die()) exit with 1 right away in that case
+ * @param ret The exit code
+ * @return ret, if nothing is stuck
+ */
+int leave(const int ret);
+
+/*
+ * Get the time left until the render deadline (config.render_deadline since cufetch started)
+ * @return The milliseconds left, 0 if it's over, -1 if there's no render deadline
+ */
+std::int64_t render_time_left(const Config& config);
+
+/*
+ * Query the module members of the layout tags on other threads, within their deadlines.
+ * Without any deadline nor slow-threshold (see Scheduler::enabled()) they're queried on this thread instead.
+ * The modules sharing the same Query classes (e.g "user" and "theme") are queried one after the other on the same thread,
+ * the ones that took the longest in the last runs start first.
+ * The members over their deadline get config.deadline_fallback as value (MAGIC_LINE for "hide"),
+ * and with --verbose a note says which modules timed out.
+ * The modules over config.slow_threshold for the last runs get their cached values instead, and are queried again once in a while.
+ * How long each module took is recorded in the cache dir (not by the daemon nor libcustomfetch), see Scheduler::explain()
+ * The rate members and the builtin module are left to parse()
+ * @param systemInfo Where the values go, the members already in it aren't queried
+ * @param layout The layout lines, not parsed
+ * @param on_line Called on this thread with the index of each layout line, as soon as its values are in systemInfo
+ *                (the lines with builtin or nested tags only once everything is done), even without deadlines
+ * @return false if any module timed out
+ */
+bool query(systemInfo_t& systemInfo, const std::vector<std::string>& layout, const Config& config,
+           const colors_t& colors, const std::function<void(size_t line)>& on_line = nullptr);
+
+/*
+ * Print how long each module took in the last runs of Scheduler::query(),
+ * and which ones are in cached mode because of config.slow_threshold (--explain-timing)
+ */
+void explain(const Config& config);
+
+}  // namespace Scheduler
+
+#endif
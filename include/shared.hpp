@@ -0,0 +1,24 @@
+#ifndef _SHARED_HPP
+#define _SHARED_HPP
+
+#include "config.hpp"
+#include "query.hpp"
+
+namespace Shared
+{
+
+/*
+ * Get the values of the layout tags shared by the runs started at the same time (e.g the panes of a tmux session),
+ * from a segment of the current user in /dev/shm.
+ * The first run queries them and publishes them, the others wait for it and copy them without locking (seqlock).
+ * The values that change (e.g uptime, RAM or the rate members), the terminal and the shell aren't shared,
+ * they get queried while rendering as usual
+ * @param config The config class, its m_shared_key and shared_results_ttl
+ * @param colors The colors
+ * @return The values for Display::render(), empty if not shared
+ */
+systemInfo_t get(const Config& config, const colors_t& colors);
+
+}  // namespace Shared
+
+#endif
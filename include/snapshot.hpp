@@ -0,0 +1,68 @@
+#ifndef _SNAPSHOT_HPP
+#define _SNAPSHOT_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "config.hpp"
+#include "query.hpp"
+
+namespace Snapshot
+{
+
+// bumped on every incompatible change of the file format
+constexpr std::uint16_t FORMAT_VERSION = 1;
+
+struct snapshot_t
+{
+    std::string  os_id;
+    std::string  os_name;
+    systemInfo_t systemInfo;
+};
+
+/*
+ * Encode the values in the snapshot format
+ * @param snapshot The distro and the values
+ */
+std::string encode(const snapshot_t& snapshot);
+
+/*
+ * Decode the values from the snapshot format, it errors out if invalid
+ * @param data The encoded snapshot
+ * @param name The name for the errors, e.g the file path
+ */
+snapshot_t decode(const std::string_view data, const std::string_view name);
+
+/*
+ * Same as decode(), but it doesn't error out if invalid
+ * @param data The encoded snapshot
+ * @param name The name for the error, e.g the file path
+ * @param snapshot Where the decoded snapshot goes
+ * @param error Why it's invalid
+ * @return false if invalid
+ */
+bool try_decode(const std::string_view data, const std::string_view name, snapshot_t& snapshot, std::string& error);
+
+/*
+ * Query every module (as --format json) and the ones in the layout, and write their values to a snapshot file,
+ * for rendering them somewhere else with Snapshot::render().
+ * It's a small binary file: "CFSNAP", the version, the distro and the values with their types
+ * @param config The config class
+ * @param colors The colors
+ * @param path The snapshot path, "-" for stdout
+ */
+void dump(const Config& config, const colors_t& colors, const std::string& path);
+
+/*
+ * Render and display the layout with the values of the snapshot at config.m_from_snapshot,
+ * without querying the system (the $() commands still run here).
+ * If it's a directory, each "<name>.snapshot" file in it is rendered in parallel to "<name>.txt"
+ * @param config The config class
+ * @param colors The colors
+ * @return The exit code
+ */
+int render(const Config& config, const colors_t& colors);
+
+}  // namespace Snapshot
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef _TERM_COLORS_HPP
+#define _TERM_COLORS_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fmt/color.h"
+
+enum color_depth_t : std::uint8_t
+{
+    COLOR_DEPTH_16,
+    COLOR_DEPTH_256,
+    COLOR_DEPTH_TRUECOLOR
+};
+
+/*
+ * Get how many colors the terminal supports.
+ * With "auto" it's detected only once from $COLORTERM, $TERM and the terminfo "colors" capability
+ * @param depth "auto" for detecting it, else "truecolor", "256" or "16" for forcing it
+ */
+color_depth_t get_color_depth(const std::string_view depth);
+
+/*
+ * Get the shortest SGR escape sequence of a 24-bit color,
+ * downsampled to the nearest color of the 256 or 16 colors palette if needed
+ * @param rgb The color
+ * @param bg If it's a background color
+ * @param depth The colors depth of the terminal, from get_color_depth()
+ */
+std::string get_color_sgr(const fmt::rgb rgb, const bool bg, const color_depth_t depth);
+
+// the graphic rendition the terminal is in, after the SGR sequences printed so far
+struct sgr_state_t
+{
+    // bit N is set if the SGR attribute N is on (1 = bold, 2 = dim, 3 = italic, 4 = underline, ...)
+    std::uint16_t attributes = 0;
+
+    // the parameters of the color, e.g "31", "38;5;208" or "38;2;255;136;0". Empty for the default color
+    std::string fg;
+    std::string bg;
+
+    // every other parameter, which can only be turned off with a reset
+    std::vector<std::string> others;
+
+    bool operator==(const sgr_state_t&) const = default;
+};
+
+/*
+ * Rewrite the SGR escape sequences of a line with the fewest bytes:
+ * consecutive sequences are merged in one, sequences that don't change anything are dropped,
+ * and the attributes are turned off one by one when it's shorter than a reset.
+ * The other escape sequences are kept as they are
+ * @param line The line to rewrite
+ * @param state The rendition the terminal is in before the line, it will be the one after it
+ */
+void minimize_sgr(std::string& line, sgr_state_t& state);
+
+/*
+ * Get what to print for turning a line already on the terminal into another one,
+ * by rewriting only the cells from the first to the last one that differ.
+ * Both lines must start with the default rendition, it's the one the terminal is left with
+ * @param from The line on the terminal
+ * @param to The new line
+ * @param row The terminal row of the line, from 0
+ * @return The cursor movement and the cells to print, empty if they look the same
+ */
+std::string diff_line(const std::string_view from, const std::string_view to, const size_t row);
+
+#endif
@@ -3,8 +3,11 @@
 
 #include <dlfcn.h>
 #include <sys/types.h>
+#include <unistd.h>
 
+#include <functional>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -50,6 +53,20 @@ constexpr const char MAGIC_LINE[] = "(cut this shit NOW!! RAHHH)";
 
 #define BOLD_COLOR(x) (fmt::emphasis::bold | fmt::fg(x))
 
+// thrown by die() instead of exiting, see g_die_throw_pid
+struct fatal_error : public std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+};
+
+// the process where die() throws a fatal_error instead of exiting, 0 for none.
+// Set by libcustomfetch, which mustn't kill the program using it. The fork() children still exit
+inline pid_t g_die_throw_pid = 0;
+
+// the threads where die() throws a fatal_error instead of exiting,
+// e.g the Scheduler workers, the thread waiting for them reports it
+inline thread_local bool g_die_throw_thread = false;
+
 bool         hasEnding(const std::string_view fullString, const std::string_view ending);
 bool         hasStart(const std::string_view fullString, const std::string_view start);
 std::string  name_from_entry(size_t dev_entry_pos);
@@ -61,6 +78,7 @@ void         getFileValue(u_short& iterIndex, const std::string_view line, std::
 byte_units_t auto_devide_bytes(const double num, const std::uint16_t base, const std::string_view maxprefix = "");
 byte_units_t devide_bytes(const double num, const std::string_view prefix);
 bool         is_file_image(const unsigned char* bytes);
+bool         is_file_image(const std::string_view path);
 void         ctrl_d_handler(const std::istream& cin);
 std::string  expandVar(std::string ret);
 bool         taur_exec(const std::vector<std::string_view> cmd_str, const bool noerror_print = true);
@@ -70,12 +88,18 @@ void         replace_str(std::string& str, const std::string_view from, const st
 bool         read_exec(std::vector<const char*> cmd, std::string& output, bool useStdErr = false, bool noerror_print = true);
 std::string  str_tolower(std::string str);
 std::string  str_toupper(std::string str);
+void         json_escape(std::string& out, const std::string_view str);
+bool         write_all(const int fd, const std::string_view str);
+bool         write_file_atomic(const std::string& path, const std::string_view str, const mode_t mode = 0644);
+void         parallel_for(const size_t count, const std::function<void(size_t i)>& fn);
 void         strip(std::string& input);
 std::string  read_by_syspath(const std::string_view path);
 fmt::rgb     hexStringToColor(const std::string_view hexstr);
 std::string  shorten_vendor_name(std::string vendor);
 std::string  getHomeConfigDir();
 std::string  getConfigDir();
+std::string  getHomeCacheDir();
+std::string  getCacheDir();
 std::vector<std::string> split(const std::string_view text, char delim);
 
 template <typename... Args>
@@ -86,10 +110,13 @@ void error(const std::string_view fmt, Args&&... args) noexcept
 }
 
 template <typename... Args>
-void die(const std::string_view fmt, Args&&... args) noexcept
+void die(const std::string_view fmt, Args&&... args)
 {
-    fmt::println(stderr, BOLD_COLOR(fmt::rgb(fmt::color::red)), "FATAL: {}",
-                 fmt::format(fmt::runtime(fmt), std::forward<Args>(args)...));
+    const std::string& msg = fmt::format(fmt::runtime(fmt), std::forward<Args>(args)...);
+    if (g_die_throw_thread || (g_die_throw_pid != 0 && g_die_throw_pid == getpid()))
+        throw fatal_error(msg);
+
+    fmt::println(stderr, BOLD_COLOR(fmt::rgb(fmt::color::red)), "FATAL: {}", msg);
     std::exit(1);
 }
 
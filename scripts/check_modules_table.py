@@ -0,0 +1,67 @@
+import re
+import sys
+
+# Checks that the modules_table of src/json.cpp has the same modules and members as addValueFromModule() in src/parse.cpp
+# usage: python3 scripts/check_modules_table.py (from the root of the repo), exits with 1 if they differ
+
+with open("src/parse.cpp", "r") as f:
+    parse = f.read()
+
+with open("src/json.cpp", "r") as f:
+    json = f.read()
+
+# void addValueFromModule(...)
+# {
+#     ...
+#     if (moduleName == "os")
+#     {
+#         ...
+#                 case "name"_fnv1a16: SYSINFO_INSERT(query_system.os_pretty_name()); break;
+#     ...
+#     else if (hasStart(moduleName, "gpu"))
+#     ...
+#     else
+#         die("Invalid module name: {}", moduleName);
+# }
+body = parse[parse.index("void addValueFromModule("):]
+body = body[:body.index('die("Invalid module name: {}", moduleName);')]
+
+parse_modules = {}
+blocks = list(re.finditer(r'^    (?:else )?if \((?:moduleName == "([\w-]+)"|hasStart\(moduleName, "([\w-]+)"\))\)$', body, re.M))
+for i, block in enumerate(blocks):
+    end = blocks[i + 1].start() if i + 1 < len(blocks) else len(body)
+    members = set(re.findall(r'case "(\w+)"_fnv1a16', body[block.end():end]))
+    # the rate members are sampled, they aren't a case of the switch
+    members.update(re.findall(r'moduleMemberName == "(\w+)"', body[block.end():end]))
+    parse_modules[block.group(1) or block.group(2)] = members
+
+# static const std::vector<module_t> modules_table = {
+#     { "os", "os", {
+#         { "name" }, { "kernel" }, ...
+#     ...
+# };
+table = json[json.index("modules_table = {"):]
+table = table[:table.index("\n};")]
+
+json_modules = {}
+for module in re.finditer(r'\{ "([\w-]+)", "[^"]*", \{(.*?)\} \},', table, re.S):
+    json_modules[module.group(1)] = set(re.findall(r'\{ "(\w+)"', module.group(2)))
+
+# only for the layout
+parse_modules.pop("builtin", None)
+
+differ = False
+for module in sorted(set(parse_modules) | set(json_modules)):
+    only_parse = parse_modules.get(module, set()) - json_modules.get(module, set())
+    only_json = json_modules.get(module, set()) - parse_modules.get(module, set())
+    if module not in json_modules:
+        print("module '%s' is missing in the modules_table of src/json.cpp" % module)
+    elif module not in parse_modules:
+        print("module '%s' of the modules_table isn't in addValueFromModule()" % module)
+    for member in sorted(only_parse):
+        print("member '%s.%s' is missing in the modules_table of src/json.cpp" % (module, member))
+    for member in sorted(only_json):
+        print("member '%s.%s' of the modules_table isn't in addValueFromModule()" % (module, member))
+    differ |= bool(only_parse or only_json or module not in json_modules or module not in parse_modules)
+
+sys.exit(1 if differ else 0)
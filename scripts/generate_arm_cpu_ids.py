@@ -0,0 +1,117 @@
+import re
+
+# Generates include/arm_cpu_ids.hpp from util-linux's sys-utils/lscpu-arm.c
+# usage: python3 generate_arm_cpu_ids.py (with lscpu-arm.c in the current directory)
+
+part_tables = {}
+implementers = []
+
+with open("lscpu-arm.c", "r") as f:
+    file = f.read()
+
+# static const struct id_part arm_part[] = {
+#     { 0x810, "ARM810" },
+#     ...
+#     { -1, "unknown" },
+# };
+for table in re.finditer(r"struct id_part (\w+)\[\] = \{(.*?)\};", file, re.S):
+    parts = []
+    for part in re.finditer(r"\{\s*(0x[0-9a-fA-F]+)\s*,\s*\"([^\"]+)\"\s*\}", table.group(2)):
+        parts.append((int(part.group(1), 16), part.group(2)))
+    part_tables[table.group(1)] = parts
+
+# static const struct hw_impl hw_implementer[] = {
+#     { 0x41, arm_part,     "ARM" },
+#     ...
+#     { -1,   unknown_part, "unknown" },
+# };
+hw_table = re.search(r"struct hw_impl hw_implementer\[\] = \{(.*?)\};", file, re.S)
+for impl in re.finditer(r"\{\s*(0x[0-9a-fA-F]+)\s*,\s*(\w+)\s*,\s*\"([^\"]+)\"\s*\}", hw_table.group(1)):
+    implementers.append((int(impl.group(1), 16), impl.group(2), impl.group(3)))
+
+entries = []
+for impl_id, table_name, vendor in implementers:
+    for part_id, name in part_tables.get(table_name, []):
+        # implementer is 8 bits and part number is 12 bits in the MIDR register
+        entries.append(((impl_id << 12) | part_id, vendor, name))
+
+entries.sort()
+
+# power of 2 bigger than twice the entries, so the load factor of the table stays under 0.5
+table_size = 1
+while table_size < len(entries) * 2:
+    table_size *= 2
+
+print(len(entries), table_size)
+
+with open("arm_cpu_ids.hpp", "w+") as f:
+    f.write("""#ifndef _ARM_CPU_IDS_HPP
+#define _ARM_CPU_IDS_HPP
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// generated by scripts/generate_arm_cpu_ids.py from util-linux lscpu-arm.c
+
+struct arm_cpu_part_t
+{
+    std::uint32_t    midr = 0;  // (implementer << 12) | part
+    std::string_view vendor;
+    std::string_view name;
+};
+
+inline constexpr std::array<arm_cpu_part_t, %s> arm_cpu_parts_array = { {
+%s
+} };
+
+// open addressing hash table built at compile time from the array above.
+// each slot contains the index + 1 in arm_cpu_parts_array, 0 = empty slot
+inline constexpr std::size_t arm_cpu_table_size = %s;
+
+constexpr std::size_t arm_cpu_hash(const std::uint32_t midr)
+{
+    // Fibonacci hashing
+    return (static_cast<std::uint64_t>(midr) * 0x9E3779B97F4A7C15ULL) >> 40 & (arm_cpu_table_size - 1);
+}
+
+constexpr std::array<std::uint16_t, arm_cpu_table_size> build_arm_cpu_table()
+{
+    std::array<std::uint16_t, arm_cpu_table_size> table{};
+    for (std::size_t i = 0; i < arm_cpu_parts_array.size(); ++i)
+    {
+        std::size_t slot = arm_cpu_hash(arm_cpu_parts_array[i].midr);
+        while (table[slot] != 0)
+            slot = (slot + 1) & (arm_cpu_table_size - 1);
+
+        table[slot] = static_cast<std::uint16_t>(i + 1);
+    }
+    return table;
+}
+
+inline constexpr std::array<std::uint16_t, arm_cpu_table_size> arm_cpu_table = build_arm_cpu_table();
+
+/* Get the vendor and part name from the "CPU implementer" and "CPU part" values of /proc/cpuinfo
+ * @param implementer The implementer code (e.g 0x41)
+ * @param part The part number (e.g 0xd08)
+ * @return the entry, or an entry with empty vendor and name if not found
+ */
+constexpr arm_cpu_part_t arm_cpu_lookup(const std::uint32_t implementer, const std::uint32_t part)
+{
+    const std::uint32_t midr = (implementer << 12) | part;
+    for (std::size_t slot = arm_cpu_hash(midr); arm_cpu_table[slot] != 0; slot = (slot + 1) & (arm_cpu_table_size - 1))
+    {
+        if (arm_cpu_parts_array[arm_cpu_table[slot] - 1].midr == midr)
+            return arm_cpu_parts_array[arm_cpu_table[slot] - 1];
+    }
+
+    return {};
+}
+
+static_assert(arm_cpu_lookup(0x41, 0xd08).name == "Cortex-A72");
+static_assert(arm_cpu_lookup(0x41, 0xfff).name.empty());
+
+#endif  // _ARM_CPU_IDS_HPP
+""" % (len(entries),
+       "\n".join('    { 0x%05x, "%s", "%s" },' % (midr, vendor, name) for midr, vendor, name in entries),
+       table_size))
@@ -0,0 +1,86 @@
+import re
+
+# Generates the zero_width and double_width tables of src/display_width.cpp from the Unicode Character Database
+# usage: python3 generate_display_width.py (with UnicodeData.txt and EastAsianWidth.txt of Unicode 14.0 in the current directory)
+# then replace the tables in src/display_width.cpp with the content of display_width_tables.txt
+
+zero_width = set()
+wide = set()
+
+# 0300;COMBINING GRAVE ACCENT;Mn;230;NSM;;;;;N;NON-SPACING GRAVE;;;;
+# 3400;<CJK Ideograph Extension A, First>;Lo;0;L;;;;;N;;;;;
+# 4DBF;<CJK Ideograph Extension A, Last>;Lo;0;L;;;;;N;;;;;
+with open("UnicodeData.txt", "r") as f:
+    first = None
+    for line in f:
+        fields = line.split(";")
+        cp = int(fields[0], 16)
+        if fields[1].endswith(", First>"):
+            first = cp
+            continue
+
+        codepoints = range(first, cp + 1) if fields[1].endswith(", Last>") else [cp]
+        first = None
+        if fields[2] in ("Mn", "Me", "Cf"):
+            zero_width.update(codepoints)
+
+# the soft hyphen is shown by the terminals
+zero_width.discard(0x00AD)
+# the Hangul medial vowels and final consonants are joined to the initial consonant before them
+zero_width.update(range(0x1160, 0x1200))
+# the zero width space isn't a Cf
+zero_width.add(0x200B)
+
+# 1100..115F;W     # Lo    [96] HANGUL CHOSEONG KIYEOK..HANGUL CHOSEONG FILLER
+# 3000;F           # Zs         IDEOGRAPHIC SPACE
+with open("EastAsianWidth.txt", "r") as f:
+    for line in f:
+        match = re.match(r"([0-9A-F]+)(?:\.\.([0-9A-F]+))?\s*;\s*(\w+)", line)
+        if match and match.group(3) in ("W", "F"):
+            first = int(match.group(1), 16)
+            wide.update(range(first, int(match.group(2) or match.group(1), 16) + 1))
+
+# the unassigned codepoints of the planes 2 and 3 default to W
+wide.update(range(0x20000, 0x2FFFE))
+wide.update(range(0x30000, 0x3FFFE))
+# e.g the combining marks of the ideographic block
+wide -= zero_width
+
+
+def to_intervals(codepoints):
+    intervals = []
+    for cp in sorted(codepoints):
+        if intervals and intervals[-1][1] == cp - 1:
+            intervals[-1][1] = cp
+        else:
+            intervals.append([cp, cp])
+    return intervals
+
+
+def format_table(intervals):
+    lines = []
+    for i in range(0, len(intervals), 4):
+        lines.append("    " + " ".join("{ 0x%05X, 0x%05X }," % (first, last) for first, last in intervals[i:i + 4]))
+    return "\n".join(lines)
+
+
+zero_width_intervals = to_intervals(zero_width)
+double_width_intervals = to_intervals(wide)
+
+print(len(zero_width_intervals), len(double_width_intervals))
+
+with open("display_width_tables.txt", "w+") as f:
+    f.write("""// generated by scripts/generate_display_width.py from the Unicode 14.0 UnicodeData.txt and EastAsianWidth.txt:
+// general categories Mn, Me and Cf (but U+00AD), the Hangul medial vowels and final consonants and U+200B
+// clang-format off
+constexpr std::array<interval_t, %s> zero_width = { {
+%s
+} };
+
+// East Asian Width W and F, plus the unassigned codepoints of the planes 2 and 3
+constexpr std::array<interval_t, %s> double_width = { {
+%s
+} };
+// clang-format on
+""" % (len(zero_width_intervals), format_table(zero_width_intervals),
+       len(double_width_intervals), format_table(double_width_intervals)))
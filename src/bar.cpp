@@ -0,0 +1,210 @@
+/* Implementation of `cufetch --bar` */
+
+#include "bar.hpp"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <csignal>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "fmt/format.h"
+#include "output_sink.hpp"
+#include "parse.hpp"
+#include "util.hpp"
+
+// a layout line, a block of the bar
+struct block_t
+{
+    std::string                layout;
+    std::string                text;
+    std::vector<dynamic_tag_t> tags;
+
+    // the first percentage member of the line (e.g $<ram.used_perc>), for the urgency, if any
+    const dynamic_tag_t* perc = nullptr;
+    double               percentage = -1;
+};
+
+static bool is_percentage(const dynamic_tag_t& tag)
+{
+    return hasEnding(tag.member, "_perc") || tag.member == "usage" || hasStart(tag.member, "pressure_");
+}
+
+// the percentage as a number, without the colors and the '%'
+static double get_percentage(const systemInfo_t& systemInfo, const dynamic_tag_t& tag, const Config& config,
+                             const colors_t& colors)
+{
+    PlainSink sink(config, colors);
+    write_events(getInfoFromName(systemInfo, tag.module, tag.member), sink);
+
+    std::string str = sink.str();
+    if (!str.empty() && str.back() == '%')
+        str.pop_back();
+
+    try
+    {
+        return std::stod(str);
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
+
+// same thresholds as the colors of the percentages
+static std::string_view get_class(const block_t& block)
+{
+    if (block.percentage < 0)
+        return "";
+
+    // a free percentage is bad when low
+    const double used = hasStart(block.perc->member, "free") ? 100 - block.percentage : block.percentage;
+    if (used <= 45)
+        return "normal";
+    if (used <= 80)
+        return "warning";
+    return "critical";
+}
+
+static void append_string(std::string& out, const std::string_view key, const std::string_view value)
+{
+    out += fmt::format("\"{}\":\"", key);
+    json_escape(out, value);
+    out += '"';
+}
+
+// [{"name":"block0","full_text":"..."},...],
+static void append_i3bar(std::string& out, const std::vector<block_t>& blocks)
+{
+    out += '[';
+    bool first = true;
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        const block_t& block = blocks.at(i);
+        if (block.text.find(MAGIC_LINE) != block.text.npos)
+            continue;
+
+        if (!first)
+            out += ',';
+        first = false;
+
+        out += fmt::format("{{\"name\":\"block{}\",", i);
+        append_string(out, "full_text", block.text);
+        if (get_class(block) == "critical")
+            out += ",\"urgent\":true";
+        out += '}';
+    }
+    out += "],\n";
+}
+
+// {"text":"...","tooltip":"...","class":"...","percentage":N}
+// the text is the blocks on a line, the tooltip one per line
+static void append_waybar(std::string& out, const std::vector<block_t>& blocks)
+{
+    std::string    text, tooltip;
+    const block_t* perc_block = nullptr;
+    for (const block_t& block : blocks)
+    {
+        if (block.text.find(MAGIC_LINE) != block.text.npos)
+            continue;
+
+        if (!text.empty())
+        {
+            text += ' ';
+            tooltip += '\n';
+        }
+        text += block.text;
+        tooltip += block.text;
+
+        if (!perc_block && block.percentage >= 0)
+            perc_block = &block;
+    }
+
+    out += '{';
+    append_string(out, "text", text);
+    out += ',';
+    append_string(out, "tooltip", tooltip);
+    if (perc_block)
+    {
+        out += ',';
+        append_string(out, "class", get_class(*perc_block));
+        out += fmt::format(",\"percentage\":{:.0f}", perc_block->percentage);
+    }
+    out += "}\n";
+}
+
+namespace Bar
+{
+
+void run(const Config& config, const colors_t& colors)
+{
+    // for returning when the bar gets closed, instead of being killed
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // the bars don't understand the escape sequences
+    Config plain_config{ config };
+    plain_config.m_disable_colors = true;
+
+    const bool waybar = config.m_bar == "waybar";
+    const auto& interval =
+        std::chrono::milliseconds(config.m_watch_interval > 0 ? config.m_watch_interval : 1000);
+
+    std::vector<block_t>       blocks;
+    std::vector<dynamic_tag_t> tags;
+    for (const std::string& line : config.m_args_layout.empty() ? config.layout : config.m_args_layout)
+        blocks.push_back({ line, "", get_dynamic_tags(line) });
+
+    for (block_t& block : blocks)
+    {
+        tags.insert(tags.end(), block.tags.begin(), block.tags.end());
+        for (const dynamic_tag_t& tag : block.tags)
+        {
+            if (is_percentage(tag))
+            {
+                block.perc = &tag;
+                break;
+            }
+        }
+    }
+
+    systemInfo_t systemInfo;
+    std::string  out;
+    if (!waybar)
+        out = "{\"version\":1}\n[\n";
+
+    auto next_tick = std::chrono::steady_clock::now();
+    for (bool first = true;; first = false)
+    {
+        for (block_t& block : blocks)
+        {
+            // the lines without values that change are the same as the first time
+            if (!first && block.tags.empty())
+                continue;
+
+            block.text = parse(block.layout, systemInfo, plain_config, colors, true);
+            if (block.perc)
+                block.percentage = get_percentage(systemInfo, *block.perc, plain_config, colors);
+        }
+
+        if (waybar)
+            append_waybar(out, blocks);
+        else
+            append_i3bar(out, blocks);
+
+        // the bar got closed
+        if (!write_all(STDOUT_FILENO, out))
+            return;
+        out.clear();
+
+        invalidate_dynamic_tags(systemInfo, tags, interval.count());
+
+        // don't catch up the ticks missed (e.g the process got suspended)
+        next_tick = std::max(next_tick + interval, std::chrono::steady_clock::now());
+        std::this_thread::sleep_until(next_tick);
+    }
+}
+
+}  // namespace Bar
@@ -0,0 +1,162 @@
+#include "batch.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "display.hpp"
+#include "parse.hpp"
+#include "util.hpp"
+
+struct job_t
+{
+    job_t(const std::string& configFile, const std::string& configDir) : config(configFile, configDir, colors) {}
+
+    colors_t    colors;
+    Config      config;
+    std::string output;
+    std::string path;  // of the ascii art
+    bool        failed = false;
+};
+
+// split a manifest line in words, "" or '' for the ones with spaces
+static std::vector<std::string> split_words(const std::string_view line)
+{
+    std::vector<std::string> words;
+    std::string              word;
+    bool                     in_word = false;
+    char                     quote   = 0;
+    for (const char c : line)
+    {
+        if (quote)
+        {
+            if (c == quote)
+                quote = 0;
+            else
+                word += c;
+        }
+        else if (c == '"' || c == '\'')
+        {
+            quote   = c;
+            in_word = true;
+        }
+        else if (std::isspace(static_cast<unsigned char>(c)))
+        {
+            if (in_word)
+                words.push_back(std::move(word));
+            word.clear();
+            in_word = false;
+        }
+        else
+        {
+            word += c;
+            in_word = true;
+        }
+    }
+
+    if (in_word)
+        words.push_back(std::move(word));
+
+    return words;
+}
+
+namespace Batch
+{
+
+int run(const std::string& manifest, const std::string& configDir,
+        const std::function<bool(int argc, char* argv[], Config& config, const std::string& configFile)>& parse_args)
+{
+    std::ifstream file(manifest);
+    if (!file.is_open())
+        die("Could not open the batch manifest '{}'", manifest);
+
+    // the configs are read one at a time, getopt() isn't thread safe
+    std::vector<std::unique_ptr<job_t>> jobs;
+    std::string                         line;
+    for (size_t line_num = 1; std::getline(file, line); ++line_num)
+    {
+        std::vector<std::string> words = split_words(line);
+        if (words.empty() || hasStart(words.front(), "#"))
+            continue;
+
+        if (words.size() < 2)
+            die("{}:{}: expected '<config file> <output file> [options...]'", manifest, line_num);
+
+        const std::string& configFile = words.at(0) == "-" ? configDir + "/config.toml" : words.at(0);
+        if (!std::filesystem::exists(configFile))
+            die("{}:{}: config file '{}' doesn't exist", manifest, line_num, configFile);
+
+        job_t& job = *jobs.emplace_back(std::make_unique<job_t>(configFile, configDir));
+        job.output = words.at(1);
+
+        // the options as the arguments of a cufetch run
+        words.at(1) = "cufetch";
+        std::vector<char*> argv;
+        for (auto it = words.begin() + 1; it != words.end(); ++it)
+            argv.push_back(it->data());
+        argv.push_back(nullptr);
+
+        if (!parse_args(argv.size() - 1, argv.data(), job.config, configFile))
+            die("{}:{}: invalid options", manifest, line_num);
+
+        // there's no GTK window nor terminal for drawing images
+        job.config.gui = false;
+        job.path       = Display::get_source_path(job.config);
+        if (!job.config.m_disable_source && is_file_image(job.path))
+            job.config.m_disable_source = true;
+    }
+
+    if (jobs.empty())
+        return 0;
+
+    // every layout and logo line gets its modules queried once, here, so the renders only read the Query classes caches.
+    // The same lines of many configs (e.g the default layout) are queried only once
+    std::unordered_set<std::string> queried;
+    systemInfo_t                    systemInfo;
+    for (const std::unique_ptr<job_t>& job : jobs)
+    {
+        std::vector<std::string> lines;
+        for (const std::string& layout_line :
+             job->config.m_args_layout.empty() ? job->config.layout : job->config.m_args_layout)
+            if (queried.insert(layout_line).second)
+                lines.push_back(layout_line);
+
+        if (!job->config.m_disable_source)
+        {
+            std::ifstream logo(job->path);
+            std::string   logo_line;
+            while (std::getline(logo, logo_line))
+                if (queried.insert(logo_line).second)
+                    lines.push_back(logo_line);
+        }
+
+        query_layout_tags(systemInfo, lines, job->config, job->colors, { "builtin." });
+    }
+
+    debug("batch: {} renders", jobs.size());
+    parallel_for(jobs.size(), [&jobs](const size_t i) {
+        job_t& job = *jobs.at(i);
+        clear_auto_colors();
+
+        const std::string& frame = Display::to_string(Display::render(job.config, job.colors, true, job.path));
+        if (!write_file_atomic(job.output, frame))
+        {
+            error("Failed to write '{}': {}", job.output, std::strerror(errno));
+            job.failed = true;
+        }
+    });
+
+    return std::any_of(jobs.begin(), jobs.end(), [](const std::unique_ptr<job_t>& job) { return job->failed; })
+               ? 1
+               : 0;
+}
+
+}  // namespace Batch
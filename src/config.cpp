@@ -3,6 +3,7 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
 #include "util.hpp"
 
@@ -31,9 +32,9 @@ void Config::loadConfigFile(const std::string_view filename, colors_t& colors)
     }
     catch (const toml::parse_error& err)
     {
-        error("Parsing config file {} failed:", filename);
-        std::cerr << err << std::endl;
-        exit(-1);
+        std::ostringstream ss;
+        ss << err;
+        die("Parsing config file {} failed:\n{}", filename, ss.str());
     }
 
     // clang-format off
@@ -43,15 +44,21 @@ void Config::loadConfigFile(const std::string_view filename, colors_t& colors)
     this->gui                = this->getValue<bool>("gui.enable", false);
     this->slow_query_warnings= this->getValue<bool>("config.slow-query-warnings", false);
     this->sep_reset_after    = this->getValue<bool>("config.sep-reset-after", false);
+    this->progressive        = this->getValue<bool>("config.progressive", false);
     this->use_SI_unit        = this->getValue<bool>("config.use-SI-byte-unit", false);
     this->ascii_logo_type    = this->getValue<std::string>("config.ascii-logo-type", "");
     this->source_path        = this->getValue<std::string>("config.source-path", "os");
     this->data_dir           = this->getValue<std::string>("config.data-dir", "/usr/share/customfetch");
     this->sep_reset          = this->getValue<std::string>("config.sep-reset", ":");
+    this->color_depth        = this->getValue<std::string>("config.color-depth", "auto");
     this->offset             = this->getValue<std::uint16_t>("config.offset", 5);
     this->logo_padding_left  = this->getValue<std::uint16_t>("config.logo-padding-left", 0);
     this->layout_padding_top = this->getValue<std::uint16_t>("config.layout-padding-top", 0);
     this->logo_padding_top   = this->getValue<std::uint16_t>("config.logo-padding-top", 0);
+    this->sampler_interval   = this->getValue<std::uint16_t>("config.sampler-interval", 250);
+    this->daemon_refresh     = this->getValue<std::uint16_t>("config.daemon-refresh", 2000);
+    this->shared_results_ttl = this->getValue<std::uint16_t>("config.shared-results-ttl", 2000);
+    this->frame_cache_size   = this->getValue<std::uint16_t>("config.frame-cache-size", 0);
     this->font               = this->getValue<std::string>("gui.font", "Liberation Mono Normal 12");
     this->gui_bg_image       = this->getValue<std::string>("gui.bg-image", "disable");
 
@@ -68,6 +75,24 @@ void Config::loadConfigFile(const std::string_view filename, colors_t& colors)
     this->flatpak_dirs = this->getValueArrayStr("os.pkgs.flatpak-dirs", {"/var/lib/flatpak/app", "~/.local/share/flatpak/app"});
     this->apk_files    = this->getValueArrayStr("os.pkgs.apk-files",    {"/var/lib/apk/db/installed"});
 
+    this->disk_timeout = this->getValue<std::uint16_t>("disk.timeout", 1000);
+
+    this->render_deadline      = this->getValue<std::uint16_t>("deadline.render", 0);
+    this->module_deadline      = this->getValue<std::uint16_t>("deadline.module", 0);
+    this->deadline_fallback    = this->getValue<std::string>("deadline.on-timeout", "placeholder");
+    this->deadline_placeholder = this->getValue<std::string>("deadline.placeholder", "(timed out)");
+    this->slow_threshold       = this->getValue<std::uint16_t>("deadline.slow-threshold", 0);
+    if (const toml::table* deadlines = this->tbl["deadline"].as_table())
+    {
+        for (const auto& [module, value] : *deadlines)
+        {
+            const std::optional<std::uint16_t> ms = value.value<std::uint16_t>();
+            if (ms && module.str() != "render" && module.str() != "module" &&
+                module.str() != "slow-threshold")
+                this->module_deadlines.insert({ std::string(module.str()), ms.value() });
+        }
+    }
+
     colors.black       = this->getThemeValue("config.black",   "\033[1;30m");
     colors.red         = this->getThemeValue("config.red",     "\033[1;31m");
     colors.green       = this->getThemeValue("config.green",   "\033[1;32m");
@@ -86,6 +111,14 @@ void Config::loadConfigFile(const std::string_view filename, colors_t& colors)
     colors.gui_magenta = this->getThemeValue("gui.magenta", "!#ff11cc");
     colors.gui_white   = this->getThemeValue("gui.white",   "!#ffffff");
 
+    if (this->deadline_fallback != "placeholder" && this->deadline_fallback != "cached" &&
+        this->deadline_fallback != "hide")
+    {
+        warn("deadline.on-timeout '{}' isn't \"placeholder\", \"cached\" or \"hide\"\n"
+             "backing up to \"placeholder\"", this->deadline_fallback);
+        this->deadline_fallback = "placeholder";
+    }
+
     if (this->percentage_colors.size() < 3)
     {
         warn("the config array percentage-colors doesn't have 3 colors for being used in percentage tag and modules\n"
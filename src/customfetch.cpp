@@ -0,0 +1,123 @@
+#include "customfetch.hpp"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "display.hpp"
+#include "fmt/format.h"
+#include "parse.hpp"
+#include "query.hpp"
+#include "util.hpp"
+
+// the Query classes caches are shared by all the contexts
+static std::mutex query_mutex;
+
+struct customfetch::Context::impl
+{
+    impl(const std::string& configFile, const std::string& configDir) : config(configFile, configDir, colors)
+    {
+        // there's no GTK window to draw in
+        config.gui = false;
+    }
+
+    colors_t     colors;
+    Config       config;
+    systemInfo_t systemInfo;
+};
+
+static std::string default_config_path()
+{ return getConfigDir() + "/config.toml"; }
+
+// die() throws instead of killing the program using us
+template <typename Fn>
+static auto guard(Fn&& fn)
+{
+    const std::lock_guard<std::mutex> lock(query_mutex);
+    g_die_throw_pid = getpid();
+    try
+    {
+        return fn();
+    }
+    catch (const fatal_error& err)
+    {
+        throw customfetch::error(err.what());
+    }
+}
+
+customfetch::Context::Context(const std::string& configFile)
+{
+    guard([&] {
+        m_impl = std::make_unique<impl>(configFile.empty() ? default_config_path() : configFile, getConfigDir());
+    });
+}
+
+customfetch::Context::~Context()                                          = default;
+customfetch::Context::Context(Context&&) noexcept                         = default;
+customfetch::Context& customfetch::Context::operator=(Context&&) noexcept = default;
+
+std::string customfetch::Context::get(const std::string& module, const std::string& member)
+{
+    return guard([&] {
+        // e.g the percentages have their colors inside the value
+        m_impl->config.m_disable_colors = true;
+        const std::string& ret =
+            ::parse(fmt::format("$<{}.{}>", module, member), m_impl->systemInfo, m_impl->config, m_impl->colors, true);
+
+        // parse() prints "(unknown/invalid module)" instead
+        const auto& it = m_impl->systemInfo.find(module);
+        if (it == m_impl->systemInfo.end() || it->second.find(member) == it->second.end())
+            die("Invalid member '{}' of the module '{}'", member, module);
+
+        return ret;
+    });
+}
+
+std::string customfetch::Context::parse(const std::string& line, const bool colors)
+{
+    return guard([&] {
+        m_impl->config.m_disable_colors = !colors;
+        return ::parse(line, m_impl->systemInfo, m_impl->config, m_impl->colors, true);
+    });
+}
+
+std::vector<std::string> customfetch::Context::render_layout(const bool colors)
+{
+    return guard([&] {
+        m_impl->config.m_disable_colors = !colors;
+
+        std::vector<std::string> layout{ m_impl->config.layout };
+        for (std::string& line : layout)
+            line = ::parse(line, m_impl->systemInfo, m_impl->config, m_impl->colors, true);
+
+        return layout;
+    });
+}
+
+std::vector<std::string> customfetch::Context::render(const bool colors)
+{
+    return guard([&] {
+        Config& config          = m_impl->config;
+        config.m_disable_colors = !colors;
+
+        const std::string& path = Display::get_source_path(config);
+        if (!config.m_disable_source && is_file_image(path))
+            config.m_disable_source = true;
+
+        return Display::render(config, m_impl->colors, true, path);
+    });
+}
+
+void customfetch::Context::refresh()
+{
+    guard([&] {
+        // the tags of every value queried until now, the ones that change over time get dropped
+        std::string tags;
+        for (const auto& [module, members] : m_impl->systemInfo)
+            for (const auto& [member, value] : members)
+                tags += fmt::format("$<{}.{}>", module, member);
+
+        invalidate_dynamic_tags(m_impl->systemInfo, get_dynamic_tags(tags), m_impl->config.sampler_interval);
+    });
+}
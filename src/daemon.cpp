@@ -0,0 +1,463 @@
+/* Implementation of `cufetch --daemon` and `cufetch --client` */
+
+#include "daemon.hpp"
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fmt/format.h"
+#include "parse.hpp"
+#include "query.hpp"
+#include "util.hpp"
+
+/* The client sends these fields, each ending with a NUL, then closes its writing side:
+ * PROTOCOL, working directory, parent pid, arguments count, the arguments, the environment (only what's in ENV_VARS).
+ * The daemon replies with the frame, or with a single NUL if the client has to render by itself
+ */
+constexpr std::string_view PROTOCOL = "customfetch-daemon-1";
+
+// big enough for any arguments and environment
+constexpr size_t MAX_REQUEST_SIZE = 1024 * 1024;
+
+// waiting for the burst of changes of a package manager transaction to end before restarting
+constexpr int RESTART_DEBOUNCE_MS = 500;
+
+// the environment the queries and the rendering depend on, the ones ending with '_' are prefixes.
+// Not the whole environment, it has tokens and keys the daemon has nothing to do with
+constexpr std::array<std::string_view, 32> ENV_VARS = {
+    "HOME", "PATH", "USER", "LOGNAME", "SHELL", "LANG", "LC_", "NO_COLOR",
+    "TERM", "TERM_", "COLORTERM", "TERMINFO", "TERMINFO_DIRS", "TMUX", "KONSOLE_", "WT_",
+    "DISPLAY", "WAYLAND_DISPLAY", "DBUS_SESSION_BUS_ADDRESS", "XDG_", "DESKTOP_SESSION", "SESSION_DESKTOP",
+    "CURRENT_DESKTOP", "GNOME_", "KDE_", "MATE_", "CINNAMON_", "TDE_", "HYPRLAND_", "GTK_THEME",
+    "QT_QPA_PLATFORMTHEME", "DCONF_PROFILE"
+};
+
+static std::string g_socket_path;
+
+static bool is_env_needed(const std::string_view var)
+{
+    const std::string_view name = var.substr(0, var.find('='));
+    return std::any_of(ENV_VARS.begin(), ENV_VARS.end(), [name](const std::string_view env) {
+        return env.back() == '_' ? hasStart(name, env) : name == env;
+    });
+}
+
+// a directory only we can get in, so nobody else can bind the socket path before us
+static bool is_private_dir(const std::string& path)
+{
+    struct stat st;
+    return lstat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode) && st.st_uid == getuid() && (st.st_mode & 077) == 0;
+}
+
+static void append_field(std::string& request, const std::string_view field)
+{
+    request += field;
+    request += '\0';
+}
+
+static bool make_address(const std::string& path, struct sockaddr_un& addr)
+{
+    addr            = {};
+    addr.sun_family = AF_UNIX;
+    if (path.length() >= sizeof(addr.sun_path))
+        return false;
+
+    std::memcpy(addr.sun_path, path.c_str(), path.length() + 1);
+    return true;
+}
+
+static int connect_socket(const std::string& path)
+{
+    struct sockaddr_un addr;
+    if (!make_address(path, addr))
+        return -1;
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    // it's not our daemon, it would get our environment and could print anything
+    struct ucred cred;
+    socklen_t    len = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0 || cred.uid != getuid())
+    {
+        warn("The daemon socket {} isn't owned by us, not using it", path);
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static void on_exit_signal(int)
+{
+    unlink(g_socket_path.c_str());
+    _exit(0);
+}
+
+// query every module used in the layout, so the clients get them already queried.
+// Not the user and theme ones, they depend on who's asking (e.g the terminal is found from the client process)
+static void warm(const Config& config, const colors_t& colors)
+{
+    systemInfo_t systemInfo;
+    query_layout_tags(systemInfo, config.m_args_layout.empty() ? config.layout : config.m_args_layout, config,
+                      colors, { "user.", "theme", "builtin." });
+}
+
+static void refresh(const Config& config, const colors_t& colors)
+{
+    debug("daemon: refreshing the values");
+    Query::System::invalidate();
+    Query::CPU::invalidate();
+    Query::RAM::invalidate();
+    Query::Disk::invalidate();
+    Query::Sampler::invalidate();
+    warm(config, colors);
+}
+
+static void watch_path(const int fd, const std::string& path)
+{
+    if (inotify_add_watch(fd, path.c_str(),
+                          IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF |
+                              IN_MOVE_SELF) < 0)
+        debug("daemon: can't watch {}: {}", path, std::strerror(errno));
+}
+
+static void drain(const int fd)
+{
+    std::array<char, 4096> buf;
+    while (read(fd, buf.data(), buf.size()) > 0)
+        ;
+}
+
+static void restart(char* argv[])
+{
+    info("Restarting the daemon, a watched file changed");
+    std::fflush(stdout);
+
+    // by its path and not /proc/self/exe, it would be named "exe"
+    std::error_code              ec;
+    const std::filesystem::path& exe = std::filesystem::read_symlink("/proc/self/exe", ec);
+
+    // the sockets and inotify are closed on exec
+    execv(ec ? "/proc/self/exe" : exe.c_str(), argv);
+    die("Failed to restart the daemon: {}", std::strerror(errno));
+}
+
+[[noreturn]] static void serve_client(const int fd, const std::function<int(int argc, char* argv[])>& render)
+{
+    // a stuck client shouldn't leave us waiting forever
+    const struct timeval timeout = { 5, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::string            request;
+    std::array<char, 8192> buf;
+    ssize_t                n;
+    while ((n = read(fd, buf.data(), buf.size())) != 0)
+    {
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            _exit(1);
+        }
+
+        request.append(buf.data(), n);
+        if (request.length() > MAX_REQUEST_SIZE)
+            _exit(1);
+    }
+
+    std::vector<std::string> fields;
+    size_t                   start = 0, end;
+    while ((end = request.find('\0', start)) != request.npos)
+    {
+        fields.push_back(request.substr(start, end - start));
+        start = end + 1;
+    }
+
+    if (fields.size() < 4 || fields.at(0) != PROTOCOL)
+        _exit(1);
+
+    size_t argc = 0;
+    try
+    {
+        Query::User::m_parent_pid = std::stoi(fields.at(2));
+        argc                      = std::stoul(fields.at(3));
+    }
+    catch (const std::exception&)
+    {
+        _exit(1);
+    }
+
+    if (fields.size() < 4 + argc)
+        _exit(1);
+
+    // relative paths (e.g -s ./logo.txt) are from the client directory
+    if (chdir(fields.at(1).c_str()) != 0)
+        _exit(1);
+
+    // the colors depth, the desktop and so on are detected from the client environment
+    clearenv();
+    for (size_t i = 4 + argc; i < fields.size(); ++i)
+    {
+        const size_t eq = fields.at(i).find('=');
+        if (eq != std::string::npos)
+            setenv(fields.at(i).substr(0, eq).c_str(), fields.at(i).substr(eq + 1).c_str(), 1);
+    }
+
+    std::vector<char*> args{ const_cast<char*>("cufetch") };
+    for (size_t i = 4; i < 4 + argc; ++i)
+        args.push_back(fields.at(i).data());
+    args.push_back(nullptr);
+
+    dup2(fd, STDOUT_FILENO);
+    dup2(fd, STDERR_FILENO);
+
+    // getopt starts again from scratch
+    optind = 0;
+
+    const int ret = render(static_cast<int>(argc + 1), args.data());
+    if (ret == Daemon::FALLBACK)
+        write_all(STDOUT_FILENO, std::string_view("\0", 1));
+
+    std::fflush(stdout);
+    std::fflush(stderr);
+    _exit(ret == Daemon::FALLBACK ? 0 : ret);
+}
+
+namespace Daemon
+{
+
+std::string socket_path()
+{
+    const char* runtime_dir = std::getenv("XDG_RUNTIME_DIR");
+    const std::string& dir =
+        runtime_dir && runtime_dir[0] != '\0' ? std::string(runtime_dir) : fmt::format("/run/user/{}", getuid());
+    if (!is_private_dir(dir))
+    {
+        debug("{} isn't a directory only we can access, no daemon socket", dir);
+        return "";
+    }
+
+    return dir + "/customfetch.sock";
+}
+
+bool client(int argc, char* argv[])
+{
+    const std::string& path = socket_path();
+    const int          fd   = path.empty() ? -1 : connect_socket(path);
+    if (fd < 0)
+    {
+        debug("no daemon running on {}", path);
+        return false;
+    }
+
+    std::error_code ec;
+    const std::filesystem::path& cwd = std::filesystem::current_path(ec);
+
+    std::vector<std::string_view> args;
+    for (int i = 1; i < argc; ++i)
+        if (std::string_view(argv[i]) != "--client")
+            args.push_back(argv[i]);
+
+    std::string request;
+    append_field(request, PROTOCOL);
+    append_field(request, ec ? "/" : cwd.string());
+    append_field(request, fmt::to_string(getppid()));
+    append_field(request, fmt::to_string(args.size()));
+    for (const std::string_view arg : args)
+        append_field(request, arg);
+    for (char** env = environ; *env; ++env)
+        if (is_env_needed(*env))
+            append_field(request, *env);
+
+    if (!write_all(fd, request))
+    {
+        close(fd);
+        return false;
+    }
+    shutdown(fd, SHUT_WR);
+
+    // don't hang the shell startup if the daemon got stuck
+    const struct timeval timeout = { 10, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    bool                   received = false;
+    std::array<char, 8192> buf;
+    ssize_t                n;
+    while ((n = read(fd, buf.data(), buf.size())) != 0)
+    {
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        // the daemon can't render it (e.g an image)
+        if (!received && buf.at(0) == '\0')
+            break;
+
+        received = true;
+        write_all(STDOUT_FILENO, std::string_view(buf.data(), n));
+    }
+
+    close(fd);
+    return received;
+}
+
+void serve(const Config& config, const colors_t& colors, const std::string& configFile, char* argv[],
+           const std::function<int(int argc, char* argv[])>& render)
+{
+    g_socket_path = socket_path();
+    if (g_socket_path.empty())
+        die("Can't run the daemon: $XDG_RUNTIME_DIR (or /run/user/{}) must be a directory only you can access",
+            getuid());
+
+    struct sockaddr_un addr;
+    if (!make_address(g_socket_path, addr))
+        die("The daemon socket path '{}' is too long", g_socket_path);
+
+    if (const int fd = connect_socket(g_socket_path); fd >= 0)
+    {
+        close(fd);
+        die("A daemon is already running on {}", g_socket_path);
+    }
+
+    // left by a daemon that didn't exit cleanly
+    unlink(g_socket_path.c_str());
+
+    const int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0)
+        die("Failed to create the daemon socket: {}", std::strerror(errno));
+
+    // only the user can connect, and each connection gets checked too
+    const mode_t old_umask = umask(0077);
+    if (bind(listen_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0)
+        die("Failed to bind the daemon socket {}: {}", g_socket_path, std::strerror(errno));
+    umask(old_umask);
+
+    if (listen(listen_fd, 16) != 0)
+        die("Failed to listen on the daemon socket {}: {}", g_socket_path, std::strerror(errno));
+
+    std::signal(SIGINT, on_exit_signal);
+    std::signal(SIGTERM, on_exit_signal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    const int inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0)
+        warn("inotify_init1() failed: {}\nThe daemon won't restart on config or packages changes",
+             std::strerror(errno));
+    else
+    {
+        watch_path(inotify_fd, configFile);
+        watch_path(inotify_fd, "/etc/os-release");
+        for (const std::vector<std::string>& paths :
+             { config.pacman_dirs, config.dpkg_files, config.flatpak_dirs, config.apk_files })
+            for (const std::string& path : paths)
+                if (std::filesystem::exists(path))
+                    watch_path(inotify_fd, path);
+    }
+
+    warm(config, colors);
+    info("Daemon listening on {}", g_socket_path);
+    std::fflush(stdout);
+
+    using clock            = std::chrono::steady_clock;
+    const auto& interval   = std::chrono::milliseconds(config.daemon_refresh);
+    auto        next_fresh = clock::now() + interval;
+    while (true)
+    {
+        // the clients already served
+        while (waitpid(-1, nullptr, WNOHANG) > 0)
+            ;
+
+        std::array<struct pollfd, 2> fds = { { { listen_fd, POLLIN, 0 }, { inotify_fd, POLLIN, 0 } } };
+
+        int timeout = -1;
+        if (config.daemon_refresh > 0)
+            timeout = std::max<int>(0, std::chrono::duration_cast<std::chrono::milliseconds>(next_fresh - clock::now()).count());
+
+        if (poll(fds.data(), inotify_fd < 0 ? 1 : 2, timeout) < 0 && errno != EINTR)
+            die("poll() failed on the daemon socket: {}", std::strerror(errno));
+
+        if (inotify_fd >= 0 && (fds.at(1).revents & POLLIN))
+        {
+            struct pollfd inotify_pfd = { inotify_fd, POLLIN, 0 };
+            do
+                drain(inotify_fd);
+            while (poll(&inotify_pfd, 1, RESTART_DEBOUNCE_MS) > 0);
+
+            restart(argv);
+        }
+
+        if (fds.at(0).revents & POLLIN)
+        {
+            const int client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client_fd >= 0)
+            {
+                struct ucred cred;
+                socklen_t    len = sizeof(cred);
+                if (getsockopt(client_fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0 || cred.uid != getuid())
+                {
+                    close(client_fd);
+                    continue;
+                }
+
+                // nothing buffered gets printed twice by the child
+                std::fflush(stdout);
+                std::fflush(stderr);
+
+                const pid_t pid = fork();
+                if (pid == 0)
+                {
+                    close(listen_fd);
+                    if (inotify_fd >= 0)
+                        close(inotify_fd);
+                    std::signal(SIGINT, SIG_DFL);
+                    std::signal(SIGTERM, SIG_DFL);
+                    std::signal(SIGPIPE, SIG_DFL);
+                    serve_client(client_fd, render);
+                }
+                else if (pid < 0)
+                {
+                    error("fork() failed: {}\nCan't serve the client", std::strerror(errno));
+                }
+
+                close(client_fd);
+            }
+        }
+
+        if (config.daemon_refresh > 0 && clock::now() >= next_fresh)
+        {
+            refresh(config, colors);
+            next_fresh = clock::now() + interval;
+        }
+    }
+}
+
+}  // namespace Daemon
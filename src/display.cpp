@@ -6,12 +6,17 @@
 # define STB_IMAGE_IMPLEMENTATION
 #endif
 
+#include <poll.h>
 #include <pty.h>
 #include <termios.h>
 #include <unistd.h>
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -22,12 +27,17 @@
 #include "fmt/format.h"
 #include "parse.hpp"
 #include "query.hpp"
+#include "scheduler.hpp"
 #include "stb_image.h"
+#include "term_colors.hpp"
 #include "util.hpp"
 
 std::string Display::detect_distro(const Config& config)
 {
+#if DEBUG
+    // only evaluated in debug builds, it's a fork() and exec() of cat
     debug("/etc/os-release = \n{}", read_shell_exec("cat /etc/os-release"));
+#endif
 
     if (!config.m_custom_distro.empty())
     {
@@ -50,6 +60,36 @@ std::string Display::detect_distro(const Config& config)
     }
 }
 
+std::string Display::get_source_path(Config& config)
+{
+    if (config.source_path.empty() || config.source_path == "off")
+        config.m_disable_source = true;
+
+    config.m_display_distro = (config.source_path == "os");
+
+    std::string path = config.m_display_distro ? Display::detect_distro(config) : config.source_path;
+
+    if (!config.ascii_logo_type.empty() && config.m_display_distro)
+    {
+        const size_t& pos = path.rfind('.');
+
+        if (pos != std::string::npos)
+            path.insert(pos, "_" + config.ascii_logo_type);
+        else
+            path += "_" + config.ascii_logo_type;
+    }
+
+    if (!std::filesystem::exists(path) &&
+        !std::filesystem::exists((path = config.data_dir + "/ascii/linux.txt")))
+    {
+        if (!config.m_disable_source)
+            die("'{}' doesn't exist. Can't load image/text file", path);
+    }
+
+    debug("{} path = {}", __PRETTY_FUNCTION__, path);
+    return path;
+}
+
 static std::vector<std::string> render_with_image(systemInfo_t& systemInfo, std::vector<std::string>& layout,
                                                   const Config& config, const colors_t& colors, const std::string_view path,
                                                   const std::uint16_t font_width, const std::uint16_t font_height)
@@ -64,9 +104,8 @@ static std::vector<std::string> render_with_image(systemInfo_t& systemInfo, std:
     else
         die("Unable to load image '{}'", path);
 
-    std::string _;
     for (std::string& layout : layout)
-        layout = parse(layout, systemInfo, _, config, colors, true);
+        layout = parse(layout, systemInfo, config, colors, true);
 
     // erase each element for each instance of MAGIC_LINE
     layout.erase(std::remove_if(layout.begin(), layout.end(),
@@ -86,10 +125,9 @@ static std::vector<std::string> render_with_image(systemInfo_t& systemInfo, std:
             "Please currently use the GUI mode for rendering the image/gif (use -h for more details)",
             config.m_image_backend);
 
-    for (size_t i = 0; i < layout.size(); i++)
-        // took math from neofetch in get_term_size() and get_image_size(). seems to work nice
-        for (size_t _ = 0; _ < width + config.offset; _++)
-            layout.at(i).insert(0, " ");
+    // took math from neofetch in get_term_size() and get_image_size(). seems to work nice
+    for (std::string& line : layout)
+        line.insert(0, width + config.offset, ' ');
 
     return layout;
 }
@@ -141,14 +179,398 @@ static bool get_pos(int& y, int& x)
     return true;
 }
 
-std::vector<std::string> Display::render(const Config& config, const colors_t& colors, const bool already_analyzed_file,
-                                         const std::string_view path)
+// if the layout uses any rate member (e.g cpu.usage or disk(/).read_rate)
+static bool layout_needs_sampler(const std::vector<std::string>& layout)
+{
+    for (const std::string& line : layout)
+        if (line.find("cpu.usage") != std::string::npos || line.find("_rate") != std::string::npos)
+            return true;
+
+    return false;
+}
+
+// put the parsed layout along side the ascii art
+static std::vector<std::string> compose_frame(const Config& config, const std::vector<std::string>& asciiArt,
+                                              const std::vector<size_t>& pureAsciiArtLens, const int maxLineLength,
+                                              std::vector<std::string> layout)
+{
+    // erase each element for each instance of MAGIC_LINE
+    layout.erase(std::remove_if(layout.begin(), layout.end(),
+                                [](const std::string_view str) { return str.find(MAGIC_LINE) != std::string::npos; }),
+                 layout.end());
+
+    // compose every row in one go, with its final size already known,
+    // instead of inserting the paddings one character at a time
+    const std::string_view reset = (config.m_disable_colors || config.gui) ? "" : NOCOLOR;
+    const size_t           rows  = std::max(layout.size(), asciiArt.size());
+    std::vector<std::string> frame(rows);
+    for (size_t i = 0; i < rows; i++)
+    {
+        const std::string_view art = i < asciiArt.size() ? std::string_view(asciiArt.at(i)) : std::string_view();
+        std::string&           row = frame.at(i);
+
+        // logo lines past the end of the layout
+        if (i >= layout.size())
+        {
+            row.reserve(config.logo_padding_left + art.length());
+            row.append(config.logo_padding_left, ' ');
+            row += art;
+            continue;
+        }
+
+        const size_t spaces = (maxLineLength + (config.m_disable_source ? 1 : config.offset)) -
+                                (i < asciiArt.size() ? pureAsciiArtLens.at(i) : 0);
+
+        debug("spaces: {}", spaces);
+
+        row.reserve(config.logo_padding_left + art.length() + spaces + layout.at(i).length() + reset.length());
+
+        // The user-specified offset to be put before the logo
+        row.append(config.logo_padding_left, ' ');
+        row += art;
+        row.append(spaces, ' ');
+        row += layout.at(i);
+        row += reset;
+    }
+
+    return frame;
+}
+
+
+// the tags that usually take a while to be queried, e.g by running a command or by sampling
+static constexpr std::array<std::string_view, 10> slow_tags = {
+    "user.de_version", "user.wm_version", "user.terminal", "user.shell", "os.pkgs",
+    "os.initsys_version", "theme", "cpu.usage", "_rate", "disk",
+};
+
+static bool is_slow_tag(const std::string_view tag)
+{
+    return std::any_of(slow_tags.begin(), slow_tags.end(),
+                       [tag](const std::string_view slow) { return tag.find(slow) != tag.npos; });
+}
+
+/* Replace the slow tags of a layout line with "...", so it can be printed right away.
+ * Returns false if the line doesn't have any
+ */
+static bool placeholder_line(std::string& line)
+{
+    bool found = false;
+    for (size_t i = 0; i + 1 < line.length(); ++i)
+    {
+        if (line.at(i) == '\\')
+        {
+            ++i;
+            continue;
+        }
+
+        if (line.at(i) != '$')
+            continue;
+
+        size_t end = line.npos;
+        if (line.at(i + 1) == '<')
+        {
+            end = line.find('>', i);
+            if (end == line.npos || !is_slow_tag(std::string_view(line).substr(i, end - i)))
+                continue;
+        }
+        else if (line.at(i + 1) == '(')
+        {
+            // $(echo $(date)) too
+            int depth = 0;
+            for (size_t j = i + 1; j < line.length(); ++j)
+            {
+                if (line.at(j) == '(')
+                    ++depth;
+                else if (line.at(j) == ')' && --depth == 0)
+                {
+                    end = j;
+                    break;
+                }
+            }
+            if (end == line.npos)
+                continue;
+        }
+        else
+        {
+            continue;
+        }
+
+        line.replace(i, end - i + 1, "...");
+        found = true;
+        i += 2;
+    }
+
+    return found;
+}
+
+// a row can be more than a terminal line, e.g $(cmd) with a newline in its output
+static std::vector<std::string> terminal_lines(const std::vector<std::string>& frame)
+{
+    std::vector<std::string> lines;
+    lines.reserve(frame.size());
+    for (const std::string& row : frame)
+    {
+        size_t start = 0, end;
+        while ((end = row.find('\n', start)) != row.npos)
+        {
+            lines.push_back(row.substr(start, end - start));
+            start = end + 1;
+        }
+        lines.push_back(row.substr(start));
+    }
+
+    return lines;
+}
+
+static std::string minimized_row(const std::string& row)
+{
+    sgr_state_t state;
+    std::string ret{ row };
+    minimize_sgr(ret, state);
+    return ret;
+}
+
+static volatile sig_atomic_t progressive_shown = 0;
+
+// autowrap is off while the progressive frame is shown, it can't stay so after an exit, a die() or a signal
+static void restore_autowrap()
+{
+    if (progressive_shown)
+        write(STDOUT_FILENO, "\033[?7h", 5);
+    progressive_shown = 0;
+}
+
+static void on_progressive_signal(const int sig)
+{
+    restore_autowrap();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+/* Print the frame with the slow tags as "..." straight away,
+ * then rewrite in place the rows that changed once each line with slow tags is parsed.
+ * Returns false if it can't be done (e.g the frame doesn't fit in the terminal), for displaying the frame as usual
+ */
+static bool display_progressive(systemInfo_t& systemInfo, const std::vector<std::string>& layout, const Config& config,
+                                const colors_t& colors, const std::vector<std::string>& asciiArt,
+                                const std::vector<size_t>& pureAsciiArtLens, const int maxLineLength)
+{
+    struct winsize win;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &win) != 0 ||
+        std::max(layout.size(), asciiArt.size()) >= static_cast<size_t>(win.ws_row))
+        return false;
+
+    std::vector<std::string> parsed{ layout };
+    std::vector<size_t>      pending;
+    for (size_t i = 0; i < parsed.size(); ++i)
+        if (placeholder_line(parsed.at(i)))
+            pending.push_back(i);
+
+    if (pending.empty())
+        return false;
+
+    // the tags left are the fast ones, within their deadlines
+    Scheduler::query(systemInfo, parsed, config, colors);
+    for (std::string& line : parsed)
+        line = parse(line, systemInfo, config, colors, true);
+
+    std::vector<std::string> shown =
+        terminal_lines(compose_frame(config, asciiArt, pureAsciiArtLens, maxLineLength, parsed));
+
+    // registered after the first Scheduler::query(), so it runs before the exit of the stuck queries
+    static bool registered = false;
+    if (!registered)
+    {
+        registered = true;
+        std::atexit(restore_autowrap);
+    }
+
+    struct sigaction action = {}, old_int, old_term;
+    action.sa_handler       = on_progressive_signal;
+    sigaction(SIGINT, &action, &old_int);
+    sigaction(SIGTERM, &action, &old_term);
+
+    // no autowrap, each row has to stay a single terminal line for moving back to it
+    std::string out{ "\033[?7l" };
+    for (const std::string& row : shown)
+    {
+        out += minimized_row(row);
+        out += '\n';
+    }
+    std::fflush(stdout);
+    progressive_shown = 1;
+    write_all(STDOUT_FILENO, out);
+
+    // the modules of the slow lines get queried in their lanes on other threads,
+    // each line is parsed and shown here as soon as its values are there
+    std::vector<std::string> slow_lines;
+    for (const size_t i : pending)
+        slow_lines.push_back(layout.at(i));
+
+    Scheduler::query(systemInfo, slow_lines, config, colors, [&](const size_t line) {
+        const size_t i = pending.at(line);
+        parsed.at(i)   = parse(layout.at(i), systemInfo, config, colors, true);
+
+        std::vector<std::string> frame =
+            terminal_lines(compose_frame(config, asciiArt, pureAsciiArtLens, maxLineLength, parsed));
+
+        // the cursor is always at the start of the line after the frame
+        out.clear();
+        for (size_t row = 0; row < shown.size(); ++row)
+        {
+            const std::string_view new_row = row < frame.size() ? std::string_view(frame.at(row)) : std::string_view();
+            if (new_row == shown.at(row))
+                continue;
+
+            const size_t up = shown.size() - row;
+            out += fmt::format("\033[{}A\r\033[2K{}\033[{}B\r", up, minimized_row(std::string(new_row)), up);
+        }
+
+        for (size_t row = shown.size(); row < frame.size(); ++row)
+        {
+            out += minimized_row(frame.at(row));
+            out += '\n';
+        }
+
+        // the frame shrank (e.g a module isn't available and its line got removed)
+        if (frame.size() < shown.size())
+            out += fmt::format("\033[{}A", shown.size() - frame.size());
+
+        write_all(STDOUT_FILENO, out);
+        shown = std::move(frame);
+    });
+
+    restore_autowrap();
+    sigaction(SIGINT, &old_int, nullptr);
+    sigaction(SIGTERM, &old_term, nullptr);
+    return true;
+}
+
+static volatile sig_atomic_t watch_stop    = 0;
+static volatile sig_atomic_t watch_resized = 0;
+
+static void on_watch_signal(const int sig)
+{
+    if (sig == SIGWINCH)
+        watch_resized = 1;
+    else
+        watch_stop = 1;
+}
+
+static std::uint16_t get_term_rows()
+{
+    struct winsize win;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &win) != 0 || win.ws_row == 0)
+        return UINT16_MAX;
+
+    return win.ws_row;
+}
+
+/* Display the frame from the top of the terminal, then keep it updated until interrupted.
+ * On each tick only the modules that change and the lines that use them are queried and parsed again,
+ * and only the cells that changed get printed
+ */
+static void watch_frame(systemInfo_t& systemInfo, const std::vector<std::string>& layout, const Config& config,
+                        const colors_t& colors, const std::vector<std::string>& asciiArt,
+                        const std::vector<size_t>& pureAsciiArtLens, const int maxLineLength)
+{
+    std::vector<std::string>                parsed(layout.size());
+    std::vector<std::vector<dynamic_tag_t>> line_tags(layout.size());
+    std::vector<dynamic_tag_t>              tags;
+    for (size_t i = 0; i < layout.size(); ++i)
+    {
+        parsed.at(i)    = parse(layout.at(i), systemInfo, config, colors, true);
+        line_tags.at(i) = get_dynamic_tags(layout.at(i));
+        tags.insert(tags.end(), line_tags.at(i).begin(), line_tags.at(i).end());
+    }
+
+    struct sigaction action = {};
+    action.sa_handler       = on_watch_signal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    sigaction(SIGWINCH, &action, nullptr);
+
+    const auto& interval = std::chrono::milliseconds(config.m_watch_interval);
+    invalidate_dynamic_tags(systemInfo, tags, config.m_watch_interval);
+
+    std::vector<std::string> shown;
+    std::uint16_t            rows = 0;
+    bool                     redraw = true;
+    auto                     next_tick = std::chrono::steady_clock::now() + interval;
+    while (!watch_stop)
+    {
+        const std::vector<std::string>& frame =
+            terminal_lines(compose_frame(config, asciiArt, pureAsciiArtLens, maxLineLength, parsed));
+
+        std::string out;
+        if (redraw)
+        {
+            // no cursor and no autowrap, each row has to stay a single terminal line
+            rows = get_term_rows();
+            out  = "\033[?25l\033[?7l\033[H\033[2J";
+            for (size_t row = 0; row < frame.size() && row < rows; ++row)
+            {
+                out += fmt::format("\033[{};1H", row + 1);
+                out += minimized_row(frame.at(row));
+            }
+            redraw = false;
+        }
+        else
+        {
+            for (size_t row = 0; row < std::max(frame.size(), shown.size()) && row < rows; ++row)
+                out += diff_line(row < shown.size() ? shown.at(row) : "", row < frame.size() ? frame.at(row) : "", row);
+        }
+
+        if (!out.empty())
+            write_all(STDOUT_FILENO, out);
+        shown = frame;
+
+        // poll() for sleeping, it gets interrupted by the signals
+        while (!watch_stop && !watch_resized && std::chrono::steady_clock::now() < next_tick)
+            poll(nullptr, 0,
+                 std::chrono::duration_cast<std::chrono::milliseconds>(next_tick - std::chrono::steady_clock::now()).count() + 1);
+
+        if (watch_resized)
+        {
+            watch_resized = 0;
+            redraw        = true;
+            continue;
+        }
+
+        // don't catch up the ticks missed (e.g the process got suspended)
+        next_tick = std::max(next_tick + interval, std::chrono::steady_clock::now());
+
+        for (size_t i = 0; i < layout.size(); ++i)
+            if (!line_tags.at(i).empty())
+                parsed.at(i) = parse(layout.at(i), systemInfo, config, colors, true);
+
+        invalidate_dynamic_tags(systemInfo, tags, config.m_watch_interval);
+    }
+
+    write_all(STDOUT_FILENO, fmt::format("\033[0m\033[?7h\033[?25h\033[{};1H", std::min<size_t>(shown.size(), rows) + 1));
+}
+
+enum render_mode_t
+{
+    RENDER_FRAME,        // only return the frame
+    RENDER_PROGRESSIVE,  // display it with the slow tags as "...", then patch them in place
+    RENDER_WATCH         // display it and keep it updated
+};
+
+// Display::render(), but if progressive or watching it displays the frame by itself and returns nothing
+static std::vector<std::string> render_frame(const Config& config, const colors_t& colors, const bool already_analyzed_file,
+                                             const std::string_view path, const render_mode_t mode,
+                                             systemInfo_t systemInfo = {})
 {
-    systemInfo_t             systemInfo{};
     std::vector<std::string> asciiArt{}, layout{ config.m_args_layout.empty() ? config.layout : config.m_args_layout };
 
     debug("Display::render path = {}", path);
 
+    // take the first sample as soon as possible,
+    // so the sampler interval overlaps with the logo and the other modules queries
+    if (config.m_from_snapshot.empty() && layout_needs_sampler(layout))
+        Query::Sampler::start(config.sampler_interval);
+
     bool isImage = false;
     std::ifstream file;
     std::ifstream fileToAnalyze;  // both have same path
@@ -188,12 +610,18 @@ std::vector<std::string> Display::render(const Config& config, const colors_t& c
 
         // this is just for parse() to auto add the distro colors
         std::ifstream distro_file(distro_path);
-        std::string   line, _;
+        std::string   line;
 
         while (std::getline(distro_file, line))
-            parse(line, systemInfo, _, config, colors, false);
+            parse(line, systemInfo, config, colors, false);
     }
 
+    // the modules of the layout get queried (on other threads, within their deadlines) and their times recorded.
+    // The progressive display queries them itself, the slow lines in the background
+    const bool query_layout = config.m_from_snapshot.empty() && !config.m_print_logo_only;
+    if (query_layout && (mode != RENDER_PROGRESSIVE || isImage))
+        Scheduler::query(systemInfo, layout, config, colors);
+
     std::vector<size_t> pureAsciiArtLens;
     int                 maxLineLength = -1;
 
@@ -231,41 +659,18 @@ std::vector<std::string> Display::render(const Config& config, const colors_t& c
     std::string line;
     while (std::getline(file, line))
     {
-        std::string pureOutput;
-        std::string asciiArt_s = parse(line, systemInfo, pureOutput, config, colors, false);
-        if (!config.m_disable_colors)
-            asciiArt_s += config.gui ? "" : NOCOLOR;
-
-        if (config.gui)
-        {
-            // check parse.cpp
-            const size_t pos = asciiArt_s.rfind("$ </");
-            if (pos != std::string::npos)
-                asciiArt_s.replace(pos, 2, "$");
-        }
+        // the colors still set at the end of the line get reset by the sink
+        const std::unique_ptr<OutputSink>& sink = make_output_sink(config, colors);
+        parse(line, systemInfo, *sink, config, colors, false);
+        const std::string& asciiArt_s = sink->str();
 
         asciiArt.push_back(asciiArt_s);
-        size_t pureOutputLen = pureOutput.length();
 
         // shootout to my bf BurntRanch that helped me with this whole project
         // with the parsing and addValueFromModule()
         // and also fixing the problem with calculating the aligniment
         // with unicode characters
-        size_t remainingUnicodeChars = 0;
-        for (unsigned char c : pureOutput)
-        {
-            if (remainingUnicodeChars > 0)
-            {
-                remainingUnicodeChars--;
-                continue;
-            }
-            // debug("c = {:c}", c);
-            if (c > 127)
-            {
-                remainingUnicodeChars = 2;
-                pureOutputLen -= 2;
-            }
-        }
+        const size_t pureOutputLen = sink->width();
 
         if (static_cast<int>(pureOutputLen) > maxLineLength)
             maxLineLength = static_cast<int>(pureOutputLen);
@@ -277,60 +682,82 @@ std::vector<std::string> Display::render(const Config& config, const colors_t& c
     if (config.m_print_logo_only)
         return asciiArt;
 
-    std::string _;
-    for (std::string& layout : layout)
-        layout = parse(layout, systemInfo, _, config, colors, true);
+    if (mode == RENDER_PROGRESSIVE &&
+        display_progressive(systemInfo, layout, config, colors, asciiArt, pureAsciiArtLens, maxLineLength))
+        return {};
 
-    // erase each element for each instance of MAGIC_LINE
-    layout.erase(std::remove_if(layout.begin(), layout.end(),
-                                [](const std::string_view str) { return str.find(MAGIC_LINE) != std::string::npos; }),
-                 layout.end());
+    if (mode == RENDER_PROGRESSIVE && query_layout)
+        Scheduler::query(systemInfo, layout, config, colors);
 
-    size_t i;
-    for (i = 0; i < layout.size(); i++)
+    if (mode == RENDER_WATCH)
     {
-        size_t origin = config.logo_padding_left;
-
-        // The user-specified offset to be put before the logo
-        for (size_t j = 0; j < config.logo_padding_left; j++)
-            layout.at(i).insert(0, " ");
+        watch_frame(systemInfo, layout, config, colors, asciiArt, pureAsciiArtLens, maxLineLength);
+        return {};
+    }
 
-        if (i < asciiArt.size())
-        {
-            layout.at(i).insert(origin, asciiArt.at(i));
-            origin += asciiArt.at(i).length();
-        }
+    for (std::string& layout : layout)
+        layout = parse(layout, systemInfo, config, colors, true);
 
-        const size_t spaces = (maxLineLength + (config.m_disable_source ? 1 : config.offset)) -
-                                (i < asciiArt.size() ? pureAsciiArtLens.at(i) : 0);
+    return compose_frame(config, asciiArt, pureAsciiArtLens, maxLineLength, layout);
+}
 
-        debug("spaces: {}", spaces);
+std::vector<std::string> Display::render(const Config& config, const colors_t& colors, const bool already_analyzed_file,
+                                         const std::string_view path, const systemInfo_t& systemInfo)
+{
+    return render_frame(config, colors, already_analyzed_file, path, RENDER_FRAME, systemInfo);
+}
 
-        for (size_t j = 0; j < spaces; j++)
-            layout.at(i).insert(origin, " ");
+void Display::display_progressive(const Config& config, const colors_t& colors, const std::string_view path)
+{
+    // not in a terminal, or with an image or the logo only, it's displayed as usual
+    const bool progressive = isatty(STDOUT_FILENO) && !config.gui;
+    const std::vector<std::string>& frame =
+        render_frame(config, colors, false, path, progressive ? RENDER_PROGRESSIVE : RENDER_FRAME);
+    if (!frame.empty())
+        Display::display(frame);
+}
 
-        if (!config.m_disable_colors)
-            layout.at(i) += config.gui ? "" : NOCOLOR;
-    }
+void Display::watch(const Config& config, const colors_t& colors, const std::string_view path)
+{
+    if (!isatty(STDOUT_FILENO))
+        die("--watch needs to be run in a terminal");
 
-    for (; i < asciiArt.size(); i++)
-    {
-        std::string line;
-        line.reserve(config.logo_padding_left + asciiArt.at(i).length());
+    // images and the logo only are displayed once
+    const std::vector<std::string>& frame = render_frame(config, colors, false, path, RENDER_WATCH);
+    if (!frame.empty())
+        Display::display(frame);
+}
 
-        for (size_t j = 0; j < config.logo_padding_left; j++)
-            line += ' ';
+std::string Display::to_string(const std::vector<std::string>& renderResult)
+{
+    size_t len = 0;
+    for (const std::string& str : renderResult)
+        len += str.length() + 1;
 
-        line += asciiArt.at(i);
+    // the whole frame goes out in a single write(),
+    // many small writes stall a lot over slow links (e.g SSH)
+    std::string frame;
+    frame.reserve(len);
 
-        layout.push_back(line);
+    // the same colors are set and reset many times in a row, e.g at the end of each line
+    sgr_state_t state;
+    std::string line;
+    for (const std::string& str : renderResult)
+    {
+        line = str;
+        minimize_sgr(line, state);
+        frame += line;
+        frame += '\n';
     }
 
-    return layout;
+    return frame;
 }
 
 void Display::display(const std::vector<std::string>& renderResult)
 {
-    for (const std::string_view str : renderResult)
-        fmt::println("{}", str);
+    const std::string& frame = Display::to_string(renderResult);
+
+    // anything still in the stdio buffer (e.g the cursor position for images) goes first
+    std::fflush(stdout);
+    write_all(STDOUT_FILENO, frame);
 }
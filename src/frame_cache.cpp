@@ -0,0 +1,244 @@
+/* The cache of the whole frames, see FrameCache::display() */
+
+#include "frame_cache.hpp"
+
+#include <pwd.h>
+#include <sys/ioctl.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "display.hpp"
+#include "fmt/format.h"
+#include "parse.hpp"
+#include "shared.hpp"
+#include "switch_fnv1a.hpp"
+#include "term_colors.hpp"
+#include "util.hpp"
+
+// for the values not in the key, e.g the GPU name after a driver update
+constexpr std::chrono::hours FRAME_MAX_AGE{ 1 };
+
+static void append_mtime(std::string& key, const std::string& path)
+{
+    std::error_code ec;
+    key += fmt::format("{}:{}\n", path, std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+}
+
+static std::string read_proc(const pid_t pid, const std::string_view file)
+{
+    std::ifstream f(fmt::format("/proc/{}/{}", pid, file));
+    std::string   line;
+    std::getline(f, line);
+    return line;
+}
+
+static pid_t get_parent_pid(const pid_t pid)
+{
+    std::ifstream f(fmt::format("/proc/{}/status", pid));
+    std::string   line;
+    while (std::getline(f, line))
+        if (hasStart(line, "PPid:"))
+            return std::atoi(line.substr("PPid:"_len).c_str());
+
+    return 0;
+}
+
+// what the members of the host and of who started us come from, without querying them:
+// the hostname and the kernel (e.g a home shared over NFS), the shell and the terminal (the parent processes)
+static void append_process(std::string& key)
+{
+    struct utsname uts{};
+    uname(&uts);
+    key += fmt::format("{}\n{}\n{}\n", uts.nodename, uts.release, uts.version);
+
+    if (const struct passwd* pwd = getpwuid(getuid()))
+        key += fmt::format("{}\n", pwd->pw_shell);
+
+    // cufetch -> shell -> terminal
+    std::error_code ec;
+    pid_t           pid = getppid();
+    for (int i = 0; i < 2 && pid > 0; ++i, pid = get_parent_pid(pid))
+        key += fmt::format("{}:{}\n", read_proc(pid, "comm"),
+                           std::filesystem::read_symlink(fmt::format("/proc/{}/exe", pid), ec).string());
+}
+
+// the values that change without anything of the key changing:
+// the themes (e.g the gtk settings.ini, kdeglobals or the dconf db) and the versions (e.g a shell built by hand)
+static bool is_unkeyed_tag(const std::string_view tag)
+{
+    return hasStart(tag, "theme") ||
+           (hasStart(tag, "user.") &&
+            (tag.find("version") != tag.npos || tag == "user.shell" || tag == "user.terminal"));
+}
+
+// the commands output can't be known without running them, nor the values of the unkeyed tags without querying them
+static bool has_uncacheable(const std::string_view text)
+{
+    if (text.find("$(") != text.npos)
+        return true;
+
+    size_t start = 0;
+    while ((start = text.find("$<", start)) != text.npos)
+    {
+        const size_t end = text.find('>', start);
+        if (end == text.npos)
+            break;
+
+        if (is_unkeyed_tag(text.substr(start + 2, end - start - 2)))
+            return true;
+        start = end;
+    }
+
+    return false;
+}
+
+static bool has_uncacheable(const Config& config, const std::string& path)
+{
+    for (const std::string& line : config.m_args_layout.empty() ? config.layout : config.m_args_layout)
+        if (has_uncacheable(line))
+            return true;
+
+    if (config.m_disable_source)
+        return false;
+
+    std::ifstream     file(path, std::ios::binary);
+    const std::string logo{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    return has_uncacheable(logo);
+}
+
+// everything the frame depends on, but the values that don't change (e.g the CPU or the OS name).
+// The dynamic tags get queried here in systemInfo, their values are part of the key
+static std::string get_key(systemInfo_t& systemInfo, const Config& config, const colors_t& colors,
+                           const std::string& path, const std::vector<std::string>& dynamic_tags)
+{
+    // the frames expire, at the latest FRAME_MAX_AGE after being cached
+    const auto& now = std::chrono::system_clock::now().time_since_epoch();
+    std::string key = fmt::format("{}\n{}\n", config.m_shared_key, now / FRAME_MAX_AGE);
+
+    for (const std::string& line : config.m_args_layout.empty() ? config.layout : config.m_args_layout)
+        key += line + '\n';
+
+    if (!config.m_disable_source)
+        append_mtime(key, path);
+
+    // the package count and the distro
+    append_mtime(key, "/etc/os-release");
+    for (const std::vector<std::string>& paths :
+         { config.pacman_dirs, config.dpkg_files, config.flatpak_dirs, config.apk_files })
+        for (const std::string& pkgs_path : paths)
+            append_mtime(key, pkgs_path);
+
+    struct winsize win{};
+    if (!isatty(STDOUT_FILENO) || ioctl(STDOUT_FILENO, TIOCGWINSZ, &win) != 0)
+        win.ws_col = 0;
+    key += fmt::format("{}\n{}\n", win.ws_col, config.m_disable_colors ? -1 : get_color_depth(config.color_depth));
+    append_process(key);
+    for (const char* var : { "TERM", "COLORTERM", "TERM_PROGRAM", "XDG_CURRENT_DESKTOP", "DESKTOP_SESSION", "DISPLAY",
+                             "WAYLAND_DISPLAY" })
+    {
+        const char* value = std::getenv(var);
+        key += fmt::format("{}={}\n", var, value ? value : "");
+    }
+
+    for (const std::string& tag : dynamic_tags)
+        key += parse(tag, systemInfo, config, colors, true) + '\n';
+
+    return fmt::format("{:016x}", fnv1a64::hash(key));
+}
+
+// the least recently used ones first, but the one just written
+static void evict(const std::filesystem::path& dir, const std::filesystem::path& keep, const std::uintmax_t max_size)
+{
+    using frame_t = std::pair<std::filesystem::file_time_type, std::filesystem::path>;
+
+    std::error_code      ec;
+    std::vector<frame_t> frames;
+    std::uintmax_t       total = 0;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(dir, ec))
+    {
+        if (!entry.is_regular_file(ec))
+            continue;
+
+        total += entry.file_size(ec);
+        if (entry.path() != keep)
+            frames.emplace_back(entry.last_write_time(ec), entry.path());
+    }
+
+    std::sort(frames.begin(), frames.end());
+    for (auto it = frames.begin(); total > max_size && it != frames.end(); ++it)
+    {
+        total -= std::min(total, std::filesystem::file_size(it->second, ec));
+        std::filesystem::remove(it->second, ec);
+        debug("frame cache: evicted {}", it->second.string());
+    }
+}
+
+namespace FrameCache
+{
+
+bool display(const Config& config, const colors_t& colors, const std::string& path)
+{
+    if (config.frame_cache_size == 0 || config.m_shared_key == 0 || config.gui ||
+        (!config.m_disable_source && is_file_image(path)) || has_uncacheable(config, path))
+        return false;
+
+    std::vector<std::string> dynamic_tags;
+    for (const std::string& line : config.m_args_layout.empty() ? config.layout : config.m_args_layout)
+    {
+        for (const dynamic_tag_t& tag : get_dynamic_tags(line))
+        {
+            // they're never the same
+            if (tag.deps & DEP_SAMPLER)
+                return false;
+
+            dynamic_tags.push_back(fmt::format("$<{}.{}>", tag.module, tag.member));
+        }
+    }
+
+    const std::filesystem::path& dir   = std::filesystem::path(getCacheDir()) / "frames";
+    systemInfo_t                 systemInfo;
+    const std::filesystem::path& cache = dir / get_key(systemInfo, config, colors, path, dynamic_tags);
+
+    std::error_code ec;
+    std::ifstream   file(cache, std::ios::binary);
+    if (file.is_open())
+    {
+        debug("frame cache: hit {}", cache.string());
+        const std::string frame{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+        write_all(STDOUT_FILENO, frame);
+
+        // it's the least recently used order for evict()
+        std::filesystem::last_write_time(cache, std::filesystem::file_time_type::clock::now(), ec);
+        return true;
+    }
+
+    // the dynamic tags are already queried
+    for (auto& [module, members] : Shared::get(config, colors))
+        systemInfo[module].merge(members);
+    const std::string& frame = Display::to_string(Display::render(config, colors, false, path, systemInfo));
+    std::fflush(stdout);
+    write_all(STDOUT_FILENO, frame);
+
+    std::filesystem::create_directories(dir, ec);
+    if (!write_file_atomic(cache.string(), frame, 0600))
+    {
+        debug("frame cache: failed to write {}: {}", cache.string(), std::strerror(errno));
+        return true;
+    }
+
+    evict(dir, cache, static_cast<std::uintmax_t>(config.frame_cache_size) * 1024);
+    return true;
+}
+
+}  // namespace FrameCache
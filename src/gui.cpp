@@ -60,13 +60,13 @@ static std::vector<std::string> render_with_image(const Config& config, const co
 
     // this is just for parse() to auto add the distro colors
     std::ifstream file(path, std::ios::binary);
-    std::string   line, _;
+    std::string   line;
 
     while (std::getline(file, line))
-        parse(line, systemInfo, _, config, colors, false);
+        parse(line, systemInfo, config, colors, false);
 
     for (std::string& layout : layout)
-        layout = parse(layout, systemInfo, _, config, colors, true);
+        layout = parse(layout, systemInfo, config, colors, true);
 
     // erase each element for each instance of MAGIC_LINE
     layout.erase(std::remove_if(layout.begin(), layout.end(),
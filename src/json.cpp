@@ -0,0 +1,350 @@
+#include "json.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fmt/format.h"
+#include "output_sink.hpp"
+#include "parse.hpp"
+#include "query.hpp"
+#include "util.hpp"
+
+enum value_type_t
+{
+    VALUE_STRING,
+    VALUE_NUMBER,   // a number even if stored as string, e.g "3.97"
+    VALUE_PERCENT,  // the colored percentage, e.g "12.34%"
+    VALUE_BYTES     // queried with the "-B" variant
+};
+
+struct member_t
+{
+    std::string  name;
+    value_type_t type = VALUE_STRING;
+};
+
+struct module_t
+{
+    std::string_view      name;
+    // the module queried when printing all of them, empty for skipping it
+    std::string_view      instance;
+    std::vector<member_t> members;
+};
+
+// clang-format off
+// same as the ones in `cufetch -l`, except builtin which is only for the layout.
+// Kept in sync with addValueFromModule() by scripts/check_modules_table.py
+static const std::vector<module_t> modules_table = {
+    { "os", "os", {
+        { "name" }, { "kernel" }, { "kernel_name" }, { "kernel_version" }, { "version_id" }, { "version_codename" },
+        { "pkgs" }, { "uptime" }, { "uptime_secs", VALUE_NUMBER }, { "uptime_mins", VALUE_NUMBER },
+        { "uptime_hours", VALUE_NUMBER }, { "uptime_days", VALUE_NUMBER }, { "hostname" },
+        { "initsys_name" }, { "initsys_version" } } },
+
+    { "system", "system", {
+        { "host" }, { "host_name" }, { "host_version" }, { "host_vendor" }, { "arch" } } },
+
+    { "user", "user", {
+        { "name" }, { "shell" }, { "shell_name" }, { "shell_path" }, { "shell_version" }, { "de_name" },
+        { "de_version" }, { "wm_name" }, { "wm_version" }, { "terminal" }, { "terminal_name" },
+        { "terminal_version" } } },
+
+    { "cpu", "cpu", {
+        { "cpu" }, { "name" }, { "nproc", VALUE_NUMBER }, { "freq_bios_limit", VALUE_NUMBER },
+        { "freq_cur", VALUE_NUMBER }, { "freq_min", VALUE_NUMBER }, { "freq_max", VALUE_NUMBER },
+        { "usage", VALUE_PERCENT } } },
+
+    { "gpu", "gpu", {
+        { "name" }, { "vendor" }, { "vendor_long" } } },
+
+    { "ram", "ram", {
+        { "ram" }, { "used", VALUE_BYTES }, { "free", VALUE_BYTES }, { "total", VALUE_BYTES },
+        { "used_perc", VALUE_PERCENT }, { "free_perc", VALUE_PERCENT }, { "cached", VALUE_BYTES },
+        { "buffers", VALUE_BYTES }, { "shmem", VALUE_BYTES }, { "dirty", VALUE_BYTES },
+        { "writeback", VALUE_BYTES }, { "zswap", VALUE_BYTES }, { "zswapped", VALUE_BYTES },
+        { "zswap_ratio", VALUE_NUMBER }, { "hugetlb", VALUE_BYTES }, { "hugepage_size", VALUE_BYTES },
+        { "hugepages_total", VALUE_NUMBER }, { "hugepages_free", VALUE_NUMBER },
+        { "pressure_some", VALUE_PERCENT }, { "pressure_full", VALUE_PERCENT } } },
+
+    { "zram", "zram", {
+        { "zram" }, { "orig", VALUE_BYTES }, { "compr", VALUE_BYTES }, { "used", VALUE_BYTES },
+        { "total", VALUE_BYTES }, { "ratio", VALUE_NUMBER } } },
+
+    { "swap", "swap", {
+        { "swap" }, { "used", VALUE_BYTES }, { "free", VALUE_BYTES }, { "total", VALUE_BYTES },
+        { "used_perc", VALUE_PERCENT }, { "free_perc", VALUE_PERCENT } } },
+
+    { "disk", "disk(/)", {
+        { "disk" }, { "used", VALUE_BYTES }, { "free", VALUE_BYTES }, { "total", VALUE_BYTES },
+        { "used_perc", VALUE_PERCENT }, { "free_perc", VALUE_PERCENT }, { "fs" }, { "device" }, { "mountdir" },
+        { "read_rate", VALUE_BYTES }, { "write_rate", VALUE_BYTES } } },
+
+    { "disks", "disks", {
+        { "disks" }, { "mountdirs" }, { "count", VALUE_NUMBER }, { "used", VALUE_BYTES },
+        { "free", VALUE_BYTES }, { "total", VALUE_BYTES }, { "used_perc", VALUE_PERCENT },
+        { "free_perc", VALUE_PERCENT } } },
+
+    { "net", "net", {
+        { "rx_rate", VALUE_BYTES }, { "tx_rate", VALUE_BYTES } } },
+
+    { "theme", "theme", {
+        { "cursor" }, { "cursor_name" }, { "cursor_size", VALUE_NUMBER } } },
+
+    { "theme-gsettings", "theme-gsettings", {
+        { "name" }, { "icons" }, { "font" }, { "cursor" }, { "cursor_name" }, { "cursor_size", VALUE_NUMBER } } },
+
+    { "theme-gtk-all", "theme-gtk-all", {
+        { "name" }, { "icons" }, { "font" } } },
+
+    // theme-gtkN, already in theme-gtk-all
+    { "theme-gtk", "", {
+        { "name" }, { "icons" }, { "font" } } },
+
+    { "theme-qt", "theme-qt", {
+        { "style" }, { "color_scheme" }, { "icons" }, { "font" }, { "cursor" }, { "cursor_name" },
+        { "cursor_size", VALUE_NUMBER } } },
+};
+// clang-format on
+
+// e.g "disk(/home)" -> disk, "gpu1" -> gpu, "theme-gtk3" -> theme-gtk
+static const module_t* find_module(const std::string_view name)
+{
+    for (const module_t& module : modules_table)
+        if (name == module.name)
+            return &module;
+
+    for (const module_t& module : modules_table)
+    {
+        if (name.length() > module.name.length() && hasStart(name, module.name) &&
+            (name.at(module.name.length()) == '(' || std::isdigit(static_cast<unsigned char>(name.at(module.name.length())))))
+            return &module;
+    }
+
+    return nullptr;
+}
+
+// the value written as it is, if it's a JSON number
+static bool is_number(const std::string_view str)
+{
+    // from_chars() also takes "inf" and "nan"
+    if (str.empty() || !std::isdigit(static_cast<unsigned char>(str.back())))
+        return false;
+
+    double n;
+    const auto& [ptr, ec] = std::from_chars(str.data(), str.data() + str.length(), n);
+    return ec == std::errc() && ptr == str.data() + str.length();
+}
+
+/* Writes the JSON to stdout while it's being built,
+ * the values are escaped straight from systemInfo into a single buffer
+ */
+class Writer
+{
+public:
+    Writer(const Config& config, const colors_t& colors) : m_config(config), m_colors(colors)
+    { m_buf.reserve(BUF_SIZE); }
+
+    ~Writer()
+    { flush(); }
+
+    void key(const std::string_view name, const bool first)
+    {
+        if (!first)
+            m_buf += ',';
+        m_buf += '"';
+        json_escape(m_buf, name);
+        m_buf += "\":";
+    }
+
+    void raw(const std::string_view str)
+    {
+        m_buf += str;
+        if (m_buf.length() >= BUF_SIZE)
+            flush();
+    }
+
+    void value(const variant& value, const value_type_t type)
+    {
+        if (std::holds_alternative<size_t>(value))
+            return raw(fmt::to_string(std::get<size_t>(value)));
+
+        if (std::holds_alternative<double>(value))
+            return raw(type == VALUE_BYTES ? fmt::format("{:.0f}", std::get<double>(value))
+                                           : fmt::format("{:.2f}", std::get<double>(value)));
+
+        const std::string& str = std::get<std::string>(value);
+        if (str == MAGIC_LINE || str == UNKNOWN)
+            return raw("null");
+
+        // the colors are events in the string, only the text is needed
+        if (str.find(EVENT_START) == std::string::npos)
+            return string(str, type);
+
+        PlainSink sink(m_config, m_colors);
+        write_events(str, sink);
+        string(sink.str(), type);
+    }
+
+    void flush()
+    {
+        write_all(STDOUT_FILENO, m_buf);
+        m_buf.clear();
+    }
+
+private:
+    void string(std::string_view str, const value_type_t type)
+    {
+        if (type == VALUE_PERCENT && !str.empty() && str.back() == '%')
+            str.remove_suffix(1);
+
+        if (type != VALUE_STRING)
+            return raw(is_number(str) ? str : "null");
+
+        m_buf += '"';
+        json_escape(m_buf, str);
+        raw("\"");
+    }
+
+    static constexpr size_t BUF_SIZE = 64 * 1024;
+
+    const Config&   m_config;
+    const colors_t& m_colors;
+    std::string     m_buf;
+};
+
+namespace JSON
+{
+
+void query(systemInfo_t& systemInfo, const Config& config, const colors_t& colors,
+           const std::vector<std::string>& instances)
+{
+    const bool   parsingLayout = true;
+    parse_args_t parse_args{ systemInfo, config, colors, parsingLayout };
+
+    const auto& query_module = [&parse_args](const std::string& instance, const module_t& module) {
+        for (const member_t& member : module.members)
+        {
+            addValueFromModule(instance, member.name, parse_args);
+            if (member.type == VALUE_BYTES)
+                addValueFromModule(instance, member.name + "-B", parse_args);
+        }
+    };
+
+    for (const module_t& module : modules_table)
+        if (!module.instance.empty())
+            query_module(std::string(module.instance), module);
+
+    for (const std::string& instance : instances)
+        if (const module_t* module = find_module(instance))
+            query_module(instance, *module);
+}
+
+void print(const Config& config, const colors_t& colors, const std::vector<std::string>& modules)
+{
+    systemInfo_t systemInfo;
+    const bool   parsingLayout = true;
+    parse_args_t parse_args{ systemInfo, config, colors, parsingLayout };
+
+    // module name -> the members to print, in order
+    std::vector<std::pair<std::string, std::vector<member_t>>> requested;
+    const auto& request = [&requested](const std::string& name, const member_t& member) {
+        auto it = std::find_if(requested.begin(), requested.end(), [&](const auto& pair) { return pair.first == name; });
+        if (it == requested.end())
+            it = requested.insert(requested.end(), { name, {} });
+
+        // e.g "os,os.name", a key only once
+        if (std::none_of(it->second.begin(), it->second.end(),
+                         [&member](const member_t& requested_member) { return requested_member.name == member.name; }))
+            it->second.push_back(member);
+    };
+
+    if (modules.empty())
+    {
+        for (const module_t& module : modules_table)
+            if (!module.instance.empty())
+                for (const member_t& member : module.members)
+                    request(std::string(module.instance), member);
+    }
+
+    for (const std::string& str : modules)
+    {
+        // the dot after the device name, e.g disk(/mnt/my.disk).used
+        const size_t closebrak = str.find(')');
+        const size_t dot_pos   = str.find('.', closebrak == std::string::npos ? 0 : closebrak);
+
+        const std::string& name   = str.substr(0, dot_pos);
+        const module_t*    module = find_module(name);
+        if (!module)
+            die("Invalid module name: {}", name);
+
+        if (dot_pos == std::string::npos)
+        {
+            for (const member_t& member : module->members)
+                request(name, member);
+            continue;
+        }
+
+        const std::string& member_name = str.substr(dot_pos + 1);
+        const auto&        find_member = [module](const std::string_view wanted) {
+            return std::find_if(module->members.begin(), module->members.end(),
+                                [wanted](const member_t& member) { return member.name == wanted; });
+        };
+
+        if (const auto& it = find_member(member_name); it != module->members.end())
+        {
+            request(name, *it);
+            continue;
+        }
+
+        // not in the table, but a unit variant of an amount of bytes (e.g "used-GiB") is printed as it is
+        const size_t dash_pos = member_name.find('-');
+        const auto&  bytes    = find_member(member_name.substr(0, dash_pos));
+        if (dash_pos == member_name.npos || bytes == module->members.end() || bytes->type != VALUE_BYTES ||
+            !is_bytes_unit(member_name.substr(dash_pos + 1)))
+            die("Invalid member name: {}", str);
+
+        request(name, member_t{ member_name, VALUE_NUMBER });
+    }
+
+    Writer writer(config, colors);
+    writer.raw("{");
+    for (size_t i = 0; i < requested.size(); ++i)
+    {
+        const auto& [module, members] = requested.at(i);
+        writer.key(module, i == 0);
+        writer.raw("{");
+
+        for (size_t j = 0; j < members.size(); ++j)
+        {
+            // the raw amount of bytes, e.g used-B
+            const member_t&    member = members.at(j);
+            const std::string& query  = member.type == VALUE_BYTES ? fmt::format("{}-B", member.name)
+                                                                   : std::string(member.name);
+            addValueFromModule(module, query, parse_args);
+
+            writer.key(member.name, j == 0);
+            const auto& values = systemInfo.find(module);
+            if (values == systemInfo.end())
+            {
+                writer.raw("null");
+                continue;
+            }
+
+            if (const auto& it = values->second.find(query); it != values->second.end())
+                writer.value(it->second, member.type);
+            else
+                writer.raw("null");
+        }
+
+        writer.raw("}");
+    }
+    writer.raw("}\n");
+}
+
+}  // namespace JSON
@@ -1,11 +1,23 @@
 #include <getopt.h>
 
+#include <algorithm>
+#include <array>
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
 
+#include "bar.hpp"
+#include "batch.hpp"
 #include "config.hpp"
+#include "daemon.hpp"
 #include "display.hpp"
+#include "frame_cache.hpp"
 #include "gui.hpp"
+#include "json.hpp"
+#include "scheduler.hpp"
+#include "shared.hpp"
+#include "snapshot.hpp"
 #include "switch_fnv1a.hpp"
 #include "util.hpp"
 
@@ -29,15 +41,6 @@ static void version()
     fmt::print("GUI mode IS NOT enabled\n\n");
 #endif
 
-#if !(USE_DCONF)
-    fmt::println("NO flags were set");
-#else
-    fmt::println("set flags:");
-# if USE_DCONF
-    fmt::println("USE_DCONF");
-# endif
-#endif
-
     // if only everyone would not return error when querying the program version :(
     std::exit(EXIT_SUCCESS);
 }
@@ -83,10 +86,35 @@ A command-line system information tool (or neofetch like program), which its foc
     --logo-padding-left	<num>	Padding of the logo from the left
     --layout-padding-top <num>  Padding of the layout from the top
     --title-sep <string>        A char (or string) to use in $<builtin.title_sep>
+    --color-depth <string>      How many colors the terminal supports ("auto", "truecolor", "256" or "16")
     --sep-reset <string>        A separator (or string) that when ecountered, will automatically reset color
     --sep-reset-after [<num>]   Reset color either before of after 'sep-reset' (1 = after && 0 = before)
+    --progressive [<num>]       Print the output right away and rewrite the lines with slow tags when queried (only in a terminal)
     --gen-config [<path>]       Generate default config file to config folder (if path, it will generate to the path)
                                 Will ask for confirmation if file exists already
+    --format <name>             The output format: "default" for the logo and the layout, or "json" for printing
+                                the values of the modules as a JSON object (no logo and colors, bytes in bytes)
+    --modules <list>            The modules or module members to print with "--format json", separated by comma
+                                Example: --modules ram,cpu.name,disk(/) (default all of them)
+    --watch <num>               Keep the output updated every <num> milliseconds, from the top of the terminal
+                                (only the values that change over time, e.g uptime, RAM or disks, get queried again)
+    --bar <name>                Print the layout lines as the blocks of a status bar, without colors, every second
+                                (or every "--watch" milliseconds). <name> is the protocol: "i3bar" (also swaybar and
+                                i3blocks) or "waybar" (for a custom module with "return-type": "json")
+    --batch <path>              Render many configs in parallel, querying the system once, and write them to files.
+                                Each line of the manifest <path> is: <config file> <output file> [options...]
+                                ("-" for the default config file), e.g: /home/foo/.config/customfetch/config.toml /run/motd/foo -n
+    --dump-snapshot <path>      Write the values of all the modules (and the ones in the layout) to a snapshot file,
+                                for rendering them somewhere else with "--from-snapshot" ("-" for stdout)
+    --from-snapshot <path>      Render the layout with the values of a snapshot, without querying this system.
+                                If <path> is a directory, each "<name>.snapshot" in it is rendered in parallel to "<name>.txt"
+    --daemon                    Keep running with the config and the values already queried, for "--client"
+                                (the values that change get queried again every "daemon-refresh" milliseconds)
+    --client                    Get the output from the running daemon, as if it was rendered with these arguments
+                                (if there's no daemon, it renders by itself)
+    --verbose                   Print notes about how the output got rendered, e.g which modules timed out (see [deadline] in the config)
+    --explain-timing            Print how long each module took in the last runs, and which ones use their cached values
+                                for being slower than "slow-threshold" (see [deadline] in the config)
 
     --color <string>            Replace instances of a color with another value.
                                 Syntax MUST be "name=value" with no space beetween "=", example: --color "foo=#444333".
@@ -156,8 +184,8 @@ theme
   cursor_name	: cursor name [Bibata-Modern-Ice]
   cursor_size	: cursor size [16]
 
-# If USE_DCONF flag is set, then we're going to use
-# dconf, else backing up to gsettings
+# Values are read directly from the dconf database (~/.config/dconf/user and /etc/dconf/db/),
+# else backing up to gsettings
 theme-gsettings
   name          : gsettings theme name [Decay-Green]
   icons         : gsettings icons theme name [Papirus-Dark]
@@ -185,6 +213,17 @@ theme-gtk-all
   icons         : gtk icons theme name [Papirus-Dark [GTK2/3], Qogir [GTK4]]
   font          : gtk font theme name [Hack Nerd Font 13 [GTK2], Noto Sans 10 [GTK3/4]]
 
+# Values are read from ~/.config/kdeglobals and kcminputrc,
+# and from qt5ct/qt6ct configs (first if set as QT_QPA_PLATFORMTHEME)
+theme-qt
+  style         : Qt widget style [Breeze]
+  color_scheme  : Qt color scheme [BreezeDark]
+  icons         : Qt icons theme name [breeze-dark]
+  font          : Qt font name [Noto Sans 10]
+  cursor        : KDE cursor name with its size (auto add the size if queried) [breeze_cursors (24px)]
+  cursor_name   : KDE cursor name [breeze_cursors]
+  cursor_size   : KDE cursor size [24]
+
 # note: these members are auto displayed in from B to YB (depending if using SI byte unit or not(IEC)).
 # they all (except those that has the same name as the module or that ends with "_perc")
 # have variants from -B to -YB and -B to -YiB
@@ -197,6 +236,33 @@ ram
   total		: total amount of RAM (auto) [15.88 GiB]
   used_perc	: percentage of used amount of RAM in total [17.69%]
   free_perc	: percentage of available amount of RAM in total [82.31%]
+  cached	: amount of RAM used by the page cache (auto) [3.12 GiB]
+  buffers	: amount of RAM used by block device buffers (auto) [212.45 MiB]
+  shmem		: amount of shared memory, including tmpfs (auto) [624.10 MiB]
+  dirty		: amount of memory waiting to be written back to disk (auto) [1.20 MiB]
+  writeback	: amount of memory actively being written back to disk (auto) [0.00 B]
+  zswap		: compressed size of the zswap pool (auto) [120.52 MiB]
+  zswapped	: uncompressed size of the pages stored in zswap (auto) [402.18 MiB]
+  zswap_ratio	: zswap compression ratio [3.34]
+  hugetlb	: amount of memory used by huge pages of all sizes (auto) [0.00 B]
+  hugepage_size	: default huge page size (auto) [2.00 MiB]
+  hugepages_total: number of huge pages in the pool [0]
+  hugepages_free: number of huge pages not yet allocated [0]
+  pressure_some	: share of time some tasks were stalled on memory in the last 10s (PSI) [0.42%]
+  pressure_full	: share of time all tasks were stalled on memory in the last 10s (PSI) [0.00%]
+
+# compression stats of zram devices, from /sys/block/zram*/mm_stat.
+# same unit variants as RAM (e.g orig-MiB)
+# note: the module can have either a device name
+#	or nothing for all the devices together
+#	e.g zram(zram0) or zram
+zram(device)
+  zram		: original and compressed size of the stored data (auto) with compression ratio [1.60 GiB -> 412.33 MiB (3.97x)]
+  orig		: original size of the stored data (auto) [1.60 GiB]
+  compr		: compressed size of the stored data (auto) [412.33 MiB]
+  used		: memory used by the device, including metadata and fragmentation (auto) [430.10 MiB]
+  total		: size of the device (auto) [7.76 GiB]
+  ratio		: compression ratio [3.97]
 
 # same comments as RAM (above)
 swap
@@ -221,6 +287,30 @@ disk(/path/to/fs)
   fs            : type of filesystem [ext4]
   device	: path to device [/dev/sda5]
   mountdir	: path to the device mount point [/]
+  read_rate	: bytes read per second, sampled over "sampler-interval" ms [1.20 MiB/s]
+  write_rate	: bytes written per second, sampled over "sampler-interval" ms [356.00 KiB/s]
+
+# all the real filesystems (block devices and network filesystems, no tmpfs, proc, ...)
+# same unit variants as RAM (e.g used-GiB)
+# note: mounts that didn't answer in the "disk.timeout" config ms are shown as stale
+disks
+  disks		: used and total amount of disk space (auto) of each mount [/: 379.83 GiB / 438.08 GiB (86.70%) - ext4, /home: 1.20 TiB / 1.82 TiB (65.93%) - btrfs]
+  mountdirs	: path of each mount point [/, /home]
+  count		: number of mounted filesystems [2]
+  used          : used amount of disk space of all the mounts (auto) [1.57 TiB]
+  free          : available amount of disk space of all the mounts (auto) [679.18 GiB]
+  total         : total amount of disk space of all the mounts (auto) [2.25 TiB]
+  used_perc     : percentage of used amount of all the mounts in total [70.57%]
+  free_perc     : percentage of available amount of all the mounts in total [29.43%]
+
+# network throughput, sampled over the "sampler-interval" config ms.
+# the rates have the unit variants as RAM too, in bytes per second (e.g rx_rate-KiB)
+# note: the module can have either an interface name
+#	or nothing for all the interfaces (except loopback)
+#	e.g net(eth0) or net
+net(interface)
+  rx_rate	: bytes received per second [1.34 MiB/s]
+  tx_rate	: bytes transmitted per second [54.21 KiB/s]
 
 # usually people have 1 GPU in their PC,
 # but if you got more than 1 and want to query it,
@@ -233,12 +323,13 @@ gpu
 
 cpu
   cpu		: CPU model name with number of virtual proccessors and max freq [AMD Ryzen 5 5500 (12) @ 4.90 GHz]
-  name		: CPU model name [AMD Ryzen 5 5500]
+  name		: CPU model name [AMD Ryzen 5 5500, ARM Cortex-A72]
   nproc         : CPU number of virtual proccessors [12]
   freq_bios_limit: CPU freq (limited by bios, in GHz) [4.32]
   freq_cur	: CPU freq (current, in GHz) [3.42]
   freq_min	: CPU freq (mininum, in GHz) [2.45]
   freq_max	: CPU freq (maxinum, in GHz) [4.90]
+  usage		: CPU usage percentage, sampled over "sampler-interval" ms [12.34%]
 
 system
   host		: Host (aka. Motherboard) model name with vendor and version [Micro-Star International Co., Ltd. PRO B550M-P GEN3 (MS-7D95) 1.0]
@@ -310,13 +401,26 @@ static bool parseargs(int argc, char* argv[], Config& config, const std::string_
 
         {"sep-reset",          required_argument, 0, "sep-reset"_fnv1a16},
         {"title-sep",          required_argument, 0, "title-sep"_fnv1a16},
+        {"color-depth",        required_argument, 0, "color-depth"_fnv1a16},
         {"sep-reset-after",    optional_argument, 0, "sep-reset-after"_fnv1a16},
+        {"progressive",        optional_argument, 0, "progressive"_fnv1a16},
         {"logo-padding-top",   required_argument, 0, "logo-padding-top"_fnv1a16},
         {"logo-padding-left",  required_argument, 0, "logo-padding-left"_fnv1a16},
         {"layout-padding-top", required_argument, 0, "layout-padding-top"_fnv1a16},
         {"bg-image",           required_argument, 0, "bg-image"_fnv1a16},
         {"color",              required_argument, 0, "color"_fnv1a16},
         {"gen-config",         optional_argument, 0, "gen-config"_fnv1a16},
+        {"format",             required_argument, 0, "format"_fnv1a16},
+        {"modules",            required_argument, 0, "modules"_fnv1a16},
+        {"watch",              required_argument, 0, "watch"_fnv1a16},
+        {"bar",                required_argument, 0, "bar"_fnv1a16},
+        {"batch",              required_argument, 0, "batch"_fnv1a16},
+        {"dump-snapshot",      required_argument, 0, "dump-snapshot"_fnv1a16},
+        {"from-snapshot",      required_argument, 0, "from-snapshot"_fnv1a16},
+        {"daemon",             no_argument,       0, "daemon"_fnv1a16},
+        {"client",             no_argument,       0, "client"_fnv1a16},
+        {"verbose",            no_argument,       0, "verbose"_fnv1a16},
+        {"explain-timing",     no_argument,       0, "explain-timing"_fnv1a16},
         
         {0,0,0,0}
     };
@@ -397,6 +501,19 @@ static bool parseargs(int argc, char* argv[], Config& config, const std::string_
             case "title-sep"_fnv1a16:
                 config.builtin_title_sep = optarg; break;
 
+            case "color-depth"_fnv1a16:
+                config.color_depth = optarg; break;
+
+            case "format"_fnv1a16:
+                if (strcmp(optarg, "default") != 0 && strcmp(optarg, "json") != 0)
+                    die("Unknown output format '{}', must be \"default\" or \"json\"", optarg);
+                config.m_format = optarg;
+                break;
+
+            case "modules"_fnv1a16:
+                config.m_modules = split(optarg, ',');
+                break;
+
             case "sep-reset-after"_fnv1a16:
                 if (OPTIONAL_ARGUMENT_IS_PRESENT)
                     config.sep_reset_after = std::stoi(optarg);
@@ -404,6 +521,51 @@ static bool parseargs(int argc, char* argv[], Config& config, const std::string_
                     config.sep_reset_after = true;
                 break;
 
+            case "progressive"_fnv1a16:
+                if (OPTIONAL_ARGUMENT_IS_PRESENT)
+                    config.progressive = std::stoi(optarg);
+                else
+                    config.progressive = true;
+                break;
+
+            case "watch"_fnv1a16:
+                config.m_watch_interval = std::stoul(optarg);
+                if (config.m_watch_interval == 0)
+                    die("--watch needs an interval of at least 1 millisecond");
+                break;
+
+            case "bar"_fnv1a16:
+                config.m_bar = str_tolower(optarg);
+                if (config.m_bar != "i3bar" && config.m_bar != "waybar")
+                    die("Invalid bar protocol '{}', only \"i3bar\" and \"waybar\"", optarg);
+                break;
+
+            case "batch"_fnv1a16:
+                config.m_batch = optarg;
+                break;
+
+            case "dump-snapshot"_fnv1a16:
+                config.m_dump_snapshot = optarg;
+                break;
+
+            case "from-snapshot"_fnv1a16:
+                if (!std::filesystem::exists(optarg))
+                    die("snapshot '{}' doesn't exist", optarg);
+                config.m_from_snapshot = optarg;
+                break;
+
+            case "daemon"_fnv1a16:
+                config.m_daemon = true; break;
+
+            case "client"_fnv1a16: // we have already did it in main()
+                break;
+
+            case "verbose"_fnv1a16:
+                config.m_verbose = true; break;
+
+            case "explain-timing"_fnv1a16:
+                config.m_explain_timing = true; break;
+
             default:
                 return false;
         }
@@ -412,6 +574,96 @@ static bool parseargs(int argc, char* argv[], Config& config, const std::string_
     return true;
 }
 
+// the runs with the same config file (and its version on disk) and the same arguments share their values
+static std::uint64_t get_shared_key(int argc, char* argv[], const std::string& configFile)
+{
+    std::error_code ec;
+    std::string     key = fmt::format("{}\n{}\n", VERSION, configFile);
+    if (std::filesystem::exists(configFile, ec))
+        key += fmt::format("{}\n{}\n", std::filesystem::last_write_time(configFile, ec).time_since_epoch().count(),
+                           std::filesystem::file_size(configFile, ec));
+
+    for (int i = 1; i < argc; ++i)
+    {
+        key += argv[i];
+        key += '\n';
+    }
+
+    return fnv1a64::hash(key);
+}
+
+// render and display as the config says, from_daemon if it's for a `cufetch --client`
+static int run(Config& config, const colors_t& colors, const bool from_daemon)
+{
+    // it runs until the bar gets closed
+    if (!config.m_bar.empty())
+    {
+        if (from_daemon)
+            return Daemon::FALLBACK;
+
+        Bar::run(config, colors);
+        return 0;
+    }
+
+    // they're files, not the client terminal
+    if (!config.m_dump_snapshot.empty() || !config.m_from_snapshot.empty())
+    {
+        if (from_daemon)
+            return Daemon::FALLBACK;
+
+        if (config.m_dump_snapshot.empty())
+            return Snapshot::render(config, colors);
+
+        Snapshot::dump(config, colors, config.m_dump_snapshot);
+        return 0;
+    }
+
+    // nothing gets rendered
+    if (config.m_explain_timing)
+    {
+        if (from_daemon)
+            return Daemon::FALLBACK;
+
+        Scheduler::explain(config);
+        return 0;
+    }
+
+    // no logo nor colors, just the values
+    if (config.m_format == "json")
+    {
+        JSON::print(config, colors, config.m_modules);
+        return 0;
+    }
+
+    const std::string& path = Display::get_source_path(config);
+
+    // they need the client terminal or display
+    if (from_daemon && (config.gui || config.m_watch_interval > 0 || (!config.m_disable_source && is_file_image(path))))
+        return Daemon::FALLBACK;
+
+#ifdef GUI_MODE
+    if (config.gui)
+    {
+        const Glib::RefPtr<Gtk::Application>& app = Gtk::Application::create("org.toni.customfetch");
+        GUI::Window window(config, colors, path);
+        return app->run(window);
+    }
+#else
+    if (config.gui)
+        die("Can't run in GUI mode because it got disabled at compile time\n"
+            "Compile customfetch with GUI_MODE=1 or contact your distro to enable it");
+#endif
+
+    if (config.m_watch_interval > 0)
+        Display::watch(config, colors, path);
+    else if (config.progressive)
+        Display::display_progressive(config, colors, path);
+    else if (!FrameCache::display(config, colors, path))
+        Display::display(Display::render(config, colors, false, path, Shared::get(config, colors)));
+
+    return 0;
+}
+
 int main(int argc, char *argv[])
 {
 
@@ -435,6 +687,12 @@ int main(int argc, char *argv[])
 #endif
 
     // clang-format on
+    // the daemon has the config and the values already, before even reading the config
+    if (std::find_if(argv + 1, argv + argc, [](const char* arg) { return std::strcmp(arg, "--client") == 0; }) !=
+            argv + argc &&
+        Daemon::client(argc, argv))
+        return 0;
+
     colors_t colors;
 
     const std::string& configDir  = getConfigDir();
@@ -445,46 +703,39 @@ int main(int argc, char *argv[])
     if (!parseargs(argc, argv, config, configFile))
         return 1;
 
-    if (config.source_path.empty() || config.source_path == "off")
-        config.m_disable_source = true;
-
-    config.m_display_distro = (config.source_path == "os");
-
-    std::string path = config.m_display_distro ? Display::detect_distro(config) : config.source_path;
+    config.m_shared_key = get_shared_key(argc, argv, configFile);
 
-    if (!config.ascii_logo_type.empty() && config.m_display_distro)
+    if (!config.m_batch.empty())
     {
-        const size_t& pos = path.rfind('.');
-        
-        if (pos != std::string::npos)
-            path.insert(pos, "_" + config.ascii_logo_type);
-        else
-            path += "_" + config.ascii_logo_type;
+        return Scheduler::leave(Batch::run(config.m_batch, configDir,
+                          [](int job_argc, char* job_argv[], Config& job_config, const std::string& job_configFile) {
+                              optind = 0;
+                              return parseargs(job_argc, job_argv, job_config, job_configFile);
+                          }));
     }
 
-    if (!std::filesystem::exists(path) &&
-        !std::filesystem::exists((path = config.data_dir + "/ascii/linux.txt")))
+    if (config.m_daemon)
     {
-        if (!config.m_disable_source)
-            die("'{}' doesn't exist. Can't load image/text file", path);
+        // each client is rendered with the config file and its own arguments, not with the daemon ones
+        Config file_config(configFile, configDir, colors);
+        Daemon::serve(config, colors, configFile, argv, [&](int client_argc, char* client_argv[]) {
+            // the daemon renders only with its own config
+            optind = 0;
+            if (parse_config_path(client_argc, client_argv, configDir) != configFile)
+                return Daemon::FALLBACK;
+
+            // it's a fork() child of the daemon, the arguments of the other clients aren't in file_config
+            if (!parseargs(client_argc, client_argv, file_config, configFile))
+                return 1;
+
+            // its values are in memory already
+            file_config.m_shared_key = 0;
+
+            // the frame is sent all at once and the client isn't our terminal
+            file_config.progressive = false;
+            return run(file_config, colors, true);
+        });
     }
 
-    debug("{} path = {}", __PRETTY_FUNCTION__, path);
-
-#ifdef GUI_MODE
-    if (config.gui)
-    {
-        const Glib::RefPtr<Gtk::Application>& app = Gtk::Application::create("org.toni.customfetch");
-        GUI::Window window(config, colors, path);
-        return app->run(window);
-    }
-#else
-    if (config.gui)
-        die("Can't run in GUI mode because it got disabled at compile time\n"
-            "Compile customfetch with GUI_MODE=1 or contact your distro to enable it");
-#endif
-
-    Display::display(Display::render(config, colors, false, path));
-
-    return 0;
+    return Scheduler::leave(run(config, colors, false));
 }
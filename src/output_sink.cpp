@@ -0,0 +1,518 @@
+/* Implementation of the sinks where the parsed layout and ascii art get written to */
+
+#include "output_sink.hpp"
+
+#include <algorithm>
+#include <array>
+#include <sstream>
+
+#include "display_width.hpp"
+#include "fmt/format.h"
+#include "switch_fnv1a.hpp"
+#include "term_colors.hpp"
+#include "util.hpp"
+
+std::string make_event(const event_kind_t kind, const std::string_view payload)
+{
+    std::string ret;
+    ret.reserve(payload.length() + 3);
+    ret += EVENT_START;
+    ret += kind;
+    ret += payload;
+    ret += EVENT_END;
+    return ret;
+}
+
+void write_events(const std::string_view str, OutputSink& sink)
+{
+    for (size_t i = 0; i < str.length();)
+    {
+        const size_t start = str.find(EVENT_START, i);
+        if (start != i)
+        {
+            sink.text(str.substr(i, start - i));
+            if (start == std::string_view::npos)
+                break;
+        }
+
+        const size_t end = str.find(EVENT_END, start);
+        if (end == std::string_view::npos || end == start + 1)
+        {
+            // not an event, just a stray control character
+            sink.text(str.substr(start, 1));
+            i = start + 1;
+            continue;
+        }
+
+        const std::string_view payload = str.substr(start + 2, end - start - 2);
+        switch (str.at(start + 1))
+        {
+            case EVENT_STYLE:       sink.push_style(payload); break;
+            case EVENT_RESET:       sink.reset(false); break;
+            case EVENT_RESET_BOLD:  sink.reset(true); break;
+            case EVENT_RAW:         sink.raw(payload); break;
+            case EVENT_SCOPE_OPEN:  sink.open_scope(); break;
+            case EVENT_SCOPE_CLOSE: sink.close_scope(); break;
+        }
+
+        i = end + 1;
+    }
+}
+
+std::unique_ptr<OutputSink> make_output_sink(const Config& config, const colors_t& colors)
+{
+    if (config.gui)
+        return std::make_unique<PangoSink>(config, colors);
+
+    if (config.m_disable_colors)
+        return std::make_unique<PlainSink>(config, colors);
+
+    return std::make_unique<AnsiSink>(config, colors);
+}
+
+//
+//
+// OutputSink
+//
+OutputSink::OutputSink(const Config& config, const colors_t& colors) : m_config(config), m_colors(colors) {}
+
+void OutputSink::text(const std::string_view str)
+{
+    m_width += display_width(str);
+    on_text(str);
+}
+
+void OutputSink::raw(const std::string_view str)
+{ on_raw(str); }
+
+void OutputSink::push_style(const std::string_view spec)
+{
+    m_styles.push_back({ std::string(spec), false });
+    on_push(m_styles.back());
+}
+
+void OutputSink::reset(const bool bold)
+{
+    const size_t n = m_styles.size();
+    m_styles.clear();
+
+    // ${0} resets everything, even the styles of the outer scopes
+    std::fill(m_scopes.begin(), m_scopes.end(), 0);
+    on_reset(n);
+
+    if (bold)
+    {
+        m_styles.push_back({ "", true });
+        on_push(m_styles.back());
+    }
+}
+
+void OutputSink::open_scope()
+{ m_scopes.push_back(m_styles.size()); }
+
+void OutputSink::close_scope()
+{
+    if (m_scopes.empty())
+        return;
+
+    const size_t base = m_scopes.back();
+    m_scopes.pop_back();
+    if (m_styles.size() <= base)
+        return;
+
+    const size_t n = m_styles.size() - base;
+    m_styles.resize(base);
+    on_pop(n);
+}
+
+//
+//
+// AnsiSink
+//
+// returns the color tag with the named colors replaced by their value
+static std::string get_color_value(const std::string& spec, const colors_t& colors, const bool gui)
+{
+    switch (fnv1a16::hash(spec))
+    {
+        case "black"_fnv1a16:   return gui ? colors.gui_black   : colors.black;
+        case "red"_fnv1a16:     return gui ? colors.gui_red     : colors.red;
+        case "blue"_fnv1a16:    return gui ? colors.gui_blue    : colors.blue;
+        case "green"_fnv1a16:   return gui ? colors.gui_green   : colors.green;
+        case "cyan"_fnv1a16:    return gui ? colors.gui_cyan    : colors.cyan;
+        case "yellow"_fnv1a16:  return gui ? colors.gui_yellow  : colors.yellow;
+        case "magenta"_fnv1a16: return gui ? colors.gui_magenta : colors.magenta;
+        case "white"_fnv1a16:   return gui ? colors.gui_white   : colors.white;
+    }
+
+    return spec;
+}
+
+std::string AnsiSink::get_sgr(const style_t& style) const
+{
+    if (style.bold)
+        return "\033[1m";
+
+    const std::string& str_clr = get_color_value(style.spec, m_colors, false);
+
+    const size_t pos = str_clr.find('#');
+    if (pos != std::string::npos)
+    {
+        const std::string& opt_clr = str_clr.substr(0, pos);
+
+        std::string         emphasis;
+        std::string         color_sgr;
+        const color_depth_t color_depth = get_color_depth(m_config.color_depth);
+
+        const auto& skip_gui_argmode = [&opt_clr](const size_t index) -> size_t
+        {
+            if (opt_clr.at(index + 1) == '(')
+            {
+                const size_t closebrak = opt_clr.find(')', index);
+                if (closebrak == std::string::npos)
+                    return 0;
+
+                return closebrak;
+            }
+            return 0;
+        };
+
+        bool bgcolor = false;
+        for (size_t i = 0; i < opt_clr.length(); ++i)
+        {
+            switch (opt_clr.at(i))
+            {
+                case 'b':
+                    bgcolor   = true;
+                    color_sgr = get_color_sgr(hexStringToColor(str_clr.substr(pos)), true, color_depth);
+                    break;
+                case '!':
+                    emphasis += ";1"; break;
+                case 'i':
+                    emphasis += ";3"; break;
+                case 'u':
+                    emphasis += ";4"; break;
+                case 'l':
+                    emphasis += ";5"; break;
+                case 's':
+                    emphasis += ";9"; break;
+
+                case 'U':
+                case 'B':
+                case 'S':
+                case 'a':
+                case 'w':
+                case 'O':
+                case 'A':
+                case 'L':
+                    i += skip_gui_argmode(i); break;
+            }
+        }
+
+        if (!bgcolor)
+            color_sgr = get_color_sgr(hexStringToColor(str_clr.substr(pos)), false, color_depth);
+
+        if (emphasis.empty())
+            return color_sgr;
+
+        // not done with fmt::format(fmt::text_style, ...) because it resets at the end of the text
+        return color_sgr + "\033[" + emphasis.substr(1) + 'm';
+    }
+
+    // "\\e" is for checking in the ascii_art, \033 in the config
+    if (hasStart(str_clr, "\\e") || hasStart(str_clr, "\033"))
+        return fmt::format("\x1B[{}", hasStart(str_clr, "\033") ? str_clr.substr(2) : str_clr.substr(3));
+
+    error("PARSER: failed to parse line with color '{}'", str_clr);
+    return "";
+}
+
+void AnsiSink::on_text(const std::string_view str)
+{ m_output += str; }
+
+void AnsiSink::on_raw(const std::string_view str)
+{ m_output += str; }
+
+void AnsiSink::on_push(const style_t& style)
+{ m_output += get_sgr(style); }
+
+// a terminal can't pop a style, so reset and set again the ones that are left
+void AnsiSink::on_pop(const size_t)
+{
+    m_output += NOCOLOR;
+    for (const style_t& style : m_styles)
+        m_output += get_sgr(style);
+}
+
+// always reset, the output of $() can have colors too
+void AnsiSink::on_reset(const size_t)
+{ m_output += NOCOLOR; }
+
+//
+//
+// PangoSink
+//
+static std::array<std::string, 3> get_ansi_color(const std::string_view str, const colors_t& colors)
+{
+    const size_t first_m = str.rfind('m');
+    if (first_m == std::string::npos)
+        die("Parser: failed to parse layout/ascii art: missing m while using ANSI color escape code");
+
+    std::string col = str.data();
+    col.erase(first_m);  // 1;42
+    std::string weight = hasStart(col, "1;") ? "bold" : "normal";
+    std::string type   = "fgcolor";  // either fgcolor or bgcolor
+
+    if (hasStart(col, "1;") || hasStart(col, "0;"))
+        col.erase(0, 2);
+
+    debug("col = {}", col);
+    const int n = std::stoi(col);
+
+    // unfortunatly you can't do bold and light in pango
+    if ((n >= 100 && n <= 107) || (n >= 90 && n <= 97))
+        weight = "light";
+
+    if ((n >= 100 && n <= 107) || (n >= 40 && n <= 47))
+        type = "bgcolor";
+
+    // last number
+    // https://stackoverflow.com/a/5030086
+    // clang-format off
+    switch (col.back())
+    {
+        case '0': col = colors.gui_black;   break;
+        case '1': col = colors.gui_red;     break;
+        case '2': col = colors.gui_green;   break;
+        case '3': col = colors.gui_yellow;  break;
+        case '4': col = colors.gui_blue;    break;
+        case '5': col = colors.gui_magenta; break;
+        case '6': col = colors.gui_cyan;    break;
+        case '7': col = colors.gui_white;   break;
+    }
+
+    if (col.at(0) != '#')
+        col.erase(0, col.find('#'));
+
+    return { col, weight, type };
+    // clang-format on
+}
+
+static std::string convert_ansi_escape_rgb(const std::string_view noesc_str)
+{
+    if (std::count(noesc_str.begin(), noesc_str.end(), ';') < 4)
+        die("ANSI escape code color '\\e[{}' should have an rgb type value\n"
+            "e.g \\e[38;2;255;255;255m", noesc_str);
+    if (noesc_str.rfind('m') == std::string::npos)
+        die("Parser: failed to parse layout/ascii art: missing m while using ANSI color escape code");
+
+    const std::vector<std::string>& rgb_str = split(noesc_str.substr(5), ';');
+
+    const uint r = std::stoul(rgb_str.at(0));
+    const uint g = std::stoul(rgb_str.at(1));
+    const uint b = std::stoul(rgb_str.at(2));
+
+    const uint result = (r<<16) | (g<<8)| (b);
+    std::stringstream ss;
+    ss << std::hex << result;
+    return ss.str();
+}
+
+// the attributes of the <span> of a color tag
+static std::string get_span_attributes(const std::string& str_clr, const colors_t& colors)
+{
+    const size_t pos = str_clr.find('#');
+    if (pos != std::string::npos)
+    {
+        std::string        tagfmt;
+        const std::string& opt_clr = str_clr.substr(0, pos);
+
+        size_t argmode_pos = 0;
+        const auto& append_argmode = [&](const std::string_view fmt, const std::string_view error) -> size_t
+        {
+            if (opt_clr.at(argmode_pos + 1) == '(')
+            {
+                const size_t closebrak = opt_clr.find(')', argmode_pos);
+                if (closebrak == std::string::npos)
+                    die("{} mode in color {} doesn't have close bracket", error, str_clr);
+
+                const std::string& value = opt_clr.substr(argmode_pos + 2, closebrak - argmode_pos - 2);
+                tagfmt += fmt.data() + value + "' ";
+
+                return closebrak;
+            }
+            return 0;
+        };
+
+        bool bgcolor = false;
+        for (size_t i = 0; i < opt_clr.length(); ++i)
+        {
+            switch (opt_clr.at(i))
+            {
+                case 'b':
+                    bgcolor = true;
+                    tagfmt += "bgcolor='" + str_clr.substr(pos) + "' ";
+                    break;
+                case '!':
+                    tagfmt += "weight='bold' "; break;
+                case 'u':
+                    tagfmt += "underline='single' "; break;
+                case 'i':
+                    tagfmt += "style='italic' "; break;
+                case 'o':
+                    tagfmt += "overline='single' "; break;
+                case 's':
+                    tagfmt += "strikethrough='true' "; break;
+
+                case 'a':
+                    argmode_pos = i;
+                    i += append_argmode("fgalpha='", "fgalpha");
+                    break;
+
+                case 'A':
+                    argmode_pos = i;
+                    i += append_argmode("bgalpha='", "bgalpha");
+                    break;
+
+                case 'L':
+                    argmode_pos = i;
+                    i += append_argmode("underline='", "underline option");
+                    break;
+
+                case 'U':
+                    argmode_pos = i;
+                    i += append_argmode("underline_color='#", "colored underline");
+                    break;
+
+                case 'B':
+                    argmode_pos = i;
+                    i += append_argmode("bgcolor='#", "bgcolor");
+                    break;
+
+                case 'w':
+                    argmode_pos = i;
+                    i += append_argmode("weight='", "font weight style");
+                    break;
+
+                case 'O':
+                    argmode_pos = i;
+                    i += append_argmode("overline_color='#", "overline color");
+                    break;
+
+                case 'S':
+                    argmode_pos = i;
+                    i += append_argmode("strikethrough_color='#", "color of strikethrough line");
+                    break;
+            }
+        }
+
+        if (!bgcolor)
+            tagfmt += "fgcolor='" + str_clr.substr(pos) + "' ";
+
+        tagfmt.pop_back();
+        return tagfmt;
+    }
+
+    // "\\e" is for checking in the ascii_art, \033 in the config
+    if (hasStart(str_clr, "\\e") || hasStart(str_clr, "\033"))
+    {
+        const std::string& noesc_str = hasStart(str_clr, "\033") ? str_clr.substr(2) : str_clr.substr(3);
+        debug("noesc_str = {}", noesc_str);
+
+        if (hasStart(noesc_str, "38;2;") || hasStart(noesc_str, "48;2;"))
+            return fmt::format("{}gcolor='#{}'", hasStart(noesc_str, "38") ? 'f' : 'b', convert_ansi_escape_rgb(noesc_str));
+
+        const std::array<std::string, 3>& clrs = get_ansi_color(noesc_str, colors);
+        return fmt::format("{}='{}' weight='{}'", clrs.at(2), clrs.at(0), clrs.at(1));
+    }
+
+    error("PARSER: failed to parse line with color '{}'", str_clr);
+    return "";
+}
+
+// https://docs.gtk.org/Pango/pango_markup.html
+void PangoSink::on_text(const std::string_view str)
+{
+    for (const char c : str)
+    {
+        switch (c)
+        {
+            case '<': m_output += "&lt;"; break;
+            case '>': m_output += "&gt;"; break;
+            case '&': m_output += "&amp;"; break;
+            default:  m_output += c;
+        }
+    }
+}
+
+void PangoSink::on_raw(const std::string_view str)
+{ m_output += str; }
+
+void PangoSink::on_push(const style_t& style)
+{
+    if (style.bold)
+    {
+        m_output += "<span weight='bold'>";
+        return;
+    }
+
+    const std::string& attributes = get_span_attributes(get_color_value(style.spec, m_colors, true), m_colors);
+    m_output += attributes.empty() ? "<span>" : "<span " + attributes + ">";
+}
+
+void PangoSink::on_pop(const size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        m_output += "</span>";
+}
+
+void PangoSink::on_reset(const size_t n)
+{ on_pop(n); }
+
+//
+//
+// PlainSink
+//
+void PlainSink::on_text(const std::string_view str)
+{ m_output += str; }
+
+void PlainSink::on_raw(const std::string_view str)
+{ m_output += str; }
+
+//
+//
+// StructuredSink
+//
+void StructuredSink::on_text(const std::string_view str)
+{
+    std::vector<std::string> styles;
+    for (const style_t& style : m_styles)
+        styles.push_back(style.bold ? "bold" : get_color_value(style.spec, m_colors, false));
+
+    if (!m_segments.empty() && m_segments.back().styles == styles)
+        m_segments.back().text += str;
+    else
+        m_segments.push_back({ std::string(str), std::move(styles) });
+}
+
+std::string StructuredSink::str() const
+{
+    std::string ret = "[";
+    for (const segment_t& segment : m_segments)
+    {
+        if (ret.length() > 1)
+            ret += ',';
+
+        ret += "{\"text\":\"";
+        json_escape(ret, segment.text);
+        ret += "\",\"styles\":[";
+        for (size_t i = 0; i < segment.styles.size(); ++i)
+        {
+            ret += i > 0 ? ",\"" : "\"";
+            json_escape(ret, segment.styles.at(i));
+            ret += '"';
+        }
+        ret += "]}";
+    }
+
+    return ret + ']';
+}
@@ -7,122 +7,61 @@
 #include <chrono>
 #include <cstdint>
 #include <cstdlib>
-#include <sstream>
 #include <string>
 #include <vector>
 
 #include "config.hpp"
+#include "display_width.hpp"
 #include "fmt/color.h"
+#include "output_sink.hpp"
 #include "query.hpp"
+#include "scheduler.hpp"
 #include "switch_fnv1a.hpp"
 #include "util.hpp"
 
 // declarations of static members in query.hpp
 Query::System::System_t Query::System::m_system_infos;
-Query::Theme::Theme_t   Query::Theme::m_theme_infos;
+std::unordered_map<std::string, Query::Theme::Theme_t> Query::Theme::m_themes;
+std::string                                            Query::Theme::m_wmde_name;
+Query::ThemeQt::ThemeQt_t Query::ThemeQt::m_qt_infos;
 Query::User::User_t     Query::User::m_users_infos;
 Query::CPU::CPU_t       Query::CPU::m_cpu_infos;
 Query::RAM::RAM_t       Query::RAM::m_memory_infos;
+std::unordered_map<std::string, Query::RAM::zram_t> Query::RAM::m_zram_infos;
 Query::GPU::GPU_t       Query::GPU::m_gpu_infos;
-Query::Disk::Disk_t     Query::Disk::m_disk_infos;
+std::unordered_map<std::string, Query::Disk::Disk_t> Query::Disk::m_disks_infos;
+std::vector<Query::Disk::Disk_t*> Query::Disk::m_all_disks;
+Query::Sampler::Sample_t Query::Sampler::m_first;
+Query::Sampler::Sample_t Query::Sampler::m_second;
+std::chrono::milliseconds Query::Sampler::m_interval;
 
-struct statvfs Query::Disk::m_statvfs;
 struct utsname Query::System::m_uname_infos;
 struct sysinfo Query::System::m_sysInfos;
 struct passwd* Query::User::m_pPwd;
 
 bool Query::System::m_bInit          = false;
+bool Query::System::m_bSysInfoInit   = false;
 bool Query::RAM::m_bInit             = false;
 bool Query::CPU::m_bInit             = false;
 bool Query::User::m_bInit            = false;
+bool Query::ThemeQt::m_bInit         = false;
 bool Query::User::m_bDont_query_dewm = false;
+pid_t Query::User::m_parent_pid      = 0;
+bool Query::RAM::m_bPressureInit     = false;
+bool Query::Sampler::m_bInit         = false;
+bool Query::Sampler::m_bStarted      = false;
+bool Query::Disk::m_bAllInit         = false;
 
-// useless useful tmp string for parse() without using the original
-// pureOutput
-std::string _;
+// the colors of the ascii art, for ${auto}. Per thread for the renders in parallel (e.g --batch)
+static thread_local std::vector<std::string> auto_colors;
 
-static std::array<std::string, 3> get_ansi_color(const std::string_view str, const colors_t& colors)
-{
-    const size_t first_m = str.rfind('m');
-    if (first_m == std::string::npos)
-        die("Parser: failed to parse layout/ascii art: missing m while using ANSI color escape code");
-
-    std::string col = str.data();
-    col.erase(first_m);  // 1;42
-    std::string weight = hasStart(col, "1;") ? "bold" : "normal";
-    std::string type   = "fgcolor";  // either fgcolor or bgcolor
-
-    if (hasStart(col, "1;") || hasStart(col, "0;"))
-        col.erase(0, 2);
+// parse() for parse_args_t& arguments.
+// The colors are kept as events (check output_sink.hpp) and,
+// if the string has any, it's put in its own scope so the styles it sets don't leak outside of it
+static std::string parse(const std::string_view input, parse_args_t& parse_args);
 
-    debug("col = {}", col);
-    const int n = std::stoi(col);
-
-    // unfortunatly you can't do bold and light in pango
-    if ((n >= 100 && n <= 107) || (n >= 90 && n <= 97))
-        weight = "light";
-
-    if ((n >= 100 && n <= 107) || (n >= 40 && n <= 47))
-        type = "bgcolor";
-
-    // last number
-    // https://stackoverflow.com/a/5030086
-    // clang-format off
-    switch (col.back())
-    {
-        case '0': col = colors.gui_black;   break;
-        case '1': col = colors.gui_red;     break;
-        case '2': col = colors.gui_green;   break;
-        case '3': col = colors.gui_yellow;  break;
-        case '4': col = colors.gui_blue;    break;
-        case '5': col = colors.gui_magenta; break;
-        case '6': col = colors.gui_cyan;    break;
-        case '7': col = colors.gui_white;   break;
-    }
-
-    if (col.at(0) != '#')
-        col.erase(0, col.find('#'));
-
-    return { col, weight, type };
-    // clang-format on
-}
-
-static std::string convert_ansi_escape_rgb(const std::string_view noesc_str)
-{
-    if (std::count(noesc_str.begin(), noesc_str.end(), ';') < 4)
-        die("ANSI escape code color '\\e[{}' should have an rgb type value\n"
-            "e.g \\e[38;2;255;255;255m", noesc_str);
-    if (noesc_str.rfind('m') == std::string::npos)
-        die("Parser: failed to parse layout/ascii art: missing m while using ANSI color escape code");
-
-    const std::vector<std::string>& rgb_str = split(noesc_str.substr(5), ';');
-
-    const uint r = std::stoul(rgb_str.at(0));
-    const uint g = std::stoul(rgb_str.at(1));
-    const uint b = std::stoul(rgb_str.at(2));
-
-    const uint result = (r<<16) | (g<<8)| (b);
-    std::stringstream ss;
-    ss << std::hex << result;
-    return ss.str();
-}
-
-#if 0
-static std::string convert_hex_ansi_escape(const std::string_view hexstr, const bool bg = false)
-{
-    fmt::rgb rgb(hexStringToColor(hexstr));
-    fmt::detail::ansi_color_escape<char> ansi(rgb, bg ? "\x1b[48;2;" : "\x1b[38;2;");
-    return ansi.begin();
-}
-#endif
-
-// parse() for parse_args_t& arguments
-// some times we don't want to use the original pureOutput,
-// so we have to create a tmp string just for the sake of the function arguments
-static std::string parse(const std::string_view input, std::string& _, parse_args_t& parse_args)
-{
-    return parse(input, parse_args.systemInfo, _, parse_args.config, parse_args.colors, parse_args.parsingLayout);
-}
+// same as above but without the scope, for the tags inside another tag
+static std::string parse_tags(const std::string_view input, parse_args_t& parse_args);
 
 static char gettype(const char opentag)
 {
@@ -164,7 +103,7 @@ static std::string get_and_color_percentage(const float& n1, const float& n2, pa
             color = "${" + config.percentage_colors.at(0) + "}";
     }
 
-    return parse(fmt::format("{}{:.2f}%${{0}}", color, result), _, parse_args);
+    return parse(fmt::format("{}{:.2f}%${{0}}", color, result), parse_args);
 }
 
 std::string getInfoFromName(const systemInfo_t& systemInfo, const std::string_view moduleName,
@@ -190,56 +129,31 @@ std::string getInfoFromName(const systemInfo_t& systemInfo, const std::string_vi
     return "(unknown/invalid module)";
 }
 
-std::string parse(const std::string_view input, systemInfo_t& systemInfo, std::string& pureOutput, const Config& config,
-                  const colors_t& colors, const bool parsingLayout)
+static std::string parse_tags(const std::string_view input, parse_args_t& parse_args)
 {
+    const Config& config        = parse_args.config;
+    systemInfo_t& systemInfo    = parse_args.systemInfo;
+    const bool    parsingLayout = parse_args.parsingLayout;
+
     std::string output{input.data()};
-    pureOutput         = output;
 
     size_t dollarSignIndex    = 0;
     size_t oldDollarSignIndex = 0;
     bool   start              = false;
     bool   skip_bypass        = false;
 
-    // we only use it in GUI mode,
-    // prevent issue where in the ascii art,
-    // theres at first either ${1} or ${0}
-    // and that's a problem with pango markup
-    bool firstrun_noclr = true;
-
-    static std::vector<std::string> auto_colors;
-    parse_args_t parse_args(systemInfo, pureOutput, config, colors, parsingLayout);
-
     if (!config.sep_reset.empty() && parsingLayout)
     {
         if (config.sep_reset_after)
-        {
-            replace_str(output,     config.sep_reset, config.sep_reset + "${0}");
-            replace_str(pureOutput, config.sep_reset, config.sep_reset + "${0}");
-        }
+            replace_str(output, config.sep_reset, config.sep_reset + "${0}");
         else
-        {
-            replace_str(output,     config.sep_reset, "${0}" + config.sep_reset);
-            replace_str(pureOutput, config.sep_reset, "${0}" + config.sep_reset);
-        }
-    }
-
-    // escape pango markup
-    // https://gitlab.gnome.org/GNOME/glib/-/blob/main/glib/gmarkup.c#L2150
-    // workaround: just put "\<" or "\&" in the config, e.g "$<os.kernel> \<- Kernel"
-    if (config.gui)
-    {
-        replace_str(output, "\\<", "&lt;");
-        replace_str(output, "\\&", "&amp;");
-    }
-    else
-    {
-        replace_str(output, "\\<", "<");
-        replace_str(output, "\\&", "&");
+            replace_str(output, config.sep_reset, "${0}" + config.sep_reset);
     }
 
-    replace_str(pureOutput, "\\<", "<");
-    replace_str(pureOutput, "\\&", "&");
+    // workaround for pango markup: just put "\<" or "\&" in the config, e.g "$<os.kernel> \<- Kernel"
+    // the sinks escape the text themself
+    replace_str(output, "\\<", "<");
+    replace_str(output, "\\&", "&");
 
     while (true)
     {
@@ -250,7 +164,7 @@ std::string parse(const std::string_view input, systemInfo_t& systemInfo, std::s
         if (dollarSignIndex == std::string::npos || dollarSignIndex >= output.length()-1)
             break;
         //                                                      small workaround cuz idk how to fix this
-        else if (dollarSignIndex <= oldDollarSignIndex && start && !config.m_disable_colors)
+        else if (dollarSignIndex <= oldDollarSignIndex && start)
         {
             dollarSignIndex = output.find('$', dollarSignIndex + 1);
             // oh nooo.. whatever
@@ -281,10 +195,6 @@ std::string parse(const std::string_view input, systemInfo_t& systemInfo, std::s
             skip_bypass = true;
             output.erase(dollarSignIndex - 1, 1);
 
-            const size_t pos = pureOutput.find("\\\\$");
-            if (pos != pureOutput.npos)
-                pureOutput.erase(pos, 1);
-
             dollarSignIndex--;
         }
 
@@ -346,7 +256,7 @@ std::string parse(const std::string_view input, systemInfo_t& systemInfo, std::s
                     endBracketIndex = pos;
                     const size_t len = (pos + 1) - i;
 
-                    command += parse(output.substr(i, len), _, parse_args);
+                    command += parse_tags(output.substr(i, len), parse_args);
                     debug("command = " + command);
                     skip_lenght = len - 1;
                     continue;
@@ -367,9 +277,7 @@ std::string parse(const std::string_view input, systemInfo_t& systemInfo, std::s
         if (static_cast<int>(endBracketIndex) == -1)
             die("PARSER: Opened tag is not closed at index {} in string {}", dollarSignIndex, output);
 
-        const std::string& tagToReplace = fmt::format("${}{}{}", opentag, command, type);
-        const size_t       tagpos       = pureOutput.find(tagToReplace);
-        const size_t       taglen       = (endBracketIndex + 1) - dollarSignIndex;
+        const size_t taglen = (endBracketIndex + 1) - dollarSignIndex;
 
         switch (type)
         {
@@ -379,16 +287,9 @@ std::string parse(const std::string_view input, systemInfo_t& systemInfo, std::s
                 if (removetag)
                     command.erase(0, 1);
 
+                // $(!cmd) is not counted in the width, e.g for escape sequences
                 const std::string& cmd_output = read_shell_exec(command);
-                output.replace(dollarSignIndex, taglen, cmd_output);
-
-                if (!parsingLayout && tagpos != std::string::npos)
-                {
-                    if (removetag)
-                        pureOutput.erase(tagpos, taglen);
-                    else
-                        pureOutput.replace(tagpos, taglen, cmd_output);
-                }
+                output.replace(dollarSignIndex, taglen, removetag ? make_event(EVENT_RAW, cmd_output) : cmd_output);
             }
             break;
 
@@ -403,9 +304,6 @@ std::string parse(const std::string_view input, systemInfo_t& systemInfo, std::s
                 addValueFromModule(moduleName, moduleMemberName, parse_args);
 
                 output.replace(dollarSignIndex, taglen, getInfoFromName(systemInfo, moduleName, moduleMemberName));
-
-                if (!parsingLayout && tagpos != std::string::npos)
-                    pureOutput.replace(tagpos, taglen, getInfoFromName(systemInfo, moduleName, moduleMemberName));
             }
             break;
 
@@ -417,8 +315,8 @@ std::string parse(const std::string_view input, systemInfo_t& systemInfo, std::s
 
                 const bool invert = (command.front() == '!');
 
-                const float n1 = std::stof(parse(command.substr(invert ? 1 : 0, comma_pos), _, parse_args));
-                const float n2 = std::stof(parse(command.substr(comma_pos + 1), _, parse_args));
+                const float n1 = std::stof(parse(command.substr(invert ? 1 : 0, comma_pos), parse_args));
+                const float n2 = std::stof(parse(command.substr(comma_pos + 1), parse_args));
 
                 output.replace(dollarSignIndex, taglen,
                                get_and_color_percentage(n1, n2, parse_args, invert));
@@ -451,21 +349,7 @@ std::string parse(const std::string_view input, systemInfo_t& systemInfo, std::s
             }
             break;
 
-            case '}':  // please pay close attention when reading this really long code
-
-                if (config.m_disable_colors)
-                {
-                    output.erase(dollarSignIndex, taglen);
-                    if (tagpos != std::string::npos)
-                        pureOutput.erase(tagpos, tagToReplace.length());
-                    break;
-                }
-
-                // if at end there a '$', it will make the end output "$</span>" and so it will confuse
-                // addValueFromModule() and so let's make it "$ </span>". this is geniunenly stupid
-                if (config.gui && output.back() == '$')
-                    output += ' ';
-
+            case '}':
                 if (!config.colors_name.empty())
                 {
                     const auto& it_name = std::find(config.colors_name.begin(), config.colors_name.end(), command);
@@ -501,275 +385,47 @@ std::string parse(const std::string_view input, systemInfo_t& systemInfo, std::s
 
             jumpauto:
                 if (command == "1")
-                {
-                    if (firstrun_noclr)
-                        output.replace(dollarSignIndex, taglen,
-                                       config.gui ? "<span weight='bold'>" : NOCOLOR_BOLD);
-                    else
-                        output.replace(dollarSignIndex, taglen,
-                                       config.gui ? "</span><span weight='bold'>" : NOCOLOR_BOLD);
-                }
+                    output.replace(dollarSignIndex, taglen, make_event(EVENT_RESET_BOLD));
                 else if (command == "0")
-                {
-                    if (firstrun_noclr)
-                        output.replace(dollarSignIndex, taglen, config.gui ? "<span>" : NOCOLOR);
-                    else
-                        output.replace(dollarSignIndex, taglen, config.gui ? "</span><span>" : NOCOLOR);
-                }
+                    output.replace(dollarSignIndex, taglen, make_event(EVENT_RESET));
                 else
                 {
-                    std::string str_clr;
-                    if (config.gui)
-                    {
-                        switch (fnv1a16::hash(command))
-                        {
-                            case "black"_fnv1a16:   str_clr = colors.gui_black; break;
-                            case "red"_fnv1a16:     str_clr = colors.gui_red; break;
-                            case "blue"_fnv1a16:    str_clr = colors.gui_blue; break;
-                            case "green"_fnv1a16:   str_clr = colors.gui_green; break;
-                            case "cyan"_fnv1a16:    str_clr = colors.gui_cyan; break;
-                            case "yellow"_fnv1a16:  str_clr = colors.gui_yellow; break;
-                            case "magenta"_fnv1a16: str_clr = colors.gui_magenta; break;
-                            case "white"_fnv1a16:   str_clr = colors.gui_white; break;
-                            default:                str_clr = command; break;
-                        }
-
-                        const size_t pos = str_clr.find('#');
-                        if (pos != std::string::npos)
-                        {
-                            std::string tagfmt = "span ";
-                            const std::string& opt_clr = str_clr.substr(0, pos);
-
-                            size_t argmode_pos = 0;
-                            const auto& append_argmode = [&](const std::string_view fmt, const std::string_view error) -> size_t
-                            {
-                                if (opt_clr.at(argmode_pos + 1) == '(')
-                                {
-                                    const size_t closebrak = opt_clr.find(')', argmode_pos);
-                                    if (closebrak == std::string::npos)
-                                        die("{} mode in color {} doesn't have close bracket", error, str_clr);
-
-                                    const std::string& value = opt_clr.substr(argmode_pos + 2, closebrak - argmode_pos - 2);
-                                    tagfmt += fmt.data() + value + "' ";
-
-                                    return closebrak;
-                                }
-                                return 0;
-                            };
-
-                            bool bgcolor = false;
-                            for (uint i = 0; i < opt_clr.length(); ++i)
-                            {
-                                switch (opt_clr.at(i))
-                                {
-                                    case 'b':
-                                        bgcolor = true;
-                                        tagfmt += "bgcolor='" + str_clr.substr(pos) + "' ";
-                                        break;
-                                    case '!':
-                                        tagfmt += "weight='bold' "; break;
-                                    case 'u':
-                                        tagfmt += "underline='single' "; break;
-                                    case 'i':
-                                        tagfmt += "style='italic' "; break;
-                                    case 'o':
-                                        tagfmt += "overline='single' "; break;
-                                    case 's':
-                                        tagfmt += "strikethrough='true' "; break;
-
-                                    case 'a':
-                                        argmode_pos = i;
-                                        i += append_argmode("fgalpha='", "fgalpha");
-                                        break;
-
-                                    case 'A':
-                                        argmode_pos = i;
-                                        i += append_argmode("bgalpha='", "bgalpha");
-                                        break;
-
-                                    case 'L':
-                                        argmode_pos = i;
-                                        i += append_argmode("underline='", "underline option");
-                                        break;
-
-                                    case 'U':
-                                        argmode_pos = i;
-                                        i += append_argmode("underline_color='#", "colored underline");
-                                        break;
-
-                                    case 'B':
-                                        argmode_pos = i;
-                                        i += append_argmode("bgcolor='#", "bgcolor");
-                                        break;
-
-                                    case 'w':
-                                        argmode_pos = i;
-                                        i += append_argmode("weight='", "font weight style");
-                                        break;
-
-                                    case 'O':
-                                        argmode_pos = i;
-                                        i += append_argmode("overline_color='#", "overline color");
-                                        break;
-
-                                    case 'S':
-                                        argmode_pos = i;
-                                        i += append_argmode("strikethrough_color='#", "color of strikethrough line");
-                                        break;
-                                }
-                            }
-
-                            if (!bgcolor)
-                                tagfmt += "fgcolor='" + str_clr.substr(pos) + "' ";
-
-                            tagfmt.pop_back();
-                            output.replace(dollarSignIndex, output.length() - dollarSignIndex,
-                                           fmt::format("<{}>{}</span>", tagfmt, output.substr(endBracketIndex + 1)));
-                        }
-
-                        // "\\e" is for checking in the ascii_art, \033 in the config
-                        else if (hasStart(str_clr, "\\e") || hasStart(str_clr, "\033"))
-                        {
-                            const std::string& noesc_str = hasStart(str_clr, "\033") ? str_clr.substr(2) : str_clr.substr(3);
-                            debug("noesc_str = {}", noesc_str);
-
-                            if (hasStart(noesc_str, "38;2;") || hasStart(noesc_str, "48;2;"))
-                            {
-                                const std::string& hexclr = convert_ansi_escape_rgb(noesc_str);
-                                output.replace(dollarSignIndex, output.length() - dollarSignIndex,
-                                               fmt::format("<span {}gcolor='#{}'>{}</span>", hasStart(noesc_str, "38") ? 'f' : 'b', hexclr,
-                                                            output.substr(endBracketIndex + 1)));
-                            }
-                            else
-                            {
-                                const std::array<std::string, 3>& clrs = get_ansi_color(noesc_str, colors);
-                                const std::string_view color           = clrs.at(0);
-                                const std::string_view weight          = clrs.at(1);
-                                const std::string_view type            = clrs.at(2);
-                                output.replace(dollarSignIndex, output.length() - dollarSignIndex,
-                                               fmt::format("<span {}='{}' weight='{}'>{}</span>", type, color, weight,
-                                                           output.substr(endBracketIndex + 1)));
-                            }
-                        }
-
-                        else
-                        {
-                            error("PARSER: failed to parse line with color '{}'", str_clr);
-                            break;
-                        }
-
-                        firstrun_noclr = false;
-                    }
-                    // if (!config.gui)
-                    else
-                    {
-                        switch (fnv1a16::hash(command))
-                        {
-                            case "black"_fnv1a16:   str_clr = colors.black; break;
-                            case "red"_fnv1a16:     str_clr = colors.red; break;
-                            case "blue"_fnv1a16:    str_clr = colors.blue; break;
-                            case "green"_fnv1a16:   str_clr = colors.green; break;
-                            case "cyan"_fnv1a16:    str_clr = colors.cyan; break;
-                            case "yellow"_fnv1a16:  str_clr = colors.yellow; break;
-                            case "magenta"_fnv1a16: str_clr = colors.magenta; break;
-                            case "white"_fnv1a16:   str_clr = colors.white; break;
-                            default:                str_clr = command; break;
-                        }
-
-                        std::string formatted_replacement_string;
-
-                        const size_t pos = str_clr.find('#');
-                        if (pos != std::string::npos)
-                        {
-                            const std::string& opt_clr = str_clr.substr(0, pos);
-
-                            fmt::text_style style;
-
-                            const auto& skip_gui_argmode = [&opt_clr](const size_t index) -> size_t
-                            {
-                                if (opt_clr.at(index + 1) == '(')
-                                {
-                                    const size_t closebrak = opt_clr.find(')', index);
-                                    if (closebrak == std::string::npos)
-                                        return 0;
-
-                                    return closebrak;
-                                }
-                                return 0;
-                            };
-
-                            bool bgcolor = false;
-                            for (uint i = 0; i < opt_clr.length(); ++i)
-                            {
-                                switch (opt_clr.at(i))
-                                {
-                                    case 'b':
-                                        bgcolor = true;
-                                        append_styles(style, fmt::bg(hexStringToColor(str_clr.substr(pos))));
-                                        break;
-                                    case '!':
-                                        append_styles(style, fmt::emphasis::bold); break;
-                                    case 'u':
-                                        append_styles(style, fmt::emphasis::underline); break;
-                                    case 'i':
-                                        append_styles(style, fmt::emphasis::italic); break;
-                                    case 'l':
-                                        append_styles(style, fmt::emphasis::blink); break;
-                                    case 's':
-                                        append_styles(style, fmt::emphasis::strikethrough); break;
-
-                                    case 'U':
-                                    case 'B':
-                                    case 'S':
-                                    case 'a':
-                                    case 'w':
-                                    case 'O':
-                                    case 'A':
-                                    case 'L':
-                                        i += skip_gui_argmode(i); break;
-                                }
-                            }
-
-                            if (!bgcolor)
-                                append_styles(style, fmt::fg(hexStringToColor(str_clr.substr(pos))));
-
-                            formatted_replacement_string = fmt::format(style, "{}", output.substr(endBracketIndex + 1));
-                        }
-
-                        // "\\e" is for checking in the ascii_art, \033 in the config
-                        else if (hasStart(str_clr, "\\e") || hasStart(str_clr, "\033"))
-                        {
-                            formatted_replacement_string =
-                                fmt::format("\x1B[{}{}",
-                                            hasStart(str_clr, "\033") ? str_clr.substr(2) : str_clr.substr(3),
-                                            output.substr(endBracketIndex + 1));
-                        }
-
-                        else
-                        {
-                            error("PARSER: failed to parse line with color '{}'", str_clr);
-                            break;
-                        }
-                        output.replace(dollarSignIndex, output.length() - dollarSignIndex,
-                                       formatted_replacement_string);
-                    }
+                    output.replace(dollarSignIndex, taglen, make_event(EVENT_STYLE, command));
 
                     if (!parsingLayout &&
                         std::find(auto_colors.begin(), auto_colors.end(), command) == auto_colors.end())
                         auto_colors.push_back(command);
                 }
-
-                if (config.gui && firstrun_noclr)
-                    output += "</span>";
-
-                if (!parsingLayout && tagpos != std::string::npos)
-                    pureOutput.erase(tagpos, tagToReplace.length());
         }
     }
 
     return output;
 }
 
+static std::string parse(const std::string_view input, parse_args_t& parse_args)
+{
+    const std::string& output = parse_tags(input, parse_args);
+    if (output.find(EVENT_START) == std::string::npos)
+        return output;
+
+    return make_event(EVENT_SCOPE_OPEN) + output + make_event(EVENT_SCOPE_CLOSE);
+}
+
+void parse(const std::string_view input, systemInfo_t& systemInfo, OutputSink& sink, const Config& config,
+           const colors_t& colors, const bool parsingLayout)
+{
+    parse_args_t parse_args{ systemInfo, config, colors, parsingLayout };
+    write_events(parse(input, parse_args), sink);
+}
+
+std::string parse(const std::string_view input, systemInfo_t& systemInfo, const Config& config,
+                  const colors_t& colors, const bool parsingLayout)
+{
+    const std::unique_ptr<OutputSink>& sink = make_output_sink(config, colors);
+    parse(input, systemInfo, *sink, config, colors, parsingLayout);
+    return sink->str();
+}
+
 static std::string get_auto_uptime(const std::uint16_t days, const std::uint16_t hours, const std::uint16_t mins,
                                    const std::uint16_t secs, const Config& config)
 {
@@ -792,6 +448,12 @@ static std::string get_auto_uptime(const std::uint16_t days, const std::uint16_t
     return ret;
 }
 
+static std::string get_auto_rate(const double bytes_per_sec, const std::uint16_t byte_unit)
+{
+    const byte_units_t& rate = auto_devide_bytes(bytes_per_sec, byte_unit);
+    return fmt::format("{:.2f} {}/s", rate.num_bytes, rate.unit);
+}
+
 static std::string get_auto_gtk_format(const std::string_view gtk2, const std::string_view gtk3,
                                        const std::string_view gtk4)
 {
@@ -879,6 +541,13 @@ static std::string prettify_de_name(const std::string_view de_name)
     return de_name.data();
 }
 
+bool is_bytes_unit(const std::string_view unit)
+{
+    static constexpr std::array<std::string_view, 17> sorted_valid_prefixes = {"B", "EB", "EiB", "GB", "GiB", "KiB", "MB", "MiB", "PB", "PiB", "TB", "TiB", "YB", "YiB", "ZB", "ZiB", "kB"};
+    return std::binary_search(sorted_valid_prefixes.begin(), sorted_valid_prefixes.end(), unit);
+}
+
+// a new module or member also goes in the modules_table of src/json.cpp (see scripts/check_modules_table.py)
 void addValueFromModule(const std::string& moduleName, const std::string& moduleMemberName, parse_args_t& parse_args)
 {
 #define SYSINFO_INSERT(x) sysInfo.at(moduleName).insert({ moduleMemberName, variant(x) })
@@ -889,22 +558,46 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
 
     const  auto&                      moduleMember_hash = fnv1a16::hash(moduleMemberName);
     static std::vector<std::uint16_t> queried_gpus;
-    static std::vector<std::string>   queried_disks;
-    static std::vector<std::string>   queried_themes_names;
-    static systemInfo_t               queried_themes;
 
     const std::uint16_t byte_unit = config.use_SI_unit ? 1000 : 1024;
-    constexpr std::array<std::string_view, 32> sorted_valid_prefixes = {"B", "EB", "EiB", "GB", "GiB", "kB", "KiB", "MB", "MiB", "PB", "PiB", "TB", "TiB", "YB", "YiB", "ZB", "ZiB"};
-
-    const auto& return_devided_bytes = [&sorted_valid_prefixes, &moduleMemberName](const double& amount) -> double
+    const auto& return_devided_bytes = [&moduleMemberName](const double& amount) -> double
     {
         const std::string& prefix = moduleMemberName.substr(moduleMemberName.find('-')+1);
-        if (std::binary_search(sorted_valid_prefixes.begin(), sorted_valid_prefixes.end(), prefix))
+        if (is_bytes_unit(prefix))
             return devide_bytes(amount, prefix).num_bytes;
 
         return 0;
     };
 
+    // already queried, no need to construct the Query classes
+    if (const auto& it = sysInfo.find(moduleName);
+        it != sysInfo.end() && it->second.find(moduleMemberName) != it->second.end())
+        return;
+
+    // its Query classes are being used by a query stuck on another thread
+    if (Scheduler::is_poisoned(moduleName))
+    {
+        sysInfo[moduleName].insert(
+            { moduleMemberName, variant(config.deadline_fallback == "hide" ? MAGIC_LINE : config.deadline_placeholder) });
+        return;
+    }
+
+    // everything comes from the snapshot, the system is never queried.
+    // The amounts of bytes in other units are from the ones in bytes, e.g used-GiB from used-B
+    if (!config.m_from_snapshot.empty() && moduleName != "builtin")
+    {
+        auto&        members  = sysInfo[moduleName];
+        const size_t dash_pos = moduleMemberName.find('-');
+        const auto&  bytes    = dash_pos != moduleMemberName.npos
+                                    ? members.find(moduleMemberName.substr(0, dash_pos) + "-B") : members.end();
+
+        if (bytes != members.end() && std::holds_alternative<double>(bytes->second))
+            members.insert({ moduleMemberName, variant(return_devided_bytes(std::get<double>(bytes->second))) });
+        else
+            members.insert({ moduleMemberName, variant(UNKNOWN) });
+        return;
+    }
+
     if (moduleName == "os")
     {
         Query::System query_system;
@@ -998,15 +691,16 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
             switch (moduleMember_hash)
             {
                 case "title"_fnv1a16:
-                    SYSINFO_INSERT(parse("${auto2}$<user.name>${0}@${auto2}$<os.hostname>", _, parse_args));
+                    SYSINFO_INSERT(parse("${auto2}$<user.name>${0}@${auto2}$<os.hostname>", parse_args));
                     break;
 
                 case "title_sep"_fnv1a16:
                 {
-                    // no need to parse anything
-                    Query::User   query_user;
-                    Query::System query_system;
-                    const size_t& title_len = std::string_view(query_user.name() + '@' + query_system.hostname()).length();
+                    // the same values as the title, they may have timed out (see Scheduler::query())
+                    addValueFromModule("user", "name", parse_args);
+                    addValueFromModule("os", "hostname", parse_args);
+                    const size_t& title_len = display_width(getInfoFromName(sysInfo, "user", "name") + '@' +
+                                                            getInfoFromName(sysInfo, "os", "hostname"));
 
                     std::string str;
                     str.reserve(config.builtin_title_sep.length() * title_len);
@@ -1019,11 +713,11 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
 
                 // clang-format off
                 case "colors"_fnv1a16:
-                    SYSINFO_INSERT(parse("${\033[40m}   ${\033[41m}   ${\033[42m}   ${\033[43m}   ${\033[44m}   ${\033[45m}   ${\033[46m}   ${\033[47m}   ${0}", _, parse_args));
+                    SYSINFO_INSERT(parse("${\033[40m}   ${\033[41m}   ${\033[42m}   ${\033[43m}   ${\033[44m}   ${\033[45m}   ${\033[46m}   ${\033[47m}   ${0}", parse_args));
                     break;
 
                 case "colors_light"_fnv1a16:
-                    SYSINFO_INSERT(parse("${\033[100m}   ${\033[101m}   ${\033[102m}   ${\033[103m}   ${\033[104m}   ${\033[105m}   ${\033[106m}   ${\033[107m}   ${0}", _, parse_args));
+                    SYSINFO_INSERT(parse("${\033[100m}   ${\033[101m}   ${\033[102m}   ${\033[103m}   ${\033[104m}   ${\033[105m}   ${\033[106m}   ${\033[107m}   ${0}", parse_args));
                     break;
 
                 default:
@@ -1043,7 +737,7 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
 
                         SYSINFO_INSERT(
                             parse(fmt::format("${{\033[30m}} {0} ${{\033[31m}} {0} ${{\033[32m}} {0} ${{\033[33m}} {0} ${{\033[34m}} {0} ${{\033[35m}} {0} ${{\033[36m}} {0} ${{\033[37m}} {0} ${{0}}",
-                                              symbol), _, parse_args));
+                                              symbol), parse_args));
                     }
                     else if (hasStart(moduleMemberName, "colors_light_symbol"))
                     {
@@ -1060,7 +754,7 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
 
                         SYSINFO_INSERT(
                             parse(fmt::format("${{\033[90m}} {0} ${{\033[91m}} {0} ${{\033[92m}} {0} ${{\033[93m}} {0} ${{\033[94m}} {0} ${{\033[95m}} {0} ${{\033[96m}} {0} ${{\033[97m}} {0} ${{0}}",
-                                              symbol), _, parse_args));
+                                              symbol), parse_args));
                     }
             }
         }
@@ -1124,7 +818,7 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
 
     else if (moduleName == "theme")
     {
-        Query::Theme query_theme(queried_themes, config, false);
+        Query::Theme query_theme(config, false);
 
         if (sysInfo.find(moduleName) == sysInfo.end())
             sysInfo.insert({ moduleName, {} });
@@ -1155,7 +849,7 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
         {
             if (hasStart(moduleMemberName, "cursor"))
             {
-                Query::Theme query_cursor(queried_themes, config, true);
+                Query::Theme query_cursor(config, true);
                 switch (moduleMember_hash)
                 {
                     case "cursor"_fnv1a16:
@@ -1170,7 +864,7 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
             }
             else
             {
-                Query::Theme query_theme(0, queried_themes, queried_themes_names, "gsettings", config, true);
+                Query::Theme query_theme(0, config, true);
                 switch (moduleMember_hash)
                 {
                     case "name"_fnv1a16: SYSINFO_INSERT(query_theme.gtk_theme()); break;
@@ -1181,12 +875,39 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
         }
     }
 
+    else if (moduleName == "theme-qt")
+    {
+        Query::ThemeQt query_theme;
+
+        if (sysInfo.find(moduleName) == sysInfo.end())
+            sysInfo.insert({ moduleName, {} });
+
+        if (sysInfo.at(moduleName).find(moduleMemberName) == sysInfo.at(moduleName).end())
+        {
+            switch (moduleMember_hash)
+            {
+                case "style"_fnv1a16:        SYSINFO_INSERT(query_theme.style()); break;
+                case "color_scheme"_fnv1a16: SYSINFO_INSERT(query_theme.color_scheme()); break;
+                case "icons"_fnv1a16:        SYSINFO_INSERT(query_theme.icon_theme()); break;
+                case "font"_fnv1a16:         SYSINFO_INSERT(query_theme.font()); break;
+                case "cursor"_fnv1a16:
+                    if (query_theme.cursor_size() == UNKNOWN)
+                        SYSINFO_INSERT(query_theme.cursor());
+                    else
+                        SYSINFO_INSERT(fmt::format("{} ({}px)", query_theme.cursor(), query_theme.cursor_size()));
+                    break;
+                case "cursor_name"_fnv1a16:  SYSINFO_INSERT(query_theme.cursor()); break;
+                case "cursor_size"_fnv1a16:  SYSINFO_INSERT(query_theme.cursor_size()); break;
+            }
+        }
+    }
+
     // clang-format off
     else if (moduleName == "theme-gtk-all")
     {
-        Query::Theme gtk2(2, queried_themes, queried_themes_names, "gtk2", config);
-        Query::Theme gtk3(3, queried_themes, queried_themes_names, "gtk3", config);
-        Query::Theme gtk4(4, queried_themes, queried_themes_names, "gtk4", config);
+        Query::Theme gtk2(2, config);
+        Query::Theme gtk3(3, config);
+        Query::Theme gtk4(4, config);
         
         if (sysInfo.find(moduleName) == sysInfo.end())
             sysInfo.insert({ moduleName, {} });
@@ -1212,7 +933,7 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
                 "Syntax should be like 'theme_gtkN' which N stands for the version of gtk to query (single number)",
                 moduleName);
 
-        Query::Theme query_theme(ver, queried_themes, queried_themes_names, fmt::format("gtk{}", ver), config);
+        Query::Theme query_theme(ver, config);
 
         if (sysInfo.find(moduleName) == sysInfo.end())
             sysInfo.insert({ moduleName, {} });
@@ -1256,6 +977,12 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
                 case "freq_max"_fnv1a16: SYSINFO_INSERT(query_cpu.freq_max()); break;
 
                 case "freq_min"_fnv1a16: SYSINFO_INSERT(query_cpu.freq_min()); break;
+
+                case "usage"_fnv1a16:
+                {
+                    Query::Sampler query_sampler(config.sampler_interval);
+                    SYSINFO_INSERT(get_and_color_percentage(query_sampler.cpu_usage(), 100, parse_args));
+                } break;
             }
         }
     }
@@ -1281,6 +1008,105 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
         }
     }
 
+    else if (moduleName == "disks")
+    {
+        std::vector<Query::Disk::Disk_t*>& disks = Query::Disk::all_disks(config.disk_timeout);
+
+        if (sysInfo.find(moduleName) == sysInfo.end())
+            sysInfo.insert({ moduleName, {} });
+
+        if (sysInfo.at(moduleName).find(moduleMemberName) == sysInfo.at(moduleName).end())
+        {
+            double total_amount = 0, used_amount = 0, free_amount = 0;
+            for (const Query::Disk::Disk_t* disk : disks)
+            {
+                total_amount += disk->total_amount;
+                used_amount  += disk->used_amount;
+                free_amount  += disk->free_amount;
+            }
+
+            const byte_units_t& total_units = auto_devide_bytes(total_amount, byte_unit);
+            const byte_units_t& used_units  = auto_devide_bytes(used_amount, byte_unit);
+            const byte_units_t& free_units  = auto_devide_bytes(free_amount, byte_unit);
+
+            switch (moduleMember_hash)
+            {
+                case "disks"_fnv1a16:
+                {
+                    std::string str;
+                    for (const Query::Disk::Disk_t* disk : disks)
+                    {
+                        if (disk->stale)
+                        {
+                            str += fmt::format("{}: stale mount - {}, ", disk->mountdir, disk->typefs);
+                            continue;
+                        }
+
+                        const byte_units_t& disk_used  = auto_devide_bytes(disk->used_amount, byte_unit);
+                        const byte_units_t& disk_total = auto_devide_bytes(disk->total_amount, byte_unit);
+                        const std::string&  perc = get_and_color_percentage(disk->used_amount, disk->total_amount, parse_args);
+
+                        str += fmt::format("{}: {:.2f} {} / {:.2f} {} {} - {}, ", disk->mountdir,
+                                           disk_used.num_bytes, disk_used.unit,
+                                           disk_total.num_bytes, disk_total.unit,
+                                           parse("${0}(" + perc + ")", parse_args), disk->typefs);
+                    }
+
+                    if (str.empty())
+                        str = MAGIC_LINE;
+                    else
+                        str.erase(str.length() - 2);  // remove last ", "
+
+                    SYSINFO_INSERT(str);
+                } break;
+
+                case "mountdirs"_fnv1a16:
+                {
+                    std::string str;
+                    for (const Query::Disk::Disk_t* disk : disks)
+                        str += disk->mountdir + ", ";
+
+                    if (str.empty())
+                        str = MAGIC_LINE;
+                    else
+                        str.erase(str.length() - 2);
+
+                    SYSINFO_INSERT(str);
+                } break;
+
+                case "count"_fnv1a16: SYSINFO_INSERT(disks.size()); break;
+
+                case "used"_fnv1a16:
+                    SYSINFO_INSERT(fmt::format("{:.2f} {}", used_units.num_bytes, used_units.unit));
+                    break;
+
+                case "total"_fnv1a16:
+                    SYSINFO_INSERT(fmt::format("{:.2f} {}", total_units.num_bytes, total_units.unit));
+                    break;
+
+                case "free"_fnv1a16:
+                    SYSINFO_INSERT(fmt::format("{:.2f} {}", free_units.num_bytes, free_units.unit));
+                    break;
+
+                case "free_perc"_fnv1a16:
+                    SYSINFO_INSERT(get_and_color_percentage(free_amount, total_amount, parse_args, true));
+                    break;
+
+                case "used_perc"_fnv1a16:
+                    SYSINFO_INSERT(get_and_color_percentage(used_amount, total_amount, parse_args));
+                    break;
+
+                default:
+                    if (hasStart(moduleMemberName, "free-"))
+                        SYSINFO_INSERT(return_devided_bytes(free_amount));
+                    else if (hasStart(moduleMemberName, "used-"))
+                        SYSINFO_INSERT(return_devided_bytes(used_amount));
+                    else if (hasStart(moduleMemberName, "total-"))
+                        SYSINFO_INSERT(return_devided_bytes(total_amount));
+            }
+        }
+    }
+
     else if (hasStart(moduleName, "disk"))
     {
         if (moduleName.length() < "disk()"_len)
@@ -1297,7 +1123,7 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
         path.pop_back();   // )
         debug("disk path = {}", path);
 
-        Query::Disk                 query_disk(path, queried_disks);
+        Query::Disk                 query_disk(path, config.disk_timeout);
         std::array<byte_units_t, 3> byte_units;
 
         if (sysInfo.find(moduleName) == sysInfo.end())
@@ -1305,6 +1131,33 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
 
         if (sysInfo.at(moduleName).find(moduleMemberName) == sysInfo.at(moduleName).end())
         {
+            // statvfs() didn't answer in time, we don't know the amounts
+            if (query_disk.stale())
+            {
+                switch (moduleMember_hash)
+                {
+                    case "disk"_fnv1a16:
+                        SYSINFO_INSERT(fmt::format("stale mount - {}", query_disk.typefs()));
+                        return;
+
+                    case "used"_fnv1a16:
+                    case "total"_fnv1a16:
+                    case "free"_fnv1a16:
+                    case "free_perc"_fnv1a16:
+                    case "used_perc"_fnv1a16:
+                        SYSINFO_INSERT("stale");
+                        return;
+
+                    default:
+                        if (hasStart(moduleMemberName, "used-") || hasStart(moduleMemberName, "total-") ||
+                            hasStart(moduleMemberName, "free-"))
+                        {
+                            SYSINFO_INSERT("stale");
+                            return;
+                        }
+                }
+            }
+
             byte_units.at(TOTAL) = auto_devide_bytes(query_disk.total_amount(), byte_unit);
             byte_units.at(USED)  = auto_devide_bytes(query_disk.used_amount(), byte_unit);
             byte_units.at(FREE)  = auto_devide_bytes(query_disk.free_amount(), byte_unit);
@@ -1324,7 +1177,7 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
                     SYSINFO_INSERT(fmt::format("{:.2f} {} / {:.2f} {} {} - {}", 
                                                byte_units.at(USED).num_bytes, byte_units.at(USED).unit,
                                                byte_units.at(TOTAL).num_bytes,byte_units.at(TOTAL).unit, 
-                                               parse("${0}(" + perc + ")", _, parse_args),
+                                               parse("${0}(" + perc + ")", parse_args),
 				                query_disk.typefs()));
                 } break;
                     // clang-format on
@@ -1351,6 +1204,18 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
                                                             parse_args));
                     break;
 
+                case "read_rate"_fnv1a16:
+                {
+                    Query::Sampler query_sampler(config.sampler_interval);
+                    SYSINFO_INSERT(get_auto_rate(query_sampler.disk_read_rate(query_disk.device()), byte_unit));
+                } break;
+
+                case "write_rate"_fnv1a16:
+                {
+                    Query::Sampler query_sampler(config.sampler_interval);
+                    SYSINFO_INSERT(get_auto_rate(query_sampler.disk_write_rate(query_disk.device()), byte_unit));
+                } break;
+
                 default:
                     if (hasStart(moduleMemberName, "free-"))
                         SYSINFO_INSERT(return_devided_bytes(query_disk.free_amount()));
@@ -1358,6 +1223,57 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
                         SYSINFO_INSERT(return_devided_bytes(query_disk.used_amount()));
                     else if (hasStart(moduleMemberName, "total-"))
                         SYSINFO_INSERT(return_devided_bytes(query_disk.total_amount()));
+                    else if (hasStart(moduleMemberName, "read_rate-"))
+                    {
+                        Query::Sampler query_sampler(config.sampler_interval);
+                        SYSINFO_INSERT(return_devided_bytes(query_sampler.disk_read_rate(query_disk.device())));
+                    }
+                    else if (hasStart(moduleMemberName, "write_rate-"))
+                    {
+                        Query::Sampler query_sampler(config.sampler_interval);
+                        SYSINFO_INSERT(return_devided_bytes(query_sampler.disk_write_rate(query_disk.device())));
+                    }
+            }
+        }
+    }
+
+    else if (hasStart(moduleName, "net"))
+    {
+        // either "net" for all the interfaces (except loopback) or "net(iface)"
+        std::string iface;
+        if (moduleName.length() > "net"_len)
+        {
+            if (moduleName.length() < "net()"_len || moduleName.at("net"_len) != '(' || moduleName.back() != ')')
+                die("invalid net module name '{}', must be net(interface) e.g: net(eth0)", moduleName);
+
+            iface = moduleName.substr("net("_len);
+            iface.pop_back();  // )
+        }
+
+        Query::Sampler query_sampler(config.sampler_interval);
+
+        if (sysInfo.find(moduleName) == sysInfo.end())
+            sysInfo.insert({ moduleName, {} });
+
+        if (sysInfo.at(moduleName).find(moduleMemberName) == sysInfo.at(moduleName).end())
+        {
+            // same as disk(), "try" to remove the line
+            if (!query_sampler.has_net_iface(iface))
+            {
+                SYSINFO_INSERT(MAGIC_LINE);
+                return;
+            }
+
+            switch (moduleMember_hash)
+            {
+                case "rx_rate"_fnv1a16: SYSINFO_INSERT(get_auto_rate(query_sampler.net_rx_rate(iface), byte_unit)); break;
+                case "tx_rate"_fnv1a16: SYSINFO_INSERT(get_auto_rate(query_sampler.net_tx_rate(iface), byte_unit)); break;
+
+                default:
+                    if (hasStart(moduleMemberName, "rx_rate-"))
+                        SYSINFO_INSERT(return_devided_bytes(query_sampler.net_rx_rate(iface)));
+                    else if (hasStart(moduleMemberName, "tx_rate-"))
+                        SYSINFO_INSERT(return_devided_bytes(query_sampler.net_tx_rate(iface)));
             }
         }
     }
@@ -1378,10 +1294,10 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
 
         if (sysInfo.at(moduleName).find(moduleMemberName) == sysInfo.at(moduleName).end())
         {
-            //                                                            idk, trick the diviser
-            byte_units.at(FREE)  = auto_devide_bytes(query_ram.swap_free_amount() * byte_unit, byte_unit);
-            byte_units.at(USED)  = auto_devide_bytes(query_ram.swap_used_amount() * byte_unit, byte_unit);
-            byte_units.at(TOTAL) = auto_devide_bytes(query_ram.swap_total_amount() * byte_unit, byte_unit);
+            // the amounts are in KiB
+            byte_units.at(FREE)  = auto_devide_bytes(query_ram.swap_free_amount() * 1024, byte_unit);
+            byte_units.at(USED)  = auto_devide_bytes(query_ram.swap_used_amount() * 1024, byte_unit);
+            byte_units.at(TOTAL) = auto_devide_bytes(query_ram.swap_total_amount() * 1024, byte_unit);
 
             switch (moduleMember_hash)
             {
@@ -1397,7 +1313,7 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
                         SYSINFO_INSERT(fmt::format("{:.2f} {} / {:.2f} {} {}",
                                                     byte_units.at(USED).num_bytes, byte_units.at(USED).unit,
                                                     byte_units.at(TOTAL).num_bytes,byte_units.at(TOTAL).unit,
-                                                    parse("${0}(" + perc + ")", _, parse_args)));
+                                                    parse("${0}(" + perc + ")", parse_args)));
                     }
                     break;
                     // clang-format on
@@ -1426,11 +1342,11 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
 
                 default:
                     if (hasStart(moduleMemberName, "free-"))
-                        SYSINFO_INSERT(return_devided_bytes(query_ram.swap_free_amount()));
+                        SYSINFO_INSERT(return_devided_bytes(query_ram.swap_free_amount() * 1024));
                     else if (hasStart(moduleMemberName, "used-"))
-                        SYSINFO_INSERT(return_devided_bytes(query_ram.swap_used_amount()));
+                        SYSINFO_INSERT(return_devided_bytes(query_ram.swap_used_amount() * 1024));
                     else if (hasStart(moduleMemberName, "total-"))
-                        SYSINFO_INSERT(return_devided_bytes(query_ram.swap_total_amount()));
+                        SYSINFO_INSERT(return_devided_bytes(query_ram.swap_total_amount() * 1024));
             }
         }
     }
@@ -1451,10 +1367,15 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
 
         if (sysInfo.at(moduleName).find(moduleMemberName) == sysInfo.at(moduleName).end())
         {
-            //                                                     idk, trick the diviser
-            byte_units.at(USED)  = auto_devide_bytes(query_ram.used_amount()* byte_unit, byte_unit);
-            byte_units.at(TOTAL) = auto_devide_bytes(query_ram.total_amount() * byte_unit, byte_unit);
-            byte_units.at(FREE)  = auto_devide_bytes(query_ram.free_amount()* byte_unit, byte_unit);
+            // the amounts are in KiB
+            byte_units.at(USED)  = auto_devide_bytes(query_ram.used_amount() * 1024, byte_unit);
+            byte_units.at(TOTAL) = auto_devide_bytes(query_ram.total_amount() * 1024, byte_unit);
+            byte_units.at(FREE)  = auto_devide_bytes(query_ram.free_amount() * 1024, byte_unit);
+
+            const auto& format_kib = [byte_unit](const double amount) -> std::string {
+                const byte_units_t& units = auto_devide_bytes(amount * 1024, byte_unit);
+                return fmt::format("{:.2f} {}", units.num_bytes, units.unit);
+            };
 
             switch (moduleMember_hash)
             {
@@ -1467,7 +1388,7 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
                     SYSINFO_INSERT(fmt::format("{:.2f} {} / {:.2f} {} {}",
                                                byte_units.at(USED).num_bytes, byte_units.at(USED).unit,
                                                byte_units.at(TOTAL).num_bytes,byte_units.at(TOTAL).unit,
-                                               parse("${0}(" + perc + ")", _, parse_args)));
+                                               parse("${0}(" + perc + ")", parse_args)));
                     break;
                     // clang-format on
                 }
@@ -1491,13 +1412,116 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
                     SYSINFO_INSERT(get_and_color_percentage(query_ram.used_amount(), query_ram.total_amount(), parse_args));
                     break;
 
+                case "cached"_fnv1a16:    SYSINFO_INSERT(format_kib(query_ram.cached_amount())); break;
+                case "buffers"_fnv1a16:   SYSINFO_INSERT(format_kib(query_ram.buffers_amount())); break;
+                case "shmem"_fnv1a16:     SYSINFO_INSERT(format_kib(query_ram.shmem_amount())); break;
+                case "dirty"_fnv1a16:     SYSINFO_INSERT(format_kib(query_ram.dirty_amount())); break;
+                case "writeback"_fnv1a16: SYSINFO_INSERT(format_kib(query_ram.writeback_amount())); break;
+                case "zswap"_fnv1a16:     SYSINFO_INSERT(format_kib(query_ram.zswap_amount())); break;
+                case "zswapped"_fnv1a16:  SYSINFO_INSERT(format_kib(query_ram.zswapped_amount())); break;
+                case "hugetlb"_fnv1a16:   SYSINFO_INSERT(format_kib(query_ram.hugetlb_amount())); break;
+
+                case "zswap_ratio"_fnv1a16:
+                    SYSINFO_INSERT(fmt::format("{:.2f}", query_ram.zswap_amount() > 0
+                                                         ? query_ram.zswapped_amount() / query_ram.zswap_amount() : 0));
+                    break;
+
+                case "hugepage_size"_fnv1a16:   SYSINFO_INSERT(format_kib(query_ram.hugepage_size())); break;
+                case "hugepages_total"_fnv1a16: SYSINFO_INSERT(query_ram.hugepages_total()); break;
+                case "hugepages_free"_fnv1a16:  SYSINFO_INSERT(query_ram.hugepages_free()); break;
+
+                case "pressure_some"_fnv1a16:
+                    SYSINFO_INSERT(get_and_color_percentage(query_ram.pressure_some(), 100, parse_args));
+                    break;
+
+                case "pressure_full"_fnv1a16:
+                    SYSINFO_INSERT(get_and_color_percentage(query_ram.pressure_full(), 100, parse_args));
+                    break;
+
                 default:
                     if (hasStart(moduleMemberName, "free-"))
-                        SYSINFO_INSERT(return_devided_bytes(query_ram.free_amount()));
+                        SYSINFO_INSERT(return_devided_bytes(query_ram.free_amount() * 1024));
                     else if (hasStart(moduleMemberName, "used-"))
-                        SYSINFO_INSERT(return_devided_bytes(query_ram.used_amount()));
+                        SYSINFO_INSERT(return_devided_bytes(query_ram.used_amount() * 1024));
                     else if (hasStart(moduleMemberName, "total-"))
-                        SYSINFO_INSERT(return_devided_bytes(query_ram.total_amount()));
+                        SYSINFO_INSERT(return_devided_bytes(query_ram.total_amount() * 1024));
+                    else if (hasStart(moduleMemberName, "cached-"))
+                        SYSINFO_INSERT(return_devided_bytes(query_ram.cached_amount() * 1024));
+                    else if (hasStart(moduleMemberName, "buffers-"))
+                        SYSINFO_INSERT(return_devided_bytes(query_ram.buffers_amount() * 1024));
+                    else if (hasStart(moduleMemberName, "shmem-"))
+                        SYSINFO_INSERT(return_devided_bytes(query_ram.shmem_amount() * 1024));
+                    else if (hasStart(moduleMemberName, "dirty-"))
+                        SYSINFO_INSERT(return_devided_bytes(query_ram.dirty_amount() * 1024));
+                    else if (hasStart(moduleMemberName, "writeback-"))
+                        SYSINFO_INSERT(return_devided_bytes(query_ram.writeback_amount() * 1024));
+                    else if (hasStart(moduleMemberName, "zswap-"))
+                        SYSINFO_INSERT(return_devided_bytes(query_ram.zswap_amount() * 1024));
+                    else if (hasStart(moduleMemberName, "zswapped-"))
+                        SYSINFO_INSERT(return_devided_bytes(query_ram.zswapped_amount() * 1024));
+                    else if (hasStart(moduleMemberName, "hugetlb-"))
+                        SYSINFO_INSERT(return_devided_bytes(query_ram.hugetlb_amount() * 1024));
+                    else if (hasStart(moduleMemberName, "hugepage_size-"))
+                        SYSINFO_INSERT(return_devided_bytes(query_ram.hugepage_size() * 1024));
+            }
+        }
+    }
+
+    else if (hasStart(moduleName, "zram"))
+    {
+        // either "zram" for all the devices or "zram(name)"
+        std::string name;
+        if (moduleName.length() > "zram"_len)
+        {
+            if (moduleName.length() < "zram()"_len || moduleName.at("zram"_len) != '(' || moduleName.back() != ')')
+                die("invalid zram module name '{}', must be zram(device) e.g: zram(zram0)", moduleName);
+
+            name = moduleName.substr("zram("_len);
+            name.pop_back();  // )
+        }
+
+        const Query::RAM::zram_t& zram = Query::RAM::zram(name);
+
+        if (sysInfo.find(moduleName) == sysInfo.end())
+            sysInfo.insert({ moduleName, {} });
+
+        if (sysInfo.at(moduleName).find(moduleMemberName) == sysInfo.at(moduleName).end())
+        {
+            // same as disk(), "try" to remove the line
+            if (!zram.exists)
+            {
+                SYSINFO_INSERT(MAGIC_LINE);
+                return;
+            }
+
+            const byte_units_t& orig  = auto_devide_bytes(zram.orig_amount, byte_unit);
+            const byte_units_t& compr = auto_devide_bytes(zram.compr_amount, byte_unit);
+            const byte_units_t& used  = auto_devide_bytes(zram.used_amount, byte_unit);
+            const byte_units_t& total = auto_devide_bytes(zram.total_amount, byte_unit);
+            const double        ratio = zram.compr_amount > 0 ? zram.orig_amount / zram.compr_amount : 0;
+
+            switch (moduleMember_hash)
+            {
+                case "zram"_fnv1a16:
+                    SYSINFO_INSERT(fmt::format("{:.2f} {} -> {:.2f} {} ({:.2f}x)", orig.num_bytes, orig.unit,
+                                               compr.num_bytes, compr.unit, ratio));
+                    break;
+
+                case "orig"_fnv1a16:  SYSINFO_INSERT(fmt::format("{:.2f} {}", orig.num_bytes, orig.unit)); break;
+                case "compr"_fnv1a16: SYSINFO_INSERT(fmt::format("{:.2f} {}", compr.num_bytes, compr.unit)); break;
+                case "used"_fnv1a16:  SYSINFO_INSERT(fmt::format("{:.2f} {}", used.num_bytes, used.unit)); break;
+                case "total"_fnv1a16: SYSINFO_INSERT(fmt::format("{:.2f} {}", total.num_bytes, total.unit)); break;
+                case "ratio"_fnv1a16: SYSINFO_INSERT(fmt::format("{:.2f}", ratio)); break;
+
+                default:
+                    if (hasStart(moduleMemberName, "orig-"))
+                        SYSINFO_INSERT(return_devided_bytes(zram.orig_amount));
+                    else if (hasStart(moduleMemberName, "compr-"))
+                        SYSINFO_INSERT(return_devided_bytes(zram.compr_amount));
+                    else if (hasStart(moduleMemberName, "used-"))
+                        SYSINFO_INSERT(return_devided_bytes(zram.used_amount));
+                    else if (hasStart(moduleMemberName, "total-"))
+                        SYSINFO_INSERT(return_devided_bytes(zram.total_amount));
             }
         }
     }
@@ -1505,3 +1529,106 @@ void addValueFromModule(const std::string& moduleName, const std::string& module
     else
         die("Invalid module name: {}", moduleName);
 }
+
+static std::uint8_t get_tag_deps(const std::string_view module, const std::string_view member)
+{
+    std::uint8_t deps = 0;
+    if (member == "usage" || member.find("_rate") != member.npos || hasStart(module, "net("))
+        deps |= DEP_SAMPLER;
+
+    if (module == "os" && hasStart(member, "uptime"))
+        deps |= DEP_SYSTEM;
+    else if (module == "cpu" && (member == "cpu" || hasStart(member, "freq_cur")))
+        deps |= DEP_CPU;
+    else if (module == "ram" || module == "swap" || hasStart(module, "zram"))
+        deps |= DEP_RAM;
+    else if (hasStart(module, "disk"))
+        deps |= DEP_DISK;
+
+    return deps;
+}
+
+std::vector<dynamic_tag_t> get_dynamic_tags(const std::string_view line)
+{
+    std::vector<dynamic_tag_t> tags;
+    size_t                     start = 0;
+    while ((start = line.find("$<", start)) != line.npos)
+    {
+        const size_t end = line.find('>', start);
+        if (end == line.npos)
+            break;
+
+        // the dot after the device name, e.g disk(/mnt/my.disk).used
+        const std::string_view tag       = line.substr(start + 2, end - start - 2);
+        const size_t           closebrak = tag.find(')');
+        const size_t           dot_pos   = tag.find('.', closebrak == tag.npos ? 0 : closebrak);
+        if (dot_pos != tag.npos)
+        {
+            const std::string_view module = tag.substr(0, dot_pos);
+            const std::string_view member = tag.substr(dot_pos + 1);
+            if (const std::uint8_t deps = get_tag_deps(module, member))
+                tags.push_back({ std::string(module), std::string(member), deps });
+        }
+
+        start = end + 1;
+    }
+
+    return tags;
+}
+
+void clear_auto_colors()
+{ auto_colors.clear(); }
+
+void query_layout_tags(systemInfo_t& systemInfo, const std::vector<std::string>& layout, const Config& config,
+                       const colors_t& colors, const std::vector<std::string_view>& skip)
+{
+    Config query_config{ config };
+    // no colors, for not settling the color depth yet
+    query_config.m_disable_colors = true;
+
+    for (const std::string& line : layout)
+    {
+        size_t start = 0;
+        while ((start = line.find("$<", start)) != line.npos)
+        {
+            const size_t end = line.find('>', start);
+            if (end == line.npos)
+                break;
+
+            const std::string& tag = line.substr(start, end - start + 1);
+            if (std::none_of(skip.begin(), skip.end(),
+                             [&tag](const std::string_view module) { return hasStart(tag.substr(2), module); }))
+                parse(tag, systemInfo, query_config, colors, true);
+
+            start = end + 1;
+        }
+    }
+}
+
+void invalidate_dynamic_tags(systemInfo_t& systemInfo, const std::vector<dynamic_tag_t>& tags,
+                             const std::uint32_t interval_ms)
+{
+    std::uint8_t deps = 0;
+    for (const dynamic_tag_t& tag : tags)
+    {
+        deps |= tag.deps;
+        if (const auto& it = systemInfo.find(tag.module); it != systemInfo.end())
+            it->second.erase(tag.member);
+    }
+
+    if (deps & DEP_SYSTEM)
+        Query::System::invalidate();
+    if (deps & DEP_CPU)
+        Query::CPU::invalidate();
+    if (deps & DEP_RAM)
+        Query::RAM::invalidate();
+    if (deps & DEP_DISK)
+        Query::Disk::invalidate();
+
+    // no waiting at the next parse(), the interval has passed by then
+    if (deps & DEP_SAMPLER)
+    {
+        Query::Sampler::invalidate();
+        Query::Sampler::start(std::min<std::uint32_t>(interval_ms, UINT16_MAX));
+    }
+}
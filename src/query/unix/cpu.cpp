@@ -1,11 +1,18 @@
 #include <sys/types.h>
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <utility>
+#include <vector>
 
+#include "arm_cpu_ids.hpp"
 #include "fmt/format.h"
 #include "query.hpp"
+#include "switch_fnv1a.hpp"
 #include "util.hpp"
 
 using namespace Query;
@@ -17,6 +24,96 @@ static std::string get_from_text(std::string& line)
     return amount;
 }
 
+// https://github.com/devicetree-org/devicetree-specification vendor prefixes
+// only the ones that ship SoCs in SBCs/phones/servers people actually use
+static std::string prettify_soc_vendor(const std::string_view vendor)
+{
+    switch (fnv1a16::hash(vendor.data()))
+    {
+        case "brcm"_fnv1a16:      return "Broadcom";
+        case "qcom"_fnv1a16:      return "Qualcomm";
+        case "rockchip"_fnv1a16:  return "Rockchip";
+        case "allwinner"_fnv1a16: return "Allwinner";
+        case "amlogic"_fnv1a16:   return "Amlogic";
+        case "mediatek"_fnv1a16:  return "MediaTek";
+        case "nvidia"_fnv1a16:    return "NVIDIA";
+        case "samsung"_fnv1a16:   return "Samsung";
+        case "fsl"_fnv1a16:
+        case "nxp"_fnv1a16:       return "NXP";
+        case "ti"_fnv1a16:        return "Texas Instruments";
+        case "apple"_fnv1a16:     return "Apple";
+        case "hisilicon"_fnv1a16: return "HiSilicon";
+        case "sophgo"_fnv1a16:    return "Sophgo";
+        case "starfive"_fnv1a16:  return "StarFive";
+    }
+
+    return vendor.data();
+}
+
+/* Get the SoC name from the device tree "compatible" property.
+ * It's a list of NUL separated strings "raspberrypi,4-model-b\0brcm,bcm2711\0"
+ * where the last one is the SoC
+ */
+static std::string get_devicetree_soc()
+{
+    constexpr std::array<std::string_view, 2> paths = { "/proc/device-tree/compatible",
+                                                        "/sys/firmware/devicetree/base/compatible" };
+    for (const std::string_view path : paths)
+    {
+        std::ifstream f(path.data(), std::ios::binary);
+        if (!f.is_open())
+            continue;
+
+        std::string compatible((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+        while (!compatible.empty() && compatible.back() == '\0')
+            compatible.pop_back();
+
+        if (compatible.empty())
+            continue;
+
+        size_t pos = compatible.rfind('\0');
+        if (pos != std::string::npos)
+            compatible.erase(0, pos + 1);
+
+        // brcm,bcm2711 -> Broadcom BCM2711
+        if ((pos = compatible.find(',')) != std::string::npos)
+            return prettify_soc_vendor(compatible.substr(0, pos)) + ' ' + str_toupper(compatible.substr(pos + 1));
+
+        return compatible;
+    }
+
+    return UNKNOWN;
+}
+
+/* Get the CPU name from the "CPU implementer" and "CPU part" pairs in /proc/cpuinfo
+ * e.g "ARM Cortex-A72" or on big.LITTLE "ARM Cortex-A76 + Cortex-A55"
+ */
+static std::string get_arm_cpu_name(const std::vector<std::pair<std::uint32_t, std::uint32_t>>& midrs)
+{
+    std::string ret;
+    std::string_view last_vendor;
+    for (const auto& [implementer, part] : midrs)
+    {
+        const arm_cpu_part_t& cpu_part = arm_cpu_lookup(implementer, part);
+        if (cpu_part.name.empty())
+            continue;
+
+        if (!ret.empty())
+            ret += " + ";
+
+        if (cpu_part.vendor != last_vendor)
+        {
+            ret += cpu_part.vendor;
+            ret += ' ';
+            last_vendor = cpu_part.vendor;
+        }
+
+        ret += cpu_part.name;
+    }
+
+    return ret.empty() ? UNKNOWN : ret;
+}
+
 static CPU::CPU_t get_cpu_infos()
 {
     CPU::CPU_t ret;
@@ -29,13 +126,31 @@ static CPU::CPU_t get_cpu_infos()
         return ret;
     }
 
-    std::string line;
+    std::string line, hardware;
     float       cpu_mhz = -1;
+
+    // aarch64 doesn't have "model name", only the MIDR values for each core
+    std::uint32_t implementer = 0;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> midrs;
     while (std::getline(file, line))
     {
         if (hasStart(line, "model name"))
             ret.name = get_from_text(line);
 
+        else if (hasStart(line, "Hardware"))
+            hardware = get_from_text(line);
+
+        else if (hasStart(line, "CPU implementer"))
+            implementer = std::stoul(get_from_text(line), nullptr, 16);
+
+        else if (hasStart(line, "CPU part"))
+        {
+            const std::pair<std::uint32_t, std::uint32_t> midr = { implementer,
+                                                                   std::stoul(get_from_text(line), nullptr, 16) };
+            if (std::find(midrs.begin(), midrs.end(), midr) == midrs.end())
+                midrs.push_back(midr);
+        }
+
         if (hasStart(line, "processor"))
             ret.nproc = get_from_text(line);
 
@@ -47,6 +162,12 @@ static CPU::CPU_t get_cpu_infos()
         }
     }
 
+    if (ret.name == UNKNOWN && !midrs.empty())
+        ret.name = get_arm_cpu_name(midrs);
+
+    if (ret.name == UNKNOWN)
+        ret.name = hardware.empty() ? get_devicetree_soc() : hardware;
+
     // sometimes /proc/cpuinfo at model name
     // the name will contain the min freq
     // happens on intel cpus especially
@@ -93,6 +214,9 @@ CPU::CPU() noexcept
     }
 }
 
+void CPU::invalidate() noexcept
+{ m_bInit = false; }
+
 std::string& CPU::name() noexcept
 { return m_cpu_infos.name; }
 
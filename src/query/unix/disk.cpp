@@ -1,83 +1,293 @@
-#include <mntent.h>
+#include <sys/statvfs.h>
+
 #include <algorithm>
-#include <cstdio>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
 
 #include "query.hpp"
 #include "util.hpp"
 
 using namespace Query;
 
-Disk::Disk(const std::string_view path, std::vector<std::string>& paths)
+struct mount_index_t
 {
-    if (std::find(paths.begin(), paths.end(), path) == paths.end())
-        paths.push_back(path.data());
-    else
-        return;
+    std::vector<Disk::mount_t>              mounts;
+    std::unordered_map<std::string, size_t> by_mountdir;
+    std::unordered_map<std::string, size_t> by_device;
+};
 
-    if (!std::filesystem::exists(path))
+struct statvfs_result_t
+{
+    struct statvfs buf;
+    int            err = 0;
+};
+
+// "/mnt/my\040disk" -> "/mnt/my disk"
+static std::string unescape_octal(const std::string_view str)
+{
+    std::string ret;
+    ret.reserve(str.length());
+    for (size_t i = 0; i < str.length(); ++i)
     {
-        // if user is using disk.disk or disk.fs
-        // then let's just "try" to remove it
-        m_disk_infos.typefs = MAGIC_LINE;
-        m_disk_infos.device = MAGIC_LINE;
-        m_disk_infos.mountdir = MAGIC_LINE;
+        if (str[i] == '\\' && i + 3 < str.length() && std::isdigit(str[i + 1]))
+        {
+            ret += static_cast<char>(std::stoi(std::string(str.substr(i + 1, 3)), nullptr, 8));
+            i += 3;
+        }
+        else
+            ret += str[i];
+    }
+
+    return ret;
+}
+
+// https://www.kernel.org/doc/html/latest/filesystems/proc.html#proc-pid-mountinfo-information-about-mounts
+// parsed only once, then every disk() and disks lookup is just a hash table lookup
+static const mount_index_t& get_mount_index()
+{
+    static mount_index_t index;
+    static bool          done = false;
+    if (done)
+        return index;
+
+    done = true;
+    debug("calling in Disk {}", __PRETTY_FUNCTION__);
+    std::ifstream f("/proc/self/mountinfo");
+    if (!f.is_open())
+    {
+        error("Could not open /proc/self/mountinfo\nFailed to get disk info");
+        return index;
+    }
+
+    // 36 35 98:0 /mnt1 /mnt2 rw,noatime master:1 - ext3 /dev/root rw,errors=continue
+    std::string line, field;
+    while (std::getline(f, line))
+    {
+        std::istringstream ss(line);
+        Disk::mount_t      mount;
+        std::string        id, parent_id, dev_id;
+        ss >> id >> parent_id >> dev_id >> mount.root >> mount.mountdir;
+
+        // skip the mount options and optional fields until the separator
+        while (ss >> field && field != "-")
+            ;
+
+        ss >> mount.typefs >> mount.device;
+        if (mount.mountdir.empty() || mount.typefs.empty())
+            continue;
+
+        mount.root     = unescape_octal(mount.root);
+        mount.mountdir = unescape_octal(mount.mountdir);
+        mount.device   = unescape_octal(mount.device);
+
+        const size_t i = index.mounts.size();
+        index.mounts.push_back(mount);
+
+        // later mounts on the same directory hide the previous ones
+        index.by_mountdir[mount.mountdir] = i;
+
+        // prefer the first mount of the device with the whole filesystem, not bind mounts
+        const auto& it = index.by_device.find(mount.device);
+        if (it == index.by_device.end() || (index.mounts.at(it->second).root != "/" && mount.root == "/"))
+            index.by_device[mount.device] = i;
+    }
+
+    return index;
+}
+
+// returns nullptr if the path doesn't belong to any mount
+static const Disk::mount_t* find_mount(const std::string& path)
+{
+    const mount_index_t& index = get_mount_index();
+
+    if (const auto& it = index.by_device.find(path); it != index.by_device.end())
+        return &index.mounts.at(it->second);
+
+    if (const auto& it = index.by_mountdir.find(path); it != index.by_mountdir.end())
+        return &index.mounts.at(it->second);
+
+    std::error_code             ec;
+    const std::filesystem::path canon = std::filesystem::canonical(path, ec);
+    if (ec)
+        return nullptr;
+
+    // e.g /dev/disk/by-uuid/<uuid> -> /dev/sda2
+    if (const auto& it = index.by_device.find(canon.string()); it != index.by_device.end())
+        return &index.mounts.at(it->second);
+
+    // a path inside a mount (e.g /home/user on the root filesystem)
+    for (std::filesystem::path p = canon;; p = p.parent_path())
+    {
+        if (const auto& it = index.by_mountdir.find(p.string()); it != index.by_mountdir.end())
+            return &index.mounts.at(it->second);
+
+        if (p == p.root_path())
+            break;
+    }
+
+    return nullptr;
+}
+
+// statvfs() can block forever on a hung NFS or CIFS mount,
+// so it runs on a detached thread and the caller waits only until its deadline.
+// If it ever returns, the result just gets discarded.
+static std::future<statvfs_result_t> async_statvfs(const std::string& path)
+{
+    std::packaged_task<statvfs_result_t()> task([path]() {
+        statvfs_result_t ret;
+        if (statvfs(path.c_str(), &ret.buf) != 0)
+            ret.err = errno;
+        return ret;
+    });
+
+    std::future<statvfs_result_t> future = task.get_future();
+    std::thread(std::move(task)).detach();
+    return future;
+}
+
+static void get_disk_amounts(Disk::Disk_t& disk, std::future<statvfs_result_t>& future,
+                             const std::chrono::steady_clock::time_point deadline)
+{
+    if (future.wait_until(deadline) != std::future_status::ready)
+    {
+        warn("statvfs() on '{}' timed out, marking the mount as stale", disk.mountdir);
+        disk.stale = true;
         return;
     }
 
-    FILE* mountsFile = setmntent("/proc/mounts", "r");
-    if (mountsFile == NULL)
+    const statvfs_result_t& result = future.get();
+    if (result.err != 0)
     {
-        perror("setmntent");
-        error("setmntent() failed. Could not get disk info");
+        error("statvfs() on '{}' failed: {}\nFailed to get disk info", disk.mountdir, strerror(result.err));
         return;
     }
 
-    struct mntent* pDevice;
-    while ((pDevice = getmntent(mountsFile)))
+    disk.total_amount = static_cast<double>(result.buf.f_blocks * result.buf.f_frsize);
+    disk.free_amount  = static_cast<double>(result.buf.f_bfree * result.buf.f_frsize);
+    disk.used_amount  = disk.total_amount - disk.free_amount;
+}
+
+static Disk::Disk_t make_disk(const Disk::mount_t& mount)
+{
+    Disk::Disk_t ret;
+    ret.typefs   = mount.typefs;
+    ret.device   = mount.device;
+    ret.mountdir = mount.mountdir;
+    return ret;
+}
+
+// anything that is not a block device or a network filesystem (proc, tmpfs, cgroup, ...)
+// squashfs too, because those are just snaps and appimages loop devices
+static bool is_real_fs(const Disk::mount_t& mount)
+{
+    constexpr std::array<std::string_view, 6> network_fs = { "nfs", "nfs4", "cifs", "smb3", "smbfs", "fuse.sshfs" };
+    if (std::find(network_fs.begin(), network_fs.end(), mount.typefs) != network_fs.end())
+        return true;
+
+    return hasStart(mount.device, "/dev/") && mount.typefs != "squashfs";
+}
+
+Disk::Disk(const std::string& path, const std::uint16_t timeout_ms)
+{
+    const mount_t* mount = find_mount(path);
+    if (!mount)
     {
-        debug("pDevice->mnt_dir = {} && pDevice->mnt_fsname = {}", pDevice->mnt_dir, pDevice->mnt_fsname);
-        if (path == pDevice->mnt_dir || path == pDevice->mnt_fsname)
-        {
-            m_disk_infos.typefs   = pDevice->mnt_type;
-            m_disk_infos.device   = pDevice->mnt_fsname;
-            m_disk_infos.mountdir = pDevice->mnt_dir;
-            break;
-        }
+        // if user is using disk.disk or disk.fs
+        // then let's just "try" to remove it
+        m_pDisk           = &m_disks_infos[path];
+        m_pDisk->typefs   = MAGIC_LINE;
+        m_pDisk->device   = MAGIC_LINE;
+        m_pDisk->mountdir = MAGIC_LINE;
+        return;
     }
 
-    const std::string_view statpath = (hasStart(path, "/dev") ? pDevice->mnt_dir : path);
+    debug("disk path '{}' is on mount '{}' ({})", path, mount->mountdir, mount->device);
 
-    if (statvfs(statpath.data(), &m_statvfs) != 0)
+    // keyed by mountpoint, so disk(/) and disk(/dev/sda2) share the same result
+    const auto& it = m_disks_infos.find(mount->mountdir);
+    if (it != m_disks_infos.end())
     {
-        perror("statvfs");
-        error("Failed to get disk info");
+        m_pDisk = &it->second;
         return;
     }
 
-    m_disk_infos.total_amount = static_cast<double>(m_statvfs.f_blocks * m_statvfs.f_frsize);    
-    m_disk_infos.free_amount  = static_cast<double>(m_statvfs.f_bfree  * m_statvfs.f_frsize);    
-    m_disk_infos.used_amount  = m_disk_infos.total_amount - m_disk_infos.free_amount;
+    m_pDisk = &m_disks_infos.emplace(mount->mountdir, make_disk(*mount)).first->second;
+
+    std::future<statvfs_result_t> future = async_statvfs(mount->mountdir);
+    get_disk_amounts(*m_pDisk, future, std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms));
+}
+
+void Disk::invalidate() noexcept
+{
+    // m_all_disks points into m_disks_infos
+    m_all_disks.clear();
+    m_disks_infos.clear();
+    m_bAllInit = false;
+}
+
+std::vector<Disk::Disk_t*>& Disk::all_disks(const std::uint16_t timeout_ms)
+{
+    if (m_bAllInit)
+        return m_all_disks;
+
+    m_bAllInit = true;
+
+    std::vector<std::future<statvfs_result_t>> futures;
+    std::unordered_set<std::string>            seen_devices;
+    for (const mount_t& mount : get_mount_index().mounts)
+    {
+        // bind mounts and btrfs subvolumes would be just duplicates
+        if (!is_real_fs(mount) || !seen_devices.insert(mount.device).second)
+            continue;
+
+        const auto& [it, inserted] = m_disks_infos.emplace(mount.mountdir, make_disk(mount));
+        m_all_disks.push_back(&it->second);
+        futures.push_back(inserted ? async_statvfs(mount.mountdir) : std::future<statvfs_result_t>{});
+    }
+
+    // all the mounts get queried at the same time, and share the same deadline
+    const auto& deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    for (size_t i = 0; i < futures.size(); ++i)
+    {
+        if (futures.at(i).valid())
+            get_disk_amounts(*m_all_disks.at(i), futures.at(i), deadline);
+    }
 
-    endmntent(mountsFile);
+    // failed mounts (e.g permission denied) are useless in the list,
+    // stale ones are kept so the user knows something is wrong
+    m_all_disks.erase(std::remove_if(m_all_disks.begin(), m_all_disks.end(),
+                                     [](const Disk_t* disk) { return !disk->stale && disk->total_amount == 0; }),
+                      m_all_disks.end());
 
+    return m_all_disks;
 }
 
 // clang-format off
 double& Disk::total_amount() noexcept
-{ return m_disk_infos.total_amount; }
+{ return m_pDisk->total_amount; }
 
-double& Disk::used_amount() noexcept 
-{ return m_disk_infos.used_amount; }
+double& Disk::used_amount() noexcept
+{ return m_pDisk->used_amount; }
 
 double& Disk::free_amount() noexcept
-{ return m_disk_infos.free_amount; }
+{ return m_pDisk->free_amount; }
 
 std::string& Disk::typefs() noexcept
-{ return m_disk_infos.typefs; }
+{ return m_pDisk->typefs; }
 
 std::string& Disk::mountdir() noexcept
-{ return m_disk_infos.mountdir; }
+{ return m_pDisk->mountdir; }
 
 std::string& Disk::device() noexcept
-{ return m_disk_infos.device; }
+{ return m_pDisk->device; }
+
+bool& Disk::stale() noexcept
+{ return m_pDisk->stale; }
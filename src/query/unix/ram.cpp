@@ -1,77 +1,86 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <array>
+#include <charconv>
+#include <filesystem>
 #include <fstream>
+#include <string_view>
 
 #include "query.hpp"
+#include "switch_fnv1a.hpp"
 #include "util.hpp"
 
 using namespace Query;
 
-/*enum {
-    SHMEM = 0,
-    FREE,
-    BUFFER,
-    CACHED,
-    SRECLAIMABLE
-};*/
-
-static size_t get_from_text(std::string& line, u_short& iter_index, const std::uint16_t len)
-{
-    std::string amount = line.substr(len + 1);
-    strip(amount);
-    ++iter_index;
-    return std::stoi(amount);
-}
-
+// https://www.kernel.org/doc/html/latest/filesystems/proc.html#meminfo
 static RAM::RAM_t get_amount() noexcept
 {
     debug("calling in RAM {}", __PRETTY_FUNCTION__);
     constexpr std::string_view meminfo_path = "/proc/meminfo";
     RAM::RAM_t                 memory_infos;
 
-    // std::array<size_t, 5> extra_mem_info;
-    std::ifstream file(meminfo_path.data());
-    if (!file.is_open())
+    // the whole file is less than 2KiB,
+    // so read it at once instead of going line by line with a stream
+    std::array<char, 8192> buf;
+    const int              fd = open(meminfo_path.data(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
     {
         error("Could not open {}\nFailed to get RAM infos", meminfo_path);
         return memory_infos;
     }
 
-    std::string    line;
-    static u_short iter_index = 0;
-    while (std::getline(file, line) && iter_index < 4)
+    const ssize_t len = read(fd, buf.data(), buf.size());
+    close(fd);
+    if (len <= 0)
     {
-        if (hasStart(line, "MemAvailable:"))
-            memory_infos.free_amount = get_from_text(line, iter_index, "MemAvailable:"_len);
-
-        else if (hasStart(line, "MemTotal:"))
-            memory_infos.total_amount = get_from_text(line, iter_index, "MemTotal:"_len);
-
-        else if (hasStart(line, "SwapFree:"))
-            memory_infos.swap_free_amount = get_from_text(line, iter_index, "SwapFree:"_len);
-
-        else if (hasStart(line, "SwapTotal:"))
-            memory_infos.swap_total_amount = get_from_text(line, iter_index, "SwapTotal:"_len);
-
-        /*if (line.find("Shmem:") != std::string::npos)
-            extra_mem_info.at(SHMEM) = get_from_text(line);
-
-        if (line.find("MemFree:") != std::string::npos)
-            extra_mem_info.at(FREE) = get_from_text(line);
-
-        if (line.find("Buffers:") != std::string::npos)
-            extra_mem_info.at(BUFFER) = get_from_text(line);
-
-        if (line.find("Cached:") != std::string::npos)
-            extra_mem_info.at(CACHED) = get_from_text(line);
+        error("Could not read {}\nFailed to get RAM infos", meminfo_path);
+        return memory_infos;
+    }
 
-        if (line.find("SReclaimable:") != std::string::npos)
-            extra_mem_info.at(SRECLAIMABLE)  = get_from_text(line);*/
+    // "MemTotal:       16318180 kB"
+    const std::string_view meminfo(buf.data(), len);
+    for (size_t start = 0, end; start < meminfo.length(); start = end + 1)
+    {
+        end = meminfo.find('\n', start);
+        if (end == std::string_view::npos)
+            end = meminfo.length();
+
+        const std::string_view line  = meminfo.substr(start, end - start);
+        const size_t           colon = line.find(':');
+        if (colon == std::string_view::npos)
+            continue;
+
+        size_t first = line.find_first_not_of(' ', colon + 1);
+        if (first == std::string_view::npos)
+            continue;
+
+        size_t amount = 0;
+        std::from_chars(line.data() + first, line.data() + line.length(), amount);
+
+        // 32 bits, there are ~60 keys in meminfo and 16 bits hashes could collide between them
+        switch (fnv1a32::hash(line.substr(0, colon)))
+        {
+            case "MemTotal"_fnv1a32:        memory_infos.total_amount      = amount; break;
+            case "MemAvailable"_fnv1a32:    memory_infos.free_amount       = amount; break;
+            case "SwapTotal"_fnv1a32:       memory_infos.swap_total_amount = amount; break;
+            case "SwapFree"_fnv1a32:        memory_infos.swap_free_amount  = amount; break;
+            case "Cached"_fnv1a32:          memory_infos.cached_amount     = amount; break;
+            case "Buffers"_fnv1a32:         memory_infos.buffers_amount    = amount; break;
+            case "Shmem"_fnv1a32:           memory_infos.shmem_amount      = amount; break;
+            case "Dirty"_fnv1a32:           memory_infos.dirty_amount      = amount; break;
+            case "Writeback"_fnv1a32:       memory_infos.writeback_amount  = amount; break;
+            case "Zswap"_fnv1a32:           memory_infos.zswap_amount      = amount; break;
+            case "Zswapped"_fnv1a32:        memory_infos.zswapped_amount   = amount; break;
+            case "Hugetlb"_fnv1a32:         memory_infos.hugetlb_amount    = amount; break;
+            case "Hugepagesize"_fnv1a32:    memory_infos.hugepage_size     = amount; break;
+            case "HugePages_Total"_fnv1a32: memory_infos.hugepages_total   = amount; break;
+            case "HugePages_Free"_fnv1a32:  memory_infos.hugepages_free    = amount; break;
+        }
     }
 
     // https://github.com/dylanaraps/neofetch/wiki/Frequently-Asked-Questions#linux-is-neofetchs-memory-output-correct
-    memory_infos.used_amount =
-        memory_infos.total_amount -
-        memory_infos.free_amount;  // + extra_mem_info.at(SHMEM) - extra_mem_info.at(FREE) - extra_mem_info.at(BUFFER) -
-                                   // extra_mem_info.at(CACHED) - extra_mem_info.at(SRECLAIMABLE);
+    memory_infos.used_amount = memory_infos.total_amount - memory_infos.free_amount;
 
     memory_infos.swap_used_amount =
         memory_infos.swap_total_amount -
@@ -80,6 +89,50 @@ static RAM::RAM_t get_amount() noexcept
     return memory_infos;
 }
 
+// https://www.kernel.org/doc/html/latest/accounting/psi.html
+// some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+// full avg10=0.00 avg60=0.00 avg300=0.00 total=0
+static void get_pressure(RAM::RAM_t& memory_infos)
+{
+    debug("calling in RAM {}", __PRETTY_FUNCTION__);
+    std::ifstream f("/proc/pressure/memory");
+    if (!f.is_open())
+    {
+        // kernel without CONFIG_PSI, or disabled with psi=0
+        debug("Could not open /proc/pressure/memory");
+        return;
+    }
+
+    std::string line;
+    while (std::getline(f, line))
+    {
+        const size_t pos = line.find("avg10=");
+        if (pos == std::string::npos)
+            continue;
+
+        const double avg10 = std::stod(line.substr(pos + "avg10="_len));
+        if (hasStart(line, "some"))
+            memory_infos.pressure_some = avg10;
+        else if (hasStart(line, "full"))
+            memory_infos.pressure_full = avg10;
+    }
+}
+
+// https://www.kernel.org/doc/html/latest/admin-guide/blockdev/zram.html#stats
+// orig_data_size compr_data_size mem_used_total mem_limit mem_used_max same_pages pages_compacted huge_pages
+static void get_zram_stat(const std::string& name, RAM::zram_t& zram)
+{
+    std::ifstream f("/sys/block/" + name + "/mm_stat");
+    if (!f.is_open())
+        return;
+
+    f >> zram.orig_amount >> zram.compr_amount >> zram.used_amount;
+
+    std::ifstream f_disksize("/sys/block/" + name + "/disksize");
+    f_disksize >> zram.total_amount;
+    zram.exists = true;
+}
+
 RAM::RAM() noexcept
 {
     if (!m_bInit)
@@ -89,6 +142,66 @@ RAM::RAM() noexcept
     }
 }
 
+void RAM::invalidate() noexcept
+{
+    m_bInit         = false;
+    m_bPressureInit = false;
+    m_zram_infos.clear();
+}
+
+RAM::zram_t& RAM::zram(const std::string& name)
+{
+    const auto& it = m_zram_infos.find(name);
+    if (it != m_zram_infos.end())
+        return it->second;
+
+    zram_t& zram = m_zram_infos[name];
+    if (!name.empty())
+    {
+        get_zram_stat(name, zram);
+        return zram;
+    }
+
+    // all the zram devices together
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/block", ec))
+    {
+        const std::string& devname = entry.path().filename().string();
+        if (!hasStart(devname, "zram"))
+            continue;
+
+        zram_t dev;
+        get_zram_stat(devname, dev);
+        if (!dev.exists)
+            continue;
+
+        zram.orig_amount  += dev.orig_amount;
+        zram.compr_amount += dev.compr_amount;
+        zram.used_amount  += dev.used_amount;
+        zram.total_amount += dev.total_amount;
+        zram.exists = true;
+    }
+
+    return zram;
+}
+
+double& RAM::pressure_some()
+{
+    if (!m_bPressureInit)
+    {
+        get_pressure(m_memory_infos);
+        m_bPressureInit = true;
+    }
+
+    return m_memory_infos.pressure_some;
+}
+
+double& RAM::pressure_full()
+{
+    pressure_some();
+    return m_memory_infos.pressure_full;
+}
+
 // clang-format off
 double& RAM::free_amount() noexcept
 { return m_memory_infos.free_amount; }
@@ -107,3 +220,36 @@ double& RAM::swap_used_amount() noexcept
 
 double& RAM::swap_free_amount() noexcept
 { return m_memory_infos.swap_free_amount; }
+
+double& RAM::cached_amount() noexcept
+{ return m_memory_infos.cached_amount; }
+
+double& RAM::buffers_amount() noexcept
+{ return m_memory_infos.buffers_amount; }
+
+double& RAM::shmem_amount() noexcept
+{ return m_memory_infos.shmem_amount; }
+
+double& RAM::dirty_amount() noexcept
+{ return m_memory_infos.dirty_amount; }
+
+double& RAM::writeback_amount() noexcept
+{ return m_memory_infos.writeback_amount; }
+
+double& RAM::zswap_amount() noexcept
+{ return m_memory_infos.zswap_amount; }
+
+double& RAM::zswapped_amount() noexcept
+{ return m_memory_infos.zswapped_amount; }
+
+double& RAM::hugetlb_amount() noexcept
+{ return m_memory_infos.hugetlb_amount; }
+
+double& RAM::hugepage_size() noexcept
+{ return m_memory_infos.hugepage_size; }
+
+size_t& RAM::hugepages_total() noexcept
+{ return m_memory_infos.hugepages_total; }
+
+size_t& RAM::hugepages_free() noexcept
+{ return m_memory_infos.hugepages_free; }
@@ -0,0 +1,220 @@
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "query.hpp"
+#include "util.hpp"
+
+using namespace Query;
+
+// https://www.kernel.org/doc/html/latest/filesystems/proc.html#miscellaneous-kernel-statistics-in-proc-stat
+static void get_cpu_stat(Sampler::cpu_stat_t& cpu)
+{
+    std::ifstream f("/proc/stat");
+    if (!f.is_open())
+    {
+        error("Could not open /proc/stat\nFailed to sample CPU usage");
+        return;
+    }
+
+    // cpu  user nice system idle iowait irq softirq steal guest guest_nice
+    std::string cpu_label;
+    std::array<size_t, 8> times{};
+    f >> cpu_label;
+    for (size_t& time : times)
+        f >> time;
+
+    // guest and guest_nice are already accounted in user and nice
+    cpu.idle  = times.at(3) + times.at(4);
+    cpu.total = 0;
+    for (const size_t time : times)
+        cpu.total += time;
+}
+
+// https://www.kernel.org/doc/Documentation/ABI/testing/procfs-diskstats
+static void get_disk_stats(std::unordered_map<std::string, Sampler::io_stat_t>& disks)
+{
+    std::ifstream f("/proc/diskstats");
+    if (!f.is_open())
+    {
+        error("Could not open /proc/diskstats\nFailed to sample disk I/O");
+        return;
+    }
+
+    std::string line, name;
+    size_t      major, minor, reads, reads_merged, sectors_read, ms_reading, writes, writes_merged, sectors_written;
+    while (std::getline(f, line))
+    {
+        std::istringstream ss(line);
+        ss >> major >> minor >> name >> reads >> reads_merged >> sectors_read >> ms_reading >> writes >> writes_merged >>
+            sectors_written;
+
+        // sectors here are always 512 bytes, no matter the real sector size of the device
+        disks[name] = { sectors_read * 512, sectors_written * 512 };
+    }
+}
+
+// https://www.kernel.org/doc/html/latest/networking/statistics.html#procfs
+static void get_net_stats(std::unordered_map<std::string, Sampler::io_stat_t>& nets)
+{
+    std::ifstream f("/proc/net/dev");
+    if (!f.is_open())
+    {
+        error("Could not open /proc/net/dev\nFailed to sample network throughput");
+        return;
+    }
+
+    std::string line;
+
+    // skip the 2 header lines
+    std::getline(f, line);
+    std::getline(f, line);
+
+    // "  eth0: rx_bytes packets errs drop fifo frame compressed multicast tx_bytes ..."
+    size_t rx_bytes, tx_bytes, skip;
+    while (std::getline(f, line))
+    {
+        const size_t colon = line.find(':');
+        if (colon == std::string::npos)
+            continue;
+
+        std::string iface = line.substr(0, colon);
+        strip(iface);
+
+        std::istringstream ss(line.substr(colon + 1));
+        ss >> rx_bytes;
+        for (int i = 0; i < 7; ++i)
+            ss >> skip;
+        ss >> tx_bytes;
+
+        nets[iface] = { rx_bytes, tx_bytes };
+    }
+}
+
+static Sampler::Sample_t take_sample()
+{
+    debug("calling in Sampler {}", __PRETTY_FUNCTION__);
+    Sampler::Sample_t ret;
+    get_cpu_stat(ret.cpu);
+    get_disk_stats(ret.disks);
+    get_net_stats(ret.nets);
+    ret.time = std::chrono::steady_clock::now();
+
+    return ret;
+}
+
+void Sampler::start(const std::uint16_t interval_ms)
+{
+    if (m_bStarted)
+        return;
+
+    m_interval = std::chrono::milliseconds(interval_ms);
+    m_first    = take_sample();
+    m_bStarted = true;
+}
+
+void Sampler::invalidate() noexcept
+{
+    m_bInit    = false;
+    m_bStarted = false;
+}
+
+Sampler::Sampler(const std::uint16_t interval_ms)
+{
+    if (!m_bInit)
+    {
+        // nobody started the sampler at render start (e.g the tag is inside a nested tag)
+        // so we have no choice but waiting the whole interval
+        start(interval_ms);
+
+        // only wait what's remaining of the interval,
+        // the rest of the time has already been spent on the other queries
+        std::this_thread::sleep_until(m_first.time + m_interval);
+        m_second = take_sample();
+        m_bInit  = true;
+    }
+}
+
+// returns the difference of bytes per second between the 2 samples
+static double get_rate(const std::unordered_map<std::string, Sampler::io_stat_t>& first,
+                       const std::unordered_map<std::string, Sampler::io_stat_t>& second, const std::string& name,
+                       const double seconds, const bool write)
+{
+    const auto& it_first  = first.find(name);
+    const auto& it_second = second.find(name);
+    if (it_first == first.end() || it_second == second.end() || seconds <= 0)
+        return 0;
+
+    const size_t bytes_first  = write ? it_first->second.write : it_first->second.read;
+    const size_t bytes_second = write ? it_second->second.write : it_second->second.read;
+
+    // counters may have been resetted (e.g interface went down)
+    if (bytes_second < bytes_first)
+        return 0;
+
+    return static_cast<double>(bytes_second - bytes_first) / seconds;
+}
+
+// /dev/sda2 -> sda2, /dev/mapper/root -> dm-0
+static std::string get_diskstats_name(const std::string_view device)
+{
+    std::error_code              ec;
+    const std::filesystem::path& path = std::filesystem::canonical(device, ec);
+    if (ec)
+        return std::filesystem::path(device).filename().string();
+
+    return path.filename().string();
+}
+
+double Sampler::seconds() noexcept
+{ return std::chrono::duration<double>(m_second.time - m_first.time).count(); }
+
+double Sampler::cpu_usage() noexcept
+{
+    const size_t total = m_second.cpu.total - m_first.cpu.total;
+    const size_t idle  = m_second.cpu.idle - m_first.cpu.idle;
+    if (total == 0)
+        return 0;
+
+    return static_cast<double>(total - idle) / static_cast<double>(total) * 100;
+}
+
+double Sampler::disk_read_rate(const std::string_view device)
+{ return get_rate(m_first.disks, m_second.disks, get_diskstats_name(device), seconds(), false); }
+
+double Sampler::disk_write_rate(const std::string_view device)
+{ return get_rate(m_first.disks, m_second.disks, get_diskstats_name(device), seconds(), true); }
+
+double Sampler::net_rx_rate(const std::string& iface)
+{
+    if (!iface.empty())
+        return get_rate(m_first.nets, m_second.nets, iface, seconds(), false);
+
+    // all the interfaces, except loopback
+    double ret = 0;
+    for (const auto& [name, _] : m_second.nets)
+        if (name != "lo")
+            ret += get_rate(m_first.nets, m_second.nets, name, seconds(), false);
+
+    return ret;
+}
+
+double Sampler::net_tx_rate(const std::string& iface)
+{
+    if (!iface.empty())
+        return get_rate(m_first.nets, m_second.nets, iface, seconds(), true);
+
+    double ret = 0;
+    for (const auto& [name, _] : m_second.nets)
+        if (name != "lo")
+            ret += get_rate(m_first.nets, m_second.nets, name, seconds(), true);
+
+    return ret;
+}
+
+bool Sampler::has_net_iface(const std::string& iface) noexcept
+{ return iface.empty() || m_second.nets.find(iface) != m_second.nets.end(); }
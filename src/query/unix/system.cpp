@@ -143,9 +143,6 @@ System::System()
         if (uname(&m_uname_infos) != 0)
             die("uname() failed: {}\nCould not get system infos", strerror(errno));
 
-        if (sysinfo(&m_sysInfos) != 0)
-            die("sysinfo() failed: {}\nCould not get system infos", strerror(errno));
-
         m_system_infos = get_system_infos_os_releases();
         if (m_system_infos.os_name == UNKNOWN || m_system_infos.os_pretty_name == UNKNOWN)
             m_system_infos = get_system_infos_lsb_releases();
@@ -153,8 +150,20 @@ System::System()
         get_host_paths(m_system_infos);
         m_bInit = true;
     }
+
+    // the uptime, the rest (e.g os-release) doesn't change while running
+    if (!m_bSysInfoInit)
+    {
+        if (sysinfo(&m_sysInfos) != 0)
+            die("sysinfo() failed: {}\nCould not get system infos", strerror(errno));
+
+        m_bSysInfoInit = true;
+    }
 }
 
+void System::invalidate() noexcept
+{ m_bSysInfoInit = false; }
+
 // clang-format off
 std::string System::kernel_name() noexcept
 { return m_uname_infos.sysname; }
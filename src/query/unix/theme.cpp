@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <cstdint>
+#include <sstream>
+#include <unordered_map>
 
 #include "config.hpp"
 #include "fmt/format.h"
@@ -8,38 +10,48 @@
 #include "rapidxml-1.13/rapidxml.hpp"
 #include "switch_fnv1a.hpp"
 #include "util.hpp"
-
-#if USE_DCONF
-#  include <client/dconf-client.h>
-#  include <glib/gvariant.h>
-#endif
+#include "utils/gvdb.hpp"
+#include "utils/ini.hpp"
 
 using namespace Query;
 
 const std::string& configDir = getHomeConfigDir();
 
+static bool is_set(const std::string_view str)
+{ return !str.empty() && str != MAGIC_LINE && str != UNKNOWN; }
+
 static bool get_xsettings_xfce4(const std::string_view property, const std::string_view subproperty, std::string& ret)
 {
     static bool done = false;
+    static bool valid = false;
+    // rapidxml parses in-situ, the buffer must live as long as the document
+    static std::string buffer;
     static rapidxml::xml_document<> doc;
 
     if (!done)
     {
+        done = true;
         const std::string& path = configDir + "/xfce4/xfconf/xfce-perchannel-xml/xsettings.xml";
         std::ifstream      f(path, std::ios::in);
         if (!f.is_open())
             return false;
 
-        std::string buffer((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+        buffer.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
         buffer.push_back('\0');
 
         doc.parse<0>(&buffer[0]);
-        done = true;
+        valid = doc.first_node("channel") != nullptr;
     }
 
+    if (!valid)
+        return false;
+
     rapidxml::xml_node<>* node1 = doc.first_node("channel")->first_node("property");
     for (; node1 && std::string_view(node1->first_attribute("name")->value()) != property; node1 = node1->next_sibling("property"));
 
+    if (!node1)
+        return false;
+
     rapidxml::xml_node<>* node2 = node1->first_node("property");
     for (; node2; node2 = node2->next_sibling())
     {
@@ -54,174 +66,171 @@ static bool get_xsettings_xfce4(const std::string_view property, const std::stri
     return false;
 }
 
-//
-//
-// 1. Cursor
-//
-static bool assert_cursor(Theme::Theme_t& theme)
+// settings.ini has its keys in the [Settings] section, gtkrc files don't have sections
+static void get_gtk_config_value(const ini_file_t& file, const std::string& key, std::string& ret)
 {
-    return
-    (theme.cursor != MAGIC_LINE && theme.cursor_size != UNKNOWN) || 
-    (!theme.cursor.empty() && !theme.cursor_size.empty());
+    if (is_set(ret))
+        return;
+
+    if (!get_ini_value(file, "Settings", key, ret))
+        get_ini_value(file, "", key, ret);
 }
 
-static bool get_cursor_xresources(Theme::Theme_t& theme)
+// every GTK config file, in order of priority
+static std::vector<std::string> get_gtk_config_paths(const std::uint8_t ver)
 {
-    const std::string& path = expandVar("~/.Xresources");
-    std::ifstream f(path, std::ios::in);
-    if (!f.is_open())
-    {
-        theme.cursor = MAGIC_LINE;
-        theme.cursor_size = UNKNOWN;
-        return false;
-    }
-
-    std::uint16_t iter_index = 0;
-    std::string line;
-    while (std::getline(f, line) && iter_index < 2)
-    {
-        if (hasStart(line, "Xcursor.theme:"))
-        {
-            getFileValue(iter_index, line, theme.cursor, "Xcursor.theme:"_len);
-            strip(theme.cursor);
-        }
-
-        else if (hasStart(line, "Xcursor.size:"))
-        {
-            getFileValue(iter_index, line, theme.cursor_size, "Xcursor.size:"_len);
-            strip(theme.cursor_size);
-        }
-    }
-
-    return assert_cursor(theme);
+    const char* home = std::getenv("HOME");
+    return {
+        fmt::format("{}/gtk-{}.0/settings.ini", configDir, ver),
+        fmt::format("{}/gtk-{}.0/gtkrc", configDir, ver),
+        fmt::format("{}/gtkrc-{}.0", configDir, ver),
+        fmt::format("{}/.gtkrc-{}.0", home, ver),
+        fmt::format("{}/.gtkrc-{}.0-kde", home, ver),
+        fmt::format("{}/.gtkrc-{}.0-kde4", home, ver),
+    };
 }
 
-static bool get_cursor_dconf(const std::string_view de_name, Theme::Theme_t& theme)
+static std::string get_dconf_interface(const std::string_view de_name)
 {
-#if USE_DCONF
-
-    LOAD_LIBRARY("libdconf.so", return false);
-    LOAD_LIB_SYMBOL(DConfClient *, dconf_client_new, void);
-    LOAD_LIB_SYMBOL(GVariant *, dconf_client_read, DConfClient *, const char *);
-    LOAD_LIB_SYMBOL(const gchar *, g_variant_get_string, GVariant *, gsize *);
-    LOAD_LIB_SYMBOL(gint32, g_variant_get_int32, GVariant *);
-
-    debug("calling {}", __PRETTY_FUNCTION__);
-    DConfClient *client = dconf_client_new();
-    GVariant *variant;
-
-    std::string interface;
     switch(fnv1a16::hash(str_tolower(de_name.data())))
     {
-        case "cinnamon"_fnv1a16: interface = "/org/cinnamon/desktop/interface/"; break;
-        case "mate"_fnv1a16: interface = "/org/mate/interface/"; break;
+        case "cinnamon"_fnv1a16: return "/org/cinnamon/desktop/interface/";
+        case "mate"_fnv1a16: return "/org/mate/interface/";
 
         case "gnome"_fnv1a16:
         case "budgie"_fnv1a16:
         case "unity"_fnv1a16:
         default:
-            interface = "/org/gnome/desktop/interface/";
+            return "/org/gnome/desktop/interface/";
     }
-
-    
-    variant = dconf_client_read(client, (interface + "cursor-theme").c_str());
-    if (variant)
-        theme.cursor = g_variant_get_string(variant, NULL);
-    
-
-    
-    variant = dconf_client_read(client, (interface + "cursor-size").c_str());
-    if (variant)
-        theme.cursor_size = fmt::to_string(g_variant_get_int32(variant));
-
-    return assert_cursor(theme);
-#else
-    return false;
-#endif
 }
 
-static bool get_cursor_gsettings(const std::string_view de_name, Theme::Theme_t& theme, const Config& config)
+static std::string get_gsettings_schema(const std::string_view de_name)
 {
-    debug("calling {}", __PRETTY_FUNCTION__);
-    if (get_cursor_dconf(de_name, theme))
-        return true;
-
-    if (config.slow_query_warnings)
-    {
-        warn("cufetch could not detect a gtk configuration file. cufetch will use the much-slower gsettings.");
-        warn("If there's a file in a standard location that we aren't detecting, please file an issue on our GitHub.");
-        info("You can disable this warning by disabling slow-query-warnings in your config.toml file.");
-    }
-
-    const char* interface;
     switch(fnv1a16::hash(str_tolower(de_name.data())))
     {
-        case "cinnamon"_fnv1a16: interface = "org.cinnamon.desktop.interface"; break;
-        case "mate"_fnv1a16: interface = "org.mate.interface"; break;
+        case "cinnamon"_fnv1a16: return "org.cinnamon.desktop.interface";
+        case "mate"_fnv1a16: return "org.mate.interface";
 
         case "gnome"_fnv1a16:
         case "budgie"_fnv1a16:
         case "unity"_fnv1a16:
         default:
-            interface = "org.gnome.desktop.interface";
+            return "org.gnome.desktop.interface";
     }
+}
+
+// gets all the keys of the schema with a single gsettings call, instead of one call per key.
+// The result is shared by every Theme instance
+static bool get_gsettings_value(const std::string& schema, const std::string& key, std::string& ret)
+{
+    static std::unordered_map<std::string, std::unordered_map<std::string, std::string>> schemas;
 
-    if (theme.cursor == MAGIC_LINE || theme.cursor.empty())
+    auto it = schemas.find(schema);
+    if (it == schemas.end())
     {
-        theme.cursor.clear();
-        read_exec({ "gsettings", "get", interface, "cursor-theme" }, theme.cursor);
-        theme.cursor.erase(std::remove(theme.cursor.begin(), theme.cursor.end(), '\''), theme.cursor.end());
+        debug("calling gsettings list-recursively {}", schema);
+        std::string output;
+        read_exec({ "gsettings", "list-recursively", schema.c_str() }, output);
+
+        it = schemas.emplace(schema, std::unordered_map<std::string, std::string>{}).first;
+
+        // "org.gnome.desktop.interface gtk-theme 'Adwaita'"
+        std::istringstream ss(output);
+        std::string        line;
+        while (std::getline(ss, line))
+        {
+            const size_t key_start = line.find(' ');
+            const size_t key_end   = line.find(' ', key_start + 1);
+            if (key_start == std::string::npos || key_end == std::string::npos)
+                continue;
+
+            std::string value = line.substr(key_end + 1);
+            if (value.length() >= 2 && (value.front() == '\'' || value.front() == '"') && value.back() == value.front())
+                value = value.substr(1, value.length() - 2);
+
+            it->second.emplace(line.substr(key_start + 1, key_end - key_start - 1), value);
+        }
     }
 
-    if (theme.cursor_size == UNKNOWN || theme.cursor_size.empty())
+    const auto& key_it = it->second.find(key);
+    if (key_it == it->second.end())
+        return false;
+
+    ret = key_it->second;
+    return true;
+}
+
+static void warn_slow_query(const Config& config)
+{
+    if (config.slow_query_warnings)
     {
-        theme.cursor_size.clear();
-        read_exec({ "gsettings", "get", interface, "cursor-size" }, theme.cursor_size);
-        theme.cursor_size.erase(std::remove(theme.cursor_size.begin(), theme.cursor_size.end(), '\''), theme.cursor_size.end());
+        warn("cufetch could not detect a gtk configuration file nor the values in the dconf database. cufetch will use the much-slower gsettings.");
+        warn("If there's a file in a standard location that we aren't detecting, please file an issue on our GitHub.");
+        info("You can disable this warning by disabling slow-query-warnings in your config.toml file.");
     }
+}
+
+//
+//
+// 1. Cursor
+//
+static bool assert_cursor(Theme::Theme_t& theme)
+{ return is_set(theme.cursor) && is_set(theme.cursor_size); }
+
+static bool get_cursor_xresources(Theme::Theme_t& theme)
+{
+    const ini_file_t& file = get_ini_file(expandVar("~/.Xresources"), ':');
+    if (!is_set(theme.cursor))
+        get_ini_value(file, "", "Xcursor.theme", theme.cursor);
+    if (!is_set(theme.cursor_size))
+        get_ini_value(file, "", "Xcursor.size", theme.cursor_size);
 
     return assert_cursor(theme);
 }
 
-static bool get_gtk_cursor_config(const std::string_view path, Theme::Theme_t& theme)
+static bool get_cursor_dconf(const std::string_view de_name, Theme::Theme_t& theme)
 {
-    std::ifstream f(path.data(), std::ios::in);
-    if (!f.is_open())
-        return false;
-
-    std::string    line;
-    std::uint16_t  iter_index = 0;
-    while (std::getline(f, line) && iter_index < 2)
-    {
-        if (hasStart(line, "gtk-cursor-theme-name="))
-            getFileValue(iter_index, line, theme.cursor, "gtk-cursor-theme-name="_len);
+    debug("calling {}", __PRETTY_FUNCTION__);
+    const std::string& interface = get_dconf_interface(de_name);
 
-        else if (hasStart(line, "gtk-cursor-theme-size="))
-            getFileValue(iter_index, line, theme.cursor_size, "gtk-cursor-theme-size="_len);
-    }
+    if (!is_set(theme.cursor))
+        dconf_read(interface + "cursor-theme", theme.cursor);
+    if (!is_set(theme.cursor_size))
+        dconf_read(interface + "cursor-size", theme.cursor_size);
 
     return assert_cursor(theme);
 }
 
-static bool get_cursor_from_gtk_configs(const std::uint8_t ver, Theme::Theme_t& theme)
+static bool get_cursor_gsettings(const std::string_view de_name, Theme::Theme_t& theme, const Config& config)
 {
-    if (get_gtk_cursor_config(fmt::format("{}/gtk-{}.0/settings.ini", configDir, ver), theme))
+    debug("calling {}", __PRETTY_FUNCTION__);
+    if (get_cursor_dconf(de_name, theme))
         return true;
 
-    if (get_gtk_cursor_config(fmt::format("{}/gtk-{}.0/gtkrc", configDir, ver), theme))
-        return true;
+    warn_slow_query(config);
+    const std::string& schema = get_gsettings_schema(de_name);
 
-    if (get_gtk_cursor_config(fmt::format("{}/gtkrc-{}.0", configDir, ver), theme))
-        return true;
+    if (!is_set(theme.cursor))
+        get_gsettings_value(schema, "cursor-theme", theme.cursor);
 
-    if (get_gtk_cursor_config(fmt::format("{}/.gtkrc-{}.0", std::getenv("HOME"), ver), theme))
-        return true;
+    if (!is_set(theme.cursor_size))
+        get_gsettings_value(schema, "cursor-size", theme.cursor_size);
 
-    if (get_gtk_cursor_config(fmt::format("{}/.gtkrc-{}.0-kde", std::getenv("HOME"), ver), theme))
-        return true;
+    return assert_cursor(theme);
+}
 
-    if (get_gtk_cursor_config(fmt::format("{}/.gtkrc-{}.0-kde4", std::getenv("HOME"), ver), theme))
-        return true;
+static bool get_cursor_from_gtk_configs(const std::uint8_t ver, Theme::Theme_t& theme)
+{
+    for (const std::string& path : get_gtk_config_paths(ver))
+    {
+        const ini_file_t& file = get_ini_file(path);
+        get_gtk_config_value(file, "gtk-cursor-theme-name", theme.cursor);
+        get_gtk_config_value(file, "gtk-cursor-theme-size", theme.cursor_size);
+
+        if (assert_cursor(theme))
+            return true;
+    }
 
     return false;
 }
@@ -241,7 +250,7 @@ static bool get_de_cursor(const std::string_view de_name, Theme::Theme_t& theme)
 
         } break;
     }
-    
+
     return false;
 }
 
@@ -250,94 +259,30 @@ static bool get_de_cursor(const std::string_view de_name, Theme::Theme_t& theme)
 // 2. GTK theme
 //
 static bool assert_gtk_theme(Theme::Theme_t& theme)
-{
-    return
-    (theme.gtk_font != MAGIC_LINE && theme.gtk_icon_theme != MAGIC_LINE && theme.gtk_theme_name != MAGIC_LINE) || 
-    (!theme.gtk_font.empty() && !theme.gtk_theme_name.empty() && !theme.gtk_icon_theme.empty());
-}
-
-static bool get_gtk_theme_config(const std::string_view path, Theme::Theme_t& theme)
-{
-    std::ifstream f(path.data(), std::ios::in);
-    if (!f.is_open())
-        return false;
-
-    std::string    line;
-    std::uint16_t  iter_index = 0;
-    while (std::getline(f, line) && iter_index < 3)
-    {
-        if (hasStart(line, "gtk-theme-name="))
-            getFileValue(iter_index, line, theme.gtk_theme_name, "gtk-theme-name="_len);
-
-        else if (hasStart(line, "gtk-icon-theme-name="))
-            getFileValue(iter_index, line, theme.gtk_icon_theme, "gtk-icon-theme-name="_len);
-
-        else if (hasStart(line, "gtk-font-name="))
-            getFileValue(iter_index, line, theme.gtk_font, "gtk-font-name="_len);
-    }
-
-    return assert_gtk_theme(theme);
-}
+{ return is_set(theme.gtk_theme_name) && is_set(theme.gtk_icon_theme) && is_set(theme.gtk_font); }
 
 static bool get_gtk_theme_dconf(const std::string_view de_name, Theme::Theme_t& theme)
 {
-#if USE_DCONF
-
-    LOAD_LIBRARY("libdconf.so", return false);
-    LOAD_LIB_SYMBOL(DConfClient *, dconf_client_new, void);
-    LOAD_LIB_SYMBOL(GVariant *, dconf_client_read, DConfClient *client, const char *);
-    LOAD_LIB_SYMBOL(const gchar *, g_variant_get_string, GVariant *value, gsize *lenght);
-
     debug("calling {}", __PRETTY_FUNCTION__);
-    DConfClient *client = dconf_client_new();
-    GVariant *variant;
+    const std::string& interface = get_dconf_interface(de_name);
 
-    std::string interface;
-    switch(fnv1a16::hash(str_tolower(de_name.data())))
-    {
-        case "cinnamon"_fnv1a16: interface = "/org/cinnamon/desktop/interface/"; break;
-        case "mate"_fnv1a16: interface = "/org/mate/interface/"; break;
+    if (!is_set(theme.gtk_theme_name))
+        dconf_read(interface + "gtk-theme", theme.gtk_theme_name);
 
-        case "gnome"_fnv1a16:
-        case "budgie"_fnv1a16:
-        case "unity"_fnv1a16:
-        default:
-            interface = "/org/gnome/desktop/interface/";
-    }
+    if (!is_set(theme.gtk_icon_theme))
+        dconf_read(interface + "icon-theme", theme.gtk_icon_theme);
 
-    if (theme.gtk_theme_name == MAGIC_LINE || theme.gtk_theme_name.empty())
-    {
-        variant = dconf_client_read(client, (interface + "gtk-theme").c_str());
-        if (variant)
-            theme.gtk_theme_name = g_variant_get_string(variant, NULL);
-    }
-
-    if (theme.gtk_icon_theme == MAGIC_LINE || theme.gtk_icon_theme.empty())
-    {
-        variant = dconf_client_read(client, (interface + "icon-theme").c_str());
-        if (variant)
-            theme.gtk_icon_theme = g_variant_get_string(variant, NULL);
-    }
-
-    if (theme.gtk_font == MAGIC_LINE || theme.gtk_font.empty())
-    {
-        variant = dconf_client_read(client, (interface + "font-name").c_str());
-        if (variant)
-            theme.gtk_font = g_variant_get_string(variant, NULL);
-    }
+    if (!is_set(theme.gtk_font))
+        dconf_read(interface + "font-name", theme.gtk_font);
 
     return assert_gtk_theme(theme);
-
-#else
-    return false;
-#endif
 }
 
 static void get_gtk_theme_gsettings(const std::string_view de_name, Theme::Theme_t& theme, const Config& config)
 {
     debug("calling {}", __PRETTY_FUNCTION__);
 
-    if (theme.gtk_theme_name == MAGIC_LINE || theme.gtk_theme_name.empty())
+    if (!is_set(theme.gtk_theme_name))
     {
         const char* gtk_theme_env = std::getenv("GTK_THEME");
 
@@ -348,68 +293,31 @@ static void get_gtk_theme_gsettings(const std::string_view de_name, Theme::Theme
     if (get_gtk_theme_dconf(de_name, theme))
         return;
 
-    if (config.slow_query_warnings)
-    {
-        warn("cufetch could not detect a gtk configuration file. cufetch will use the much-slower gsettings.");
-        warn("If there's a file in a standard location that we aren't detecting, please file an issue on our GitHub.");
-        info("You can disable this warning by disabling slow-query-warnings in your config.toml file.");
-    }
-
-    const char* interface;
-    switch(fnv1a16::hash(str_tolower(de_name.data())))
-    {
-        case "cinnamon"_fnv1a16: interface = "org.cinnamon.desktop.interface"; break;
-        case "mate"_fnv1a16: interface = "org.mate.interface"; break;
+    warn_slow_query(config);
+    const std::string& schema = get_gsettings_schema(de_name);
 
-        case "gnome"_fnv1a16:
-        case "budgie"_fnv1a16:
-        case "unity"_fnv1a16:
-        default:
-            interface = "org.gnome.desktop.interface";
-    }
+    if (!is_set(theme.gtk_theme_name))
+        get_gsettings_value(schema, "gtk-theme", theme.gtk_theme_name);
 
-    if (theme.gtk_theme_name == MAGIC_LINE || theme.gtk_theme_name.empty())
-    {
-        theme.gtk_theme_name.clear();
-        read_exec({ "gsettings", "get", interface, "gtk-theme" }, theme.gtk_theme_name);
-    }
+    if (!is_set(theme.gtk_icon_theme))
+        get_gsettings_value(schema, "icon-theme", theme.gtk_icon_theme);
 
-    if (theme.gtk_icon_theme == MAGIC_LINE || theme.gtk_icon_theme.empty())
-    {
-        theme.gtk_icon_theme.clear();
-        read_exec({ "gsettings", "get", interface, "icon-theme" }, theme.gtk_icon_theme);
-    }
-
-    if (theme.gtk_font == MAGIC_LINE || theme.gtk_font.empty())
-    {
-        theme.gtk_font.clear();
-        read_exec({ "gsettings", "get", interface, "font-name" }, theme.gtk_font);
-    }
-
-    theme.gtk_theme_name.erase(std::remove(theme.gtk_theme_name.begin(), theme.gtk_theme_name.end(), '\''), theme.gtk_theme_name.end());
-    theme.gtk_icon_theme.erase(std::remove(theme.gtk_icon_theme.begin(), theme.gtk_icon_theme.end(), '\''), theme.gtk_icon_theme.end());
-    theme.gtk_font.erase(std::remove(theme.gtk_font.begin(), theme.gtk_font.end(), '\''), theme.gtk_font.end());
+    if (!is_set(theme.gtk_font))
+        get_gsettings_value(schema, "font-name", theme.gtk_font);
 }
 
 static void get_gtk_theme_from_configs(const std::uint8_t ver, const std::string_view de_name, Theme::Theme_t& theme, const Config& config)
 {
-    if (get_gtk_theme_config(fmt::format("{}/gtk-{}.0/settings.ini", configDir, ver), theme))
-        return;
-
-    if (get_gtk_theme_config(fmt::format("{}/gtk-{}.0/gtkrc", configDir, ver), theme))
-        return;
-
-    if (get_gtk_theme_config(fmt::format("{}/gtkrc-{}.0", configDir, ver), theme))
-        return;
-
-    if (get_gtk_theme_config(fmt::format("{}/.gtkrc-{}.0", std::getenv("HOME"), ver), theme))
-        return;
-
-    if (get_gtk_theme_config(fmt::format("{}/.gtkrc-{}.0-kde", std::getenv("HOME"), ver), theme))
-        return;
+    for (const std::string& path : get_gtk_config_paths(ver))
+    {
+        const ini_file_t& file = get_ini_file(path);
+        get_gtk_config_value(file, "gtk-theme-name", theme.gtk_theme_name);
+        get_gtk_config_value(file, "gtk-icon-theme-name", theme.gtk_icon_theme);
+        get_gtk_config_value(file, "gtk-font-name", theme.gtk_font);
 
-    if (get_gtk_theme_config(fmt::format("{}/.gtkrc-{}.0-kde4", std::getenv("HOME"), ver), theme))
-        return;
+        if (assert_gtk_theme(theme))
+            return;
+    }
 
     get_gtk_theme_gsettings(de_name, theme, config);
 }
@@ -443,22 +351,19 @@ static void get_gtk_theme(const bool dont_query_dewm, const std::uint8_t ver, co
         get_gtk_theme_gsettings(de_name, theme, config);
     else if (dont_query_dewm)
         get_gtk_theme_from_configs(ver, de_name, theme, config);
-    else 
+    else
         get_de_gtk_theme(de_name, ver, theme, config);
 }
 
-// clang-format off
-Theme::Theme(const std::uint8_t ver, systemInfo_t& queried_themes, std::vector<std::string>& queried_themes_names,
-             const std::string& theme_name_version, const Config& config, const bool gsettings_only)
-            : m_queried_themes(queried_themes),
-              m_theme_name_version(theme_name_version)
+// the WM/DE name decides where to look first (xfce, dconf interface)
+// so it's resolved only once for every theme module
+std::string& Theme::wmde_name()
 {
-    if (std::find(queried_themes_names.begin(), queried_themes_names.end(), m_theme_name_version)
-        == queried_themes_names.end())
-        queried_themes_names.push_back(m_theme_name_version);
-    else
-        return;
+    static bool done = false;
+    if (done)
+        return m_wmde_name;
 
+    User query_user;
     const std::string& wm_name = query_user.wm_name(query_user.m_bDont_query_dewm, query_user.term_name());
     const std::string& de_name = query_user.de_name(query_user.m_bDont_query_dewm, query_user.term_name(), wm_name);
 
@@ -468,72 +373,208 @@ Theme::Theme(const std::uint8_t ver, systemInfo_t& queried_themes, std::vector<s
     else
         m_wmde_name = de_name;
 
-    get_gtk_theme(query_user.m_bDont_query_dewm, ver, m_wmde_name, m_theme_infos, config, gsettings_only);
+    done = true;
+    return m_wmde_name;
+}
+
+// clang-format off
+Theme::Theme(const std::uint8_t ver, const Config& config, const bool gsettings_only)
+{
+    const std::string& key = gsettings_only ? "gsettings" : fmt::format("gtk{}", ver);
+
+    const auto& it = m_themes.find(key);
+    if (it != m_themes.end())
+    {
+        m_pTheme = &it->second;
+        return;
+    }
 
-    if (m_theme_infos.gtk_theme_name.empty())
-        m_theme_infos.gtk_theme_name = MAGIC_LINE;
+    m_pTheme = &m_themes[key];
+    get_gtk_theme(User::m_bDont_query_dewm, ver, wmde_name(), *m_pTheme, config, gsettings_only);
 
-    if (m_theme_infos.gtk_font.empty())
-        m_theme_infos.gtk_font = MAGIC_LINE;
+    if (m_pTheme->gtk_theme_name.empty())
+        m_pTheme->gtk_theme_name = MAGIC_LINE;
 
-    if (m_theme_infos.gtk_icon_theme.empty())
-        m_theme_infos.gtk_icon_theme = MAGIC_LINE;
+    if (m_pTheme->gtk_font.empty())
+        m_pTheme->gtk_font = MAGIC_LINE;
 
-    m_queried_themes.insert(
-        {m_theme_name_version, {
-            {"theme-name",      variant(m_theme_infos.gtk_theme_name)},
-            {"icon-theme-name", variant(m_theme_infos.gtk_icon_theme)},
-            {"font-name",       variant(m_theme_infos.gtk_font)},
-        }}
-    );
+    if (m_pTheme->gtk_icon_theme.empty())
+        m_pTheme->gtk_icon_theme = MAGIC_LINE;
 }
 
 // only use it for cursor
-Theme::Theme(systemInfo_t& queried_themes, const Config& config, const bool gsettings_only) : m_queried_themes(queried_themes)
+Theme::Theme(const Config& config, const bool gsettings_only)
 {
-    const std::string& wm_name = query_user.wm_name(query_user.m_bDont_query_dewm, query_user.term_name());
-    const std::string& de_name = query_user.de_name(query_user.m_bDont_query_dewm, query_user.term_name(), wm_name);
+    const std::string& key = gsettings_only ? "cursor-gsettings" : "cursor";
 
-    if (((de_name != MAGIC_LINE && wm_name != MAGIC_LINE) &&
-         de_name == wm_name) || de_name == MAGIC_LINE)
-        m_wmde_name = wm_name;
-    else
-        m_wmde_name = de_name;
+    const auto& it = m_themes.find(key);
+    if (it != m_themes.end())
+    {
+        m_pTheme = &it->second;
+        return;
+    }
+
+    m_pTheme = &m_themes[key];
+    const std::string& wmde = wmde_name();
 
-    if (gsettings_only) { get_cursor_gsettings(m_wmde_name, m_theme_infos, config); }
-    else if (get_de_cursor(m_wmde_name, m_theme_infos)){}
-    else if (get_cursor_from_gtk_configs(4, m_theme_infos)){}
-    else if (get_cursor_from_gtk_configs(3, m_theme_infos)){}
-    else if (get_cursor_from_gtk_configs(2, m_theme_infos)){}
-    else if (get_cursor_xresources(m_theme_infos)){}
-    else get_cursor_gsettings(m_wmde_name, m_theme_infos, config);
+    if (gsettings_only) { get_cursor_gsettings(wmde, *m_pTheme, config); }
+    else if (get_de_cursor(wmde, *m_pTheme)){}
+    else if (get_cursor_from_gtk_configs(4, *m_pTheme)){}
+    else if (get_cursor_from_gtk_configs(3, *m_pTheme)){}
+    else if (get_cursor_from_gtk_configs(2, *m_pTheme)){}
+    else if (get_cursor_xresources(*m_pTheme)){}
+    else get_cursor_gsettings(wmde, *m_pTheme, config);
 
-    if (m_theme_infos.cursor.empty())
-        m_theme_infos.cursor = MAGIC_LINE;
+    if (m_pTheme->cursor.empty())
+        m_pTheme->cursor = MAGIC_LINE;
     else
     {
         size_t pos = 0;
-        if ((pos = m_theme_infos.cursor.rfind("cursor")) != std::string::npos)
-            m_theme_infos.cursor.erase(pos);
+        if ((pos = m_pTheme->cursor.rfind("cursor")) != std::string::npos)
+            m_pTheme->cursor.erase(pos);
 
-        if ((pos = m_theme_infos.cursor.rfind('_')) != std::string::npos)
-            m_theme_infos.cursor.erase(pos - 1);
+        if ((pos = m_pTheme->cursor.rfind('_')) != std::string::npos)
+            m_pTheme->cursor.erase(pos - 1);
 
     }
 
+    if (m_pTheme->cursor_size.empty())
+        m_pTheme->cursor_size = UNKNOWN;
 }
 
-std::string Theme::gtk_theme() noexcept
-{ return getInfoFromName(m_queried_themes, m_theme_name_version, "theme-name"); }
+std::string& Theme::gtk_theme() noexcept
+{ return m_pTheme->gtk_theme_name; }
 
-std::string Theme::gtk_icon_theme() noexcept
-{ return getInfoFromName(m_queried_themes, m_theme_name_version, "icon-theme-name"); }
+std::string& Theme::gtk_icon_theme() noexcept
+{ return m_pTheme->gtk_icon_theme; }
 
-std::string Theme::gtk_font() noexcept
-{ return getInfoFromName(m_queried_themes, m_theme_name_version, "font-name"); }
+std::string& Theme::gtk_font() noexcept
+{ return m_pTheme->gtk_font; }
 
 std::string& Theme::cursor() noexcept
-{ return m_theme_infos.cursor; }
+{ return m_pTheme->cursor; }
 
 std::string& Theme::cursor_size() noexcept
-{ return m_theme_infos.cursor_size; }
+{ return m_pTheme->cursor_size; }
+
+//
+//
+// 3. Qt/KDE theme
+//
+// "Noto Sans,10,-1,5,50,0,0,0,0,0" -> "Noto Sans 10"
+static std::string format_qt_font(const std::string& font)
+{
+    // qt5ct may store the font as a serialized QFont "@Variant(...)"
+    if (font.empty() || font.front() == '@')
+        return MAGIC_LINE;
+
+    const size_t family_end = font.find(',');
+    if (family_end == std::string::npos)
+        return font;
+
+    const size_t size_end = font.find(',', family_end + 1);
+    return font.substr(0, family_end) + ' ' + font.substr(family_end + 1, size_end - family_end - 1);
+}
+
+// color_scheme_path=/usr/share/qt5ct/colors/darker.conf -> darker
+static std::string get_qt_color_scheme_name(const std::string& path)
+{
+    const size_t start = path.rfind('/') + 1;
+    const size_t end   = path.rfind(".conf");
+    return path.substr(start, end != std::string::npos && end > start ? end - start : std::string::npos);
+}
+
+static void get_qtct_theme(const std::uint8_t ver, ThemeQt::ThemeQt_t& theme)
+{
+    const ini_file_t& file = get_ini_file(fmt::format("{}/qt{}ct/qt{}ct.conf", configDir, ver, ver));
+    if (!file.exists)
+        return;
+
+    std::string value;
+    if (!is_set(theme.style))
+        get_ini_value(file, "Appearance", "style", theme.style);
+
+    if (!is_set(theme.color_scheme) && get_ini_value(file, "Appearance", "color_scheme_path", value) && !value.empty())
+        theme.color_scheme = get_qt_color_scheme_name(value);
+
+    if (!is_set(theme.icon_theme))
+        get_ini_value(file, "Appearance", "icon_theme", theme.icon_theme);
+
+    if (!is_set(theme.font) && get_ini_value(file, "Fonts", "general", value))
+        theme.font = format_qt_font(value);
+}
+
+static void get_kde_theme(ThemeQt::ThemeQt_t& theme)
+{
+    const ini_file_t& kdeglobals = get_ini_file(configDir + "/kdeglobals");
+
+    std::string value;
+    if (!is_set(theme.style))
+        get_ini_value(kdeglobals, "KDE", "widgetStyle", theme.style);
+
+    if (!is_set(theme.color_scheme))
+        get_ini_value(kdeglobals, "General", "ColorScheme", theme.color_scheme);
+
+    if (!is_set(theme.icon_theme))
+        get_ini_value(kdeglobals, "Icons", "Theme", theme.icon_theme);
+
+    if (!is_set(theme.font) && get_ini_value(kdeglobals, "General", "font", value))
+        theme.font = format_qt_font(value);
+
+    const ini_file_t& kcminputrc = get_ini_file(configDir + "/kcminputrc");
+    if (!is_set(theme.cursor))
+        get_ini_value(kcminputrc, "Mouse", "cursorTheme", theme.cursor);
+
+    if (!is_set(theme.cursor_size))
+        get_ini_value(kcminputrc, "Mouse", "cursorSize", theme.cursor_size);
+}
+
+ThemeQt::ThemeQt()
+{
+    if (m_bInit)
+        return;
+
+    // qt5ct/qt6ct override the KDE settings only when they're the platform theme
+    const char* platform_theme = std::getenv("QT_QPA_PLATFORMTHEME");
+    if (platform_theme && hasStart(platform_theme, "qt6ct"))
+        get_qtct_theme(6, m_qt_infos);
+    else if (platform_theme && hasStart(platform_theme, "qt5ct"))
+        get_qtct_theme(5, m_qt_infos);
+
+    get_kde_theme(m_qt_infos);
+
+    // not using KDE nor a platform theme, but still maybe have them configured
+    get_qtct_theme(6, m_qt_infos);
+    get_qtct_theme(5, m_qt_infos);
+
+    for (std::string* str : { &m_qt_infos.style, &m_qt_infos.color_scheme, &m_qt_infos.icon_theme,
+                              &m_qt_infos.font, &m_qt_infos.cursor })
+    {
+        if (str->empty())
+            *str = MAGIC_LINE;
+    }
+
+    if (m_qt_infos.cursor_size.empty())
+        m_qt_infos.cursor_size = UNKNOWN;
+
+    m_bInit = true;
+}
+
+// clang-format off
+std::string& ThemeQt::style() noexcept
+{ return m_qt_infos.style; }
+
+std::string& ThemeQt::color_scheme() noexcept
+{ return m_qt_infos.color_scheme; }
+
+std::string& ThemeQt::icon_theme() noexcept
+{ return m_qt_infos.icon_theme; }
+
+std::string& ThemeQt::font() noexcept
+{ return m_qt_infos.font; }
+
+std::string& ThemeQt::cursor() noexcept
+{ return m_qt_infos.cursor; }
+
+std::string& ThemeQt::cursor_size() noexcept
+{ return m_qt_infos.cursor_size; }
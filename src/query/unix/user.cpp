@@ -48,8 +48,9 @@ static std::string get_wm_name(std::string& wm_path_exec)
         path = dir_entry.path() / "loginuid";
         std::ifstream f_uid(path, std::ios::binary);
         std::string   s_uid;
-        std::getline(f_uid, s_uid);
-        if (std::stoul(s_uid) != uid)
+        // the process may be already gone (e.g the other cufetch started along with us)
+        if (!std::getline(f_uid, s_uid) || s_uid.empty() || !std::isdigit(s_uid.front()) ||
+            std::stoul(s_uid) != uid)
             continue;
 
         path = dir_entry.path() / "cmdline";
@@ -69,7 +70,10 @@ static std::string get_wm_name(std::string& wm_path_exec)
             continue;
 
         char buf[PATH_MAX];
-        wm_path_exec = realpath((dir_entry.path().string() + "/exe").c_str(), buf);
+        if (realpath((dir_entry.path().string() + "/exe").c_str(), buf) == nullptr)
+            continue;
+
+        wm_path_exec = buf;
         break;
     }
 
@@ -164,7 +168,7 @@ static std::string get_shell_name(const std::string_view shell_path)
 static std::string get_term_name(std::string& term_ver)
 {
     // cufetch -> shell -> terminal
-    const pid_t   ppid = getppid();
+    const pid_t   ppid = User::m_parent_pid > 0 ? User::m_parent_pid : getppid();
     std::ifstream ppid_f(fmt::format("/proc/{}/status", ppid), std::ios::in);
     std::string   line, term_pid;
     while (std::getline(ppid_f, line))
@@ -0,0 +1,259 @@
+#include "gvdb.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "fmt/format.h"
+#include "util.hpp"
+
+// "GVariant" in little endian
+constexpr std::uint32_t GVDB_SIGNATURE0 = 1918981703;
+constexpr std::uint32_t GVDB_SIGNATURE1 = 1953390953;
+
+// struct gvdb_header { u32 signature[2]; u32 version; u32 options; gvdb_pointer root; }
+constexpr size_t HEADER_SIZE = 24;
+
+// struct gvdb_hash_item { u32 hash_value; u32 parent; u32 key_start; u16 key_size; char type; char unused; gvdb_pointer value; }
+constexpr size_t HASH_ITEM_SIZE = 24;
+
+// djb hash, with signed chars like in gvdb-builder.c
+static std::uint32_t gvdb_hash(const std::string_view key)
+{
+    std::uint32_t hash = 5381;
+    for (const char c : key)
+        hash = hash * 33 + static_cast<std::uint32_t>(static_cast<signed char>(c));
+
+    return hash;
+}
+
+GVDB::GVDB(const std::string& path)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open())
+        return;
+
+    m_data.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    if (m_data.size() < HEADER_SIZE)
+        return;
+
+    std::uint32_t signature[2];
+    std::memcpy(signature, m_data.data(), sizeof(signature));
+    if (signature[0] == __builtin_bswap32(GVDB_SIGNATURE0) && signature[1] == __builtin_bswap32(GVDB_SIGNATURE1))
+        m_bByteswapped = true;
+    else if (signature[0] != GVDB_SIGNATURE0 || signature[1] != GVDB_SIGNATURE1)
+    {
+        debug("{} is not a GVDB file", path);
+        return;
+    }
+
+    const std::uint32_t root_start = read_u32(16);
+    const std::uint32_t root_end   = read_u32(20);
+    if (root_start > root_end || root_end > m_data.size() || root_end - root_start < 8)
+        return;
+
+    // struct gvdb_hash_header { u32 n_bloom_words; u32 n_buckets; }
+    // the top 5 bits of n_bloom_words are the bloom shift
+    const std::uint32_t n_bloom_words = read_u32(root_start) & ((1 << 27) - 1);
+    m_n_buckets                       = read_u32(root_start + 4);
+
+    m_buckets_start = root_start + 8 + static_cast<size_t>(n_bloom_words) * 4;
+    m_items_start   = m_buckets_start + static_cast<size_t>(m_n_buckets) * 4;
+    if (m_items_start > root_end)
+        return;
+
+    m_n_items = (root_end - m_items_start) / HASH_ITEM_SIZE;
+    m_bValid  = true;
+}
+
+std::uint32_t GVDB::read_u32(const size_t offset) const
+{
+    std::uint32_t ret;
+    std::memcpy(&ret, m_data.data() + offset, sizeof(ret));
+    return m_bByteswapped ? __builtin_bswap32(ret) : ret;
+}
+
+std::uint16_t GVDB::read_u16(const size_t offset) const
+{
+    std::uint16_t ret;
+    std::memcpy(&ret, m_data.data() + offset, sizeof(ret));
+    return m_bByteswapped ? __builtin_bswap16(ret) : ret;
+}
+
+// each item only has the last part of its key,
+// the rest is in the chain of its parents
+bool GVDB::check_key(std::uint32_t item, std::string_view key) const
+{
+    // the depth can't be bigger than the number of items, avoid loops in corrupted files
+    for (std::uint32_t depth = 0; depth <= m_n_items; ++depth)
+    {
+        const size_t        item_offset = m_items_start + static_cast<size_t>(item) * HASH_ITEM_SIZE;
+        const std::uint32_t parent      = read_u32(item_offset + 4);
+        const std::uint32_t key_start   = read_u32(item_offset + 8);
+        const std::uint16_t key_size    = read_u16(item_offset + 12);
+
+        if (static_cast<size_t>(key_start) + key_size > m_data.size() || key_size > key.length())
+            return false;
+
+        if (key.substr(key.length() - key_size) != std::string_view(m_data.data() + key_start, key_size))
+            return false;
+
+        key.remove_suffix(key_size);
+        if (key.empty() && parent == 0xffffffff)
+            return true;
+
+        if (parent >= m_n_items || key_size == 0)
+            return false;
+
+        item = parent;
+    }
+
+    return false;
+}
+
+bool GVDB::lookup(const std::string_view key, std::string& ret) const
+{
+    if (!m_bValid || m_n_buckets == 0 || m_n_items == 0)
+        return false;
+
+    const std::uint32_t hash   = gvdb_hash(key);
+    const std::uint32_t bucket = hash % m_n_buckets;
+
+    std::uint32_t itemno = read_u32(m_buckets_start + static_cast<size_t>(bucket) * 4);
+    std::uint32_t lastno = m_n_items;
+    if (bucket != m_n_buckets - 1)
+        lastno = std::min(read_u32(m_buckets_start + static_cast<size_t>(bucket + 1) * 4), m_n_items);
+
+    for (; itemno < lastno; ++itemno)
+    {
+        const size_t item_offset = m_items_start + static_cast<size_t>(itemno) * HASH_ITEM_SIZE;
+        if (read_u32(item_offset) != hash || m_data.at(item_offset + 14) != 'v' || !check_key(itemno, key))
+            continue;
+
+        const std::uint32_t value_start = read_u32(item_offset + 16);
+        const std::uint32_t value_end   = read_u32(item_offset + 20);
+        if (value_start > value_end || value_end > m_data.size())
+            return false;
+
+        // a serialized "v" GVariant is: child data, '\0', child type string
+        const std::string_view value(m_data.data() + value_start, value_end - value_start);
+        const size_t           sep = value.rfind('\0');
+        if (sep == std::string_view::npos)
+            return false;
+
+        const std::string_view type = value.substr(sep + 1);
+        const std::string_view data = value.substr(0, sep);
+        if (type.length() != 1)
+        {
+            debug("dconf key {} has unsupported type '{}'", key, type);
+            return false;
+        }
+
+        switch (type.front())
+        {
+            case 's':
+                // strings are nul-terminated
+                ret = data.substr(0, data.find('\0'));
+                return true;
+
+            case 'b':
+                if (data.length() < 1)
+                    return false;
+                ret = data.front() ? "true" : "false";
+                return true;
+
+            case 'i':
+            case 'u':
+            {
+                if (data.length() < 4)
+                    return false;
+                std::uint32_t n;
+                std::memcpy(&n, data.data(), sizeof(n));
+                if (m_bByteswapped)
+                    n = __builtin_bswap32(n);
+                ret = type.front() == 'i' ? fmt::to_string(static_cast<std::int32_t>(n)) : fmt::to_string(n);
+                return true;
+            }
+
+            case 'd':
+            {
+                if (data.length() < 8)
+                    return false;
+                std::uint64_t n;
+                std::memcpy(&n, data.data(), sizeof(n));
+                if (m_bByteswapped)
+                    n = __builtin_bswap64(n);
+                double d;
+                std::memcpy(&d, &n, sizeof(d));
+                ret = fmt::to_string(d);
+                return true;
+            }
+        }
+
+        debug("dconf key {} has unsupported type '{}'", key, type);
+        return false;
+    }
+
+    return false;
+}
+
+// https://gitlab.gnome.org/GNOME/dconf/-/blob/main/engine/dconf-engine-profile.c
+static std::vector<std::string> get_dconf_db_paths()
+{
+    const char* xdg_config_home = std::getenv("XDG_CONFIG_HOME");
+    const std::string& user_dir = (xdg_config_home ? std::string(xdg_config_home) : expandVar("~/.config")) + "/dconf/";
+
+    std::string profile = "user";
+    const char* env = std::getenv("DCONF_PROFILE");
+    if (env && *env)
+        profile = env;
+
+    const std::string& profile_path = profile.front() == '/' ? profile : "/etc/dconf/profile/" + profile;
+    std::ifstream      f(profile_path);
+
+    // without profile, dconf only uses the user database
+    if (!f.is_open())
+        return { user_dir + "user" };
+
+    std::vector<std::string> ret;
+    std::string              line;
+    while (std::getline(f, line))
+    {
+        strip(line);
+        if (line.empty() || line.front() == '#')
+            continue;
+
+        if (hasStart(line, "user-db:"))
+            ret.push_back(user_dir + line.substr("user-db:"_len));
+        else if (hasStart(line, "system-db:"))
+            ret.push_back("/etc/dconf/db/" + line.substr("system-db:"_len));
+    }
+
+    return ret;
+}
+
+bool dconf_read(const std::string_view key, std::string& ret)
+{
+    static std::vector<std::unique_ptr<GVDB>> databases;
+    static bool                               done = false;
+    if (!done)
+    {
+        for (const std::string& path : get_dconf_db_paths())
+        {
+            debug("loading dconf database {}", path);
+            databases.push_back(std::make_unique<GVDB>(path));
+        }
+        done = true;
+    }
+
+    for (const std::unique_ptr<GVDB>& db : databases)
+    {
+        if (db->lookup(key, ret))
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,52 @@
+#ifndef _GVDB_HPP
+#define _GVDB_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/* Minimal read-only reader of the GVDB format, used by the dconf databases
+ * (~/.config/dconf/user and /etc/dconf/db/ files).
+ * Only the root hash table is read, and only the variant types that
+ * dconf settings commonly use (strings, integers, booleans and doubles) are converted.
+ * https://gitlab.gnome.org/GNOME/glib/-/blob/main/gio/gvdb/gvdb-format.h
+ */
+class GVDB
+{
+public:
+    GVDB(const std::string& path);
+
+    bool is_valid() const noexcept
+    { return m_bValid; }
+
+    /* Get the value of a key as a string
+     * @param key The full key path (e.g "/org/gnome/desktop/interface/gtk-theme")
+     * @param ret Where the value will be stored
+     * @return true if the key exists and its type is supported
+     */
+    bool lookup(const std::string_view key, std::string& ret) const;
+
+private:
+    std::uint32_t read_u32(const size_t offset) const;
+    std::uint16_t read_u16(const size_t offset) const;
+    bool          check_key(std::uint32_t item, std::string_view key) const;
+
+    std::string   m_data;
+    bool          m_bValid       = false;
+    bool          m_bByteswapped = false;
+    size_t        m_buckets_start = 0;
+    size_t        m_items_start   = 0;
+    std::uint32_t m_n_buckets     = 0;
+    std::uint32_t m_n_items       = 0;
+};
+
+/* Read a key from the dconf databases of the current profile,
+ * the user database first, then the system ones (/etc/dconf/db/).
+ * The databases are loaded only once
+ * @param key The full key path (e.g "/org/gnome/desktop/interface/gtk-theme")
+ * @param ret Where the value will be stored
+ * @return true if the key was found
+ */
+bool dconf_read(const std::string_view key, std::string& ret);
+
+#endif
@@ -0,0 +1,82 @@
+#include "ini.hpp"
+
+#include <fstream>
+
+#include "util.hpp"
+
+// removes the quotes around a value, e.g gtk-theme-name="Adwaita"
+static void unquote(std::string& str)
+{
+    if (str.length() >= 2 && (str.front() == '"' || str.front() == '\'') && str.back() == str.front())
+        str = str.substr(1, str.length() - 2);
+}
+
+static ini_file_t parse_ini_file(const std::string& path, const char sep)
+{
+    ini_file_t    ret;
+    std::ifstream f(path, std::ios::in);
+    if (!f.is_open())
+        return ret;
+
+    debug("parsing config file {}", path);
+    ret.exists = true;
+
+    std::string section, line;
+    while (std::getline(f, line))
+    {
+        strip(line);
+        if (line.empty() || line.front() == '#' || line.front() == ';' || line.front() == '!')
+            continue;
+
+        if (line.front() == '[' && line.back() == ']')
+        {
+            section = line.substr(1, line.length() - 2);
+            continue;
+        }
+
+        const size_t pos = line.find(sep);
+        if (pos == std::string::npos)
+            continue;
+
+        std::string key   = line.substr(0, pos);
+        std::string value = line.substr(pos + 1);
+        strip(key);
+        strip(value);
+        unquote(value);
+
+        // KDE flags, e.g "Theme[$e]=~/themes/breeze"
+        const size_t flags = key.find("[$");
+        if (flags != std::string::npos)
+            key.erase(flags);
+
+        ret.sections[section][key] = value;
+    }
+
+    return ret;
+}
+
+const ini_file_t& get_ini_file(const std::string& path, const char sep)
+{
+    static std::unordered_map<std::string, ini_file_t> files;
+
+    const std::string& id = sep + path;
+    const auto&        it = files.find(id);
+    if (it != files.end())
+        return it->second;
+
+    return files.emplace(id, parse_ini_file(path, sep)).first->second;
+}
+
+bool get_ini_value(const ini_file_t& file, const std::string_view section, const std::string& key, std::string& ret)
+{
+    const auto& section_it = file.sections.find(std::string(section));
+    if (section_it == file.sections.end())
+        return false;
+
+    const auto& key_it = section_it->second.find(key);
+    if (key_it == section_it->second.end())
+        return false;
+
+    ret = key_it->second;
+    return true;
+}
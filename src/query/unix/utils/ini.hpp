@@ -0,0 +1,34 @@
+#ifndef _INI_HPP
+#define _INI_HPP
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+struct ini_file_t
+{
+    bool exists = false;
+
+    // section -> key -> value
+    // keys before any section header are in the "" section
+    std::unordered_map<std::string, std::unordered_map<std::string, std::string>> sections;
+};
+
+/* Parse an INI-like config file (e.g gtk settings.ini, gtkrc-2.0, kdeglobals, qt5ct.conf, .Xresources).
+ * Each file is read at most once per run, then it's just a lookup
+ * @param path The path to the file
+ * @param sep The separator between key and value ('=' for INI, ':' for Xresources)
+ * @return the parsed file, with exists = false if it couldn't be opened
+ */
+const ini_file_t& get_ini_file(const std::string& path, const char sep = '=');
+
+/* Get a value from a parsed config file
+ * @param file The parsed file from get_ini_file()
+ * @param section The section name without brackets, or "" for the keys before any section
+ * @param key The key name
+ * @param ret Where the value will be stored
+ * @return true if the key was found
+ */
+bool get_ini_value(const ini_file_t& file, const std::string_view section, const std::string& key, std::string& ret);
+
+#endif
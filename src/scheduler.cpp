@@ -0,0 +1,791 @@
+/* Querying the modules within their deadlines, see Scheduler::query() */
+
+#include "scheduler.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "fmt/format.h"
+#include "parse.hpp"
+#include "snapshot.hpp"
+#include "term_colors.hpp"
+#include "util.hpp"
+
+using clock_type = std::chrono::steady_clock;
+
+// how much the last run weighs in the average time of a module
+constexpr double TIMING_ALPHA = 0.3;
+
+// a module goes in cached mode after this many runs in a row over config.slow_threshold,
+// and gets queried again after this many runs in cached mode, for knowing if it's still slow
+constexpr std::uint32_t SLOW_RUNS    = 3;
+constexpr std::uint32_t REFRESH_RUNS = 10;
+
+// the queries mostly wait for files and commands, so there are more workers than the cores of small machines
+constexpr unsigned MIN_WORKERS = 4;
+
+// the values caches not used since then get removed
+constexpr int CACHE_MAX_AGE_DAYS = 7;
+
+// initialized before main(), about when cufetch started
+static const clock_type::time_point g_start = clock_type::now();
+
+// the lanes with a query stuck on a thread, see Scheduler::is_poisoned()
+static std::mutex               g_poisoned_mutex;
+static std::vector<std::string> g_poisoned_lanes;
+
+struct task_t
+{
+    std::string            module;
+    std::string            member;
+    clock_type::time_point deadline;
+    clock_type::time_point started_at;
+    double                 ms        = 0;
+    bool                   started   = false;
+    bool                   done      = false;
+    bool                   timed_out = false;
+    bool                   merged    = false;  // its value is in the systemInfo of query()
+    std::vector<size_t>    lines;              // the layout lines with its tag
+};
+
+// the recorded wall time of a module
+struct timing_t
+{
+    double        avg_ms      = 0;  // exponentially averaged
+    double        last_ms     = 0;
+    std::uint32_t slow_runs   = 0;  // in a row over config.slow_threshold
+    std::uint32_t cached_runs = 0;  // in a row with the cached values
+};
+
+using timings_t = std::unordered_map<std::string, timing_t>;
+
+// shared with the threads, which may still be stuck in a query when we're done waiting for them
+struct state_t
+{
+    state_t(const Config& config_, const colors_t& colors_) : config(config_), colors(colors_) {}
+
+    Config                           config;
+    colors_t                         colors;
+    std::mutex                       mutex;
+    std::condition_variable          cv;
+    std::vector<task_t>              tasks;
+    std::vector<std::vector<size_t>> lanes;  // the longest ones first
+    std::vector<std::string>         lanes_name;
+    size_t                           next_lane = 0;
+    systemInfo_t                     results;
+    std::exception_ptr               error;  // a fatal_error of die(), for rethrowing it in query()
+};
+
+// the modules that use the same Query classes, which aren't thread safe, go in the same lane
+static std::string get_lane(const std::string& module)
+{
+    if (module == "os" || module == "system")
+        return "system";
+    // Query::Theme uses Query::User
+    if (module == "user" || hasStart(module, "theme"))
+        return "user";
+    if (hasStart(module, "disk"))
+        return "disk";
+    if (module == "ram" || module == "swap" || hasStart(module, "zram"))
+        return "ram";
+    if (hasStart(module, "gpu"))
+        return "gpu";
+
+    return module;
+}
+
+// the static destructors of the Query classes of the stuck queries would race with them
+static void leave_stuck()
+{
+    {
+        const std::lock_guard<std::mutex> lock(g_poisoned_mutex);
+        if (g_poisoned_lanes.empty())
+            return;
+    }
+
+    std::fflush(stdout);
+    std::fflush(stderr);
+    _exit(1);
+}
+
+// registered on the first Scheduler::query(), so the atexit() handlers registered after it still run
+// (e.g the one restoring the terminal of the progressive display).
+// Not in libcustomfetch, the exit code of the program using it is its own business
+static void register_leave_stuck()
+{
+    static std::once_flag registered;
+    std::call_once(registered, []() {
+        if (g_die_throw_pid != getpid())
+            std::atexit(leave_stuck);
+    });
+}
+
+static void poison(const std::string& lane)
+{
+    const std::lock_guard<std::mutex> lock(g_poisoned_mutex);
+    if (std::find(g_poisoned_lanes.begin(), g_poisoned_lanes.end(), lane) == g_poisoned_lanes.end())
+        g_poisoned_lanes.push_back(lane);
+}
+
+// e.g "disk" for disk(/home)
+static std::uint16_t get_deadline_ms(const Config& config, const std::string& module)
+{
+    const auto& it = config.module_deadlines.find(module.substr(0, module.find('(')));
+    return it != config.module_deadlines.end() ? it->second : config.module_deadline;
+}
+
+// the values are formatted as the config says (e.g SI units or colored percentages),
+// so there's a cache for each config file and arguments (see config.m_shared_key)
+static std::string get_cache_path(const Config& config)
+{ return fmt::format("{}/values-{}-{:016x}", getCacheDir(), Snapshot::FORMAT_VERSION, config.m_shared_key); }
+
+static systemInfo_t load_cache(const Config& config)
+{
+    std::ifstream file(get_cache_path(config), std::ios::binary);
+    if (!file.is_open())
+        return {};
+
+    // still in use, see prune_caches()
+    std::error_code ec;
+    std::filesystem::last_write_time(get_cache_path(config), std::filesystem::file_time_type::clock::now(), ec);
+
+    const std::string data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+    // it's only the last values, a broken one (e.g a full disk) is as good as none
+    Snapshot::snapshot_t snapshot;
+    std::string          error;
+    if (!Snapshot::try_decode(data, get_cache_path(config), snapshot, error))
+    {
+        debug("{}, removing it", error);
+        std::filesystem::remove(get_cache_path(config), ec);
+        return {};
+    }
+
+    return snapshot.systemInfo;
+}
+
+// the ones of the old versions of the config files, or of arguments not used anymore
+static void prune_caches()
+{
+    std::error_code ec;
+    const auto&     old = std::filesystem::file_time_type::clock::now() - std::chrono::days(CACHE_MAX_AGE_DAYS);
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(getCacheDir(), ec))
+        if (hasStart(entry.path().filename().string(), "values-") && entry.last_write_time(ec) < old)
+            std::filesystem::remove(entry.path(), ec);
+}
+
+// the last values, for the next time they time out or are too slow
+static void save_cache(const Config& config, const systemInfo_t& old_cache, const systemInfo_t& values)
+{
+    systemInfo_t cache{ old_cache };
+    for (const auto& [module, members] : values)
+        for (const auto& [member, value] : members)
+            cache[module].insert_or_assign(member, value);
+
+    if (cache == old_cache)
+        return;
+
+    std::error_code ec;
+    std::filesystem::create_directories(getCacheDir(), ec);
+    if (!write_file_atomic(get_cache_path(config), Snapshot::encode({ "", "", std::move(cache) }), 0600))
+        debug("Failed to write {}: {}", get_cache_path(config), std::strerror(errno));
+
+    prune_caches();
+}
+
+static std::string get_timings_path()
+{ return getCacheDir() + "/timings"; }
+
+// a line for each module: <module>\t<avg ms>\t<last ms>\t<slow runs>\t<cached runs>
+static timings_t load_timings()
+{
+    timings_t     timings;
+    std::ifstream file(get_timings_path());
+    std::string   line;
+    while (std::getline(file, line))
+    {
+        const std::vector<std::string>& fields = split(line, '\t');
+        if (fields.size() != 5)
+            continue;
+
+        try
+        {
+            timings[fields.at(0)] = { std::stod(fields.at(1)), std::stod(fields.at(2)),
+                                      static_cast<std::uint32_t>(std::stoul(fields.at(3))),
+                                      static_cast<std::uint32_t>(std::stoul(fields.at(4))) };
+        }
+        catch (const std::exception&)
+        {
+            debug("Invalid line in {}: {}", get_timings_path(), line);
+        }
+    }
+
+    return timings;
+}
+
+static void save_timings(const timings_t& timings)
+{
+    std::string out;
+    for (const auto& [module, timing] : timings)
+        out += fmt::format("{}\t{:.3f}\t{:.3f}\t{}\t{}\n", module, timing.avg_ms, timing.last_ms, timing.slow_runs,
+                           timing.cached_runs);
+
+    std::error_code ec;
+    std::filesystem::create_directories(getCacheDir(), ec);
+    if (!write_file_atomic(get_timings_path(), out, 0600))
+        debug("Failed to write {}: {}", get_timings_path(), std::strerror(errno));
+}
+
+static void record_timing(timing_t& timing, const double ms, const std::uint16_t slow_threshold)
+{
+    const bool first = timing.avg_ms == 0 && timing.last_ms == 0;
+
+    timing.avg_ms      = first ? ms : TIMING_ALPHA * ms + (1 - TIMING_ALPHA) * timing.avg_ms;
+    timing.last_ms     = ms;
+    timing.slow_runs   = slow_threshold > 0 && ms > slow_threshold ? timing.slow_runs + 1 : 0;
+    timing.cached_runs = 0;
+}
+
+// the times of this run, added up over its Scheduler::query() calls (e.g the one of Shared::get() and the render one)
+struct run_timings_t
+{
+    std::mutex                              mutex;
+    bool                                    loaded = false;
+    timings_t                               before;  // the ones recorded by the previous runs
+    std::unordered_map<std::string, double> modules_ms;
+    std::vector<std::string>                cached_modules;
+};
+
+static run_timings_t g_run_timings;
+
+static timings_t get_timings()
+{
+    const std::lock_guard<std::mutex> lock(g_run_timings.mutex);
+    if (!g_run_timings.loaded)
+    {
+        g_run_timings.before = load_timings();
+        g_run_timings.loaded = true;
+    }
+
+    return g_run_timings.before;
+}
+
+// only the ones of the cufetch runs, the daemon and libcustomfetch have their values already queried most of the times
+static void record_timings(const Config& config, const std::unordered_map<std::string, double>& modules_ms,
+                           const std::vector<std::string>& cached_modules)
+{
+    if (config.m_shared_key == 0 || (modules_ms.empty() && cached_modules.empty()))
+        return;
+
+    const std::lock_guard<std::mutex> lock(g_run_timings.mutex);
+    for (const auto& [module, ms] : modules_ms)
+        g_run_timings.modules_ms[module] += ms;
+    for (const std::string& module : cached_modules)
+        if (std::find(g_run_timings.cached_modules.begin(), g_run_timings.cached_modules.end(), module) ==
+            g_run_timings.cached_modules.end())
+            g_run_timings.cached_modules.push_back(module);
+
+    // a module in cached mode may still get some members queried (e.g the ones not shared), it stays in cached mode
+    timings_t timings{ g_run_timings.before };
+    for (const std::string& module : g_run_timings.cached_modules)
+        ++timings[module].cached_runs;
+    for (const auto& [module, ms] : g_run_timings.modules_ms)
+        if (std::find(g_run_timings.cached_modules.begin(), g_run_timings.cached_modules.end(), module) ==
+            g_run_timings.cached_modules.end())
+            record_timing(timings[module], ms, config.slow_threshold);
+
+    save_timings(timings);
+}
+
+// a module never queried yet has no time
+static timing_t get_timing(const timings_t& timings, const std::string& module)
+{
+    const auto& it = timings.find(module);
+    return it != timings.end() ? it->second : timing_t{};
+}
+
+// consistently slower than config.slow_threshold, and not to be queried again yet
+static bool is_slow(const timing_t& timing, const std::uint16_t slow_threshold)
+{
+    return slow_threshold > 0 && timing.avg_ms > slow_threshold && timing.slow_runs >= SLOW_RUNS &&
+           timing.cached_runs < REFRESH_RUNS;
+}
+
+// each worker takes the next lane nobody took yet, so the longest ones start first
+static void work(const std::shared_ptr<state_t> state)
+{
+    // exiting here would destroy the statics still used by query()
+    g_die_throw_thread = true;
+
+    systemInfo_t                 systemInfo;
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (state->next_lane < state->lanes.size())
+    {
+        const std::vector<size_t> lane = state->lanes.at(state->next_lane++);
+        for (const size_t i : lane)
+        {
+            task_t& task = state->tasks.at(i);
+            if (task.timed_out || state->error)
+                continue;
+
+            task.started    = true;
+            task.started_at = clock_type::now();
+            lock.unlock();
+
+            std::exception_ptr error;
+            try
+            {
+                parse(fmt::format("$<{}.{}>", task.module, task.member), systemInfo, state->config, state->colors,
+                      true);
+            }
+            catch (const fatal_error&)
+            {
+                error = std::current_exception();
+            }
+
+            lock.lock();
+            if (error && !state->error)
+                state->error = error;
+            task.done = true;
+            task.ms   = std::chrono::duration<double, std::milli>(clock_type::now() - task.started_at).count();
+            if (const auto& module = systemInfo.find(task.module); module != systemInfo.end())
+                if (const auto& member = module->second.find(task.member); member != module->second.end())
+                    state->results[task.module].insert_or_assign(task.member, member->second);
+            state->cv.notify_all();
+        }
+    }
+}
+
+namespace Scheduler
+{
+
+bool enabled(const Config& config)
+{
+    return config.render_deadline > 0 || config.module_deadline > 0 || !config.module_deadlines.empty() ||
+           config.slow_threshold > 0;
+}
+
+bool is_poisoned(const std::string& module)
+{
+    const std::lock_guard<std::mutex> lock(g_poisoned_mutex);
+    return !g_poisoned_lanes.empty() &&
+           std::find(g_poisoned_lanes.begin(), g_poisoned_lanes.end(), get_lane(module)) != g_poisoned_lanes.end();
+}
+
+int leave(const int ret)
+{
+    {
+        const std::lock_guard<std::mutex> lock(g_poisoned_mutex);
+        if (g_poisoned_lanes.empty())
+            return ret;
+    }
+
+    std::fflush(stdout);
+    std::fflush(stderr);
+    _exit(ret);
+}
+
+std::int64_t render_time_left(const Config& config)
+{
+    if (config.render_deadline == 0)
+        return -1;
+
+    const auto& elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(clock_type::now() - g_start);
+    return std::max<std::int64_t>(0, config.render_deadline - elapsed.count());
+}
+
+bool query(systemInfo_t& systemInfo, const std::vector<std::string>& layout, const Config& config,
+           const colors_t& colors, const std::function<void(size_t line)>& on_line)
+{
+    const std::shared_ptr<state_t>& state = std::make_shared<state_t>(config, colors);
+    const clock_type::time_point    start = clock_type::now();
+    register_leave_stuck();
+
+    // the daemon and libcustomfetch have no key, their values would be mixed with the other configs ones
+    const bool use_cache = config.m_shared_key != 0 && enabled(config) &&
+                           (config.deadline_fallback == "cached" || config.slow_threshold > 0);
+    const systemInfo_t& cache = use_cache ? load_cache(config) : systemInfo_t{};
+    const timings_t&    timings   = get_timings();
+
+    std::vector<std::string>                                 cached_modules;
+    std::vector<std::pair<std::string, std::vector<size_t>>> lanes;
+
+    // for on_line(): the tasks left of each line, and the lines with tags parsed only once everything is done
+    std::vector<size_t> line_tasks(layout.size(), 0);
+    std::vector<bool>   line_deferred(layout.size(), false), line_done(layout.size(), false);
+    for (size_t l = 0; l < layout.size(); ++l)
+    {
+        const std::string& line      = layout.at(l);
+        size_t             tag_start = 0;
+        while ((tag_start = line.find("$<", tag_start)) != line.npos)
+        {
+            const size_t end = line.find('>', tag_start);
+            if (end == line.npos)
+                break;
+
+            // the dot after the device name, e.g disk(/mnt/my.disk).used
+            const std::string& tag       = line.substr(tag_start + 2, end - tag_start - 2);
+            const size_t       closebrak = tag.find(')');
+            const size_t       dot_pos   = tag.find('.', closebrak == tag.npos ? 0 : closebrak);
+            tag_start                    = end + 1;
+
+            // the rate members share the sampler, and the nested tags get parsed later.
+            // Parsing them may construct any Query class, so their lines wait for the threads to be done
+            const std::vector<dynamic_tag_t>& dynamic_tags = get_dynamic_tags(fmt::format("$<{}>", tag));
+            if (dot_pos == tag.npos || tag.find('$') != tag.npos || hasStart(tag, "builtin.") ||
+                std::any_of(dynamic_tags.begin(), dynamic_tags.end(),
+                            [](const dynamic_tag_t& dynamic) { return dynamic.deps & DEP_SAMPLER; }))
+            {
+                line_deferred.at(l) = true;
+                continue;
+            }
+
+            task_t task;
+            task.module = tag.substr(0, dot_pos);
+            task.member = tag.substr(dot_pos + 1);
+
+            const auto& module = systemInfo.find(task.module);
+            if (module != systemInfo.end() && module->second.find(task.member) != module->second.end())
+                continue;
+
+            if (const auto& queued = std::find_if(state->tasks.begin(), state->tasks.end(),
+                                                  [&task](const task_t& queued) {
+                                                      return queued.module == task.module &&
+                                                             queued.member == task.member;
+                                                  });
+                queued != state->tasks.end())
+            {
+                if (std::find(queued->lines.begin(), queued->lines.end(), l) == queued->lines.end())
+                {
+                    queued->lines.push_back(l);
+                    ++line_tasks.at(l);
+                }
+                continue;
+            }
+
+            // too slow lately, the last value will do
+            if (is_slow(get_timing(timings, task.module), config.slow_threshold))
+            {
+                if (const auto& cached = cache.find(task.module); cached != cache.end())
+                {
+                    if (const auto& member = cached->second.find(task.member); member != cached->second.end())
+                    {
+                        systemInfo[task.module].insert(*member);
+                        if (std::find(cached_modules.begin(), cached_modules.end(), task.module) ==
+                            cached_modules.end())
+                            cached_modules.push_back(task.module);
+                        continue;
+                    }
+                }
+            }
+
+            const std::uint16_t deadline_ms = get_deadline_ms(config, task.module);
+            task.deadline = deadline_ms > 0 ? start + std::chrono::milliseconds(deadline_ms)
+                                            : clock_type::time_point::max();
+            if (config.render_deadline > 0)
+                task.deadline = std::min(task.deadline, g_start + std::chrono::milliseconds(config.render_deadline));
+
+            const std::string& lane = get_lane(task.module);
+            auto it = std::find_if(lanes.begin(), lanes.end(), [&lane](const auto& pair) { return pair.first == lane; });
+            if (it == lanes.end())
+                it = lanes.insert(lanes.end(), { lane, {} });
+
+            task.lines.push_back(l);
+            ++line_tasks.at(l);
+            it->second.push_back(state->tasks.size());
+            state->tasks.push_back(std::move(task));
+        }
+    }
+
+    // the lines with all their tasks done, or all the lines left when we're done
+    const auto& report_lines = [&](const bool all) {
+        if (!on_line)
+            return;
+
+        for (size_t l = 0; l < layout.size(); ++l)
+        {
+            if (line_done.at(l) || (!all && (line_tasks.at(l) > 0 || line_deferred.at(l))))
+                continue;
+
+            line_done.at(l) = true;
+            on_line(l);
+        }
+    };
+
+    // without deadlines they're queried here one after the other, just for recording their times
+    if (!enabled(config) && !on_line)
+    {
+        std::unordered_map<std::string, double> modules_ms;
+        for (const task_t& task : state->tasks)
+        {
+            const clock_type::time_point& started_at = clock_type::now();
+            parse(fmt::format("$<{}.{}>", task.module, task.member), systemInfo, config, colors, true);
+            modules_ms[task.module] += std::chrono::duration<double, std::milli>(clock_type::now() - started_at).count();
+        }
+
+        record_timings(config, modules_ms, {});
+        return true;
+    }
+
+    std::vector<std::string> served_cached;
+    for (const std::string& module : cached_modules)
+    {
+        // some of its members weren't cached, so it's queried anyway
+        if (std::any_of(state->tasks.begin(), state->tasks.end(),
+                        [&module](const task_t& task) { return task.module == module; }))
+            continue;
+
+        served_cached.push_back(module);
+        if (config.m_verbose)
+        {
+            const timing_t& timing = get_timing(timings, module);
+            info("module '{}' takes {:.1f} ms on average, using its cached values ({} more times)", module,
+                 timing.avg_ms, REFRESH_RUNS - timing.cached_runs - 1);
+        }
+    }
+
+    if (state->tasks.empty())
+    {
+        record_timings(config, {}, served_cached);
+        report_lines(true);
+        return true;
+    }
+
+    // the longest lanes first, by the recorded times of their modules
+    const auto& get_lane_ms = [&](const std::vector<size_t>& lane) {
+        std::vector<std::string> modules;
+        double                   ms = 0;
+        for (const size_t i : lane)
+        {
+            const std::string& module = state->tasks.at(i).module;
+            if (std::find(modules.begin(), modules.end(), module) != modules.end())
+                continue;
+            modules.push_back(module);
+            ms += get_timing(timings, module).avg_ms;
+        }
+        return ms;
+    };
+    std::stable_sort(lanes.begin(), lanes.end(), [&](const auto& a, const auto& b) {
+        return get_lane_ms(a.second) > get_lane_ms(b.second);
+    });
+    for (auto& [name, lane] : lanes)
+    {
+        // the theme probes (e.g gsettings or dconf) may hang, the cheap user members shouldn't wait behind them
+        std::stable_partition(lane.begin(), lane.end(),
+                              [&state](const size_t i) { return !hasStart(state->tasks.at(i).module, "theme"); });
+        state->lanes.push_back(lane);
+        state->lanes_name.push_back(name);
+    }
+
+    // it's detected once and for all, not by each thread
+    if (!config.m_disable_colors)
+        get_color_depth(config.color_depth);
+
+    const size_t workers_count =
+        std::min<size_t>(state->lanes.size(), std::max(MIN_WORKERS, std::thread::hardware_concurrency()));
+    for (size_t i = 0; i < workers_count; ++i)
+        std::thread(work, state).detach();
+
+    // e.g the ones with only $() commands, which run meanwhile
+    report_lines(false);
+
+    std::vector<bool>            stuck_lanes(state->lanes.size(), false);
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (true)
+    {
+        // the values done so far, for the lines that have all of them
+        bool ready = false;
+        for (task_t& task : state->tasks)
+        {
+            if (!task.done || task.merged)
+                continue;
+
+            task.merged = true;
+            if (const auto& module = state->results.find(task.module); module != state->results.end())
+                if (const auto& member = module->second.find(task.member); member != module->second.end())
+                    systemInfo[task.module].insert(*member);
+            for (const size_t l : task.lines)
+                ready |= --line_tasks.at(l) == 0 && !line_deferred.at(l);
+        }
+
+        if (ready && on_line)
+        {
+            lock.unlock();
+            report_lines(false);
+            lock.lock();
+            continue;
+        }
+
+        const clock_type::time_point& now     = clock_type::now();
+        clock_type::time_point        next    = clock_type::time_point::max();
+        bool                          pending = false;
+        for (size_t l = 0; l < state->lanes.size(); ++l)
+        {
+            const std::vector<size_t>& lane  = state->lanes.at(l);
+            bool                       stuck = false;
+            for (const size_t i : lane)
+            {
+                task_t& task = state->tasks.at(i);
+                if (task.done)
+                    continue;
+
+                if (!task.timed_out && !stuck && now < task.deadline)
+                {
+                    pending = true;
+                    next    = std::min(next, task.deadline);
+                    continue;
+                }
+
+                task.timed_out = true;
+                // the thread is stuck in it, the next ones of the lane would never start
+                stuck |= task.started;
+            }
+
+            // its worker won't take the lanes left, another one does
+            if (stuck && !stuck_lanes.at(l))
+            {
+                stuck_lanes.at(l) = true;
+                poison(state->lanes_name.at(l));
+                if (state->next_lane < state->lanes.size())
+                    std::thread(work, state).detach();
+            }
+        }
+
+        if (!pending || state->error)
+            break;
+
+        if (next == clock_type::time_point::max())
+            state->cv.wait(lock);
+        else
+            state->cv.wait_until(lock, next);
+    }
+
+    if (state->error)
+    {
+        // the lanes still running won't be waited for, like the stuck ones
+        state->next_lane = state->lanes.size();
+        for (size_t l = 0; l < state->lanes.size(); ++l)
+            if (std::any_of(state->lanes.at(l).begin(), state->lanes.at(l).end(), [&state](const size_t i) {
+                    return state->tasks.at(i).started && !state->tasks.at(i).done;
+                }))
+                poison(state->lanes_name.at(l));
+
+        const std::exception_ptr error = state->error;
+        lock.unlock();
+        try
+        {
+            std::rethrow_exception(error);
+        }
+        catch (const fatal_error& e)
+        {
+            // throws again in libcustomfetch
+            die("{}", e.what());
+        }
+    }
+
+    std::unordered_map<std::string, double> modules_ms;
+    std::vector<std::string>                timed_out_modules;
+    for (const task_t& task : state->tasks)
+    {
+        // the stuck ones count for at least how long we waited for them
+        if (task.done)
+            modules_ms[task.module] += task.ms;
+        else if (task.started)
+            modules_ms[task.module] +=
+                std::chrono::duration<double, std::milli>(clock_type::now() - task.started_at).count();
+
+        // if it's not in the results, parse() will tell why
+        if (task.done)
+        {
+            if (const auto& module = state->results.find(task.module); module != state->results.end())
+                if (const auto& member = module->second.find(task.member); member != module->second.end())
+                    systemInfo[task.module].insert(*member);
+            continue;
+        }
+
+        variant value = config.deadline_fallback == "hide" ? MAGIC_LINE : config.deadline_placeholder;
+        if (config.deadline_fallback == "cached")
+            if (const auto& module = cache.find(task.module); module != cache.end())
+                if (const auto& member = module->second.find(task.member); member != module->second.end())
+                    value = member->second;
+        systemInfo[task.module].insert({ task.member, std::move(value) });
+
+        if (std::find(timed_out_modules.begin(), timed_out_modules.end(), task.module) == timed_out_modules.end())
+        {
+            timed_out_modules.push_back(task.module);
+            if (config.m_verbose)
+                info("module '{}' timed out after {} ms, using {}", task.module,
+                     std::chrono::duration_cast<std::chrono::milliseconds>(task.deadline - start).count(),
+                     config.deadline_fallback == "hide" ? "nothing" : config.deadline_fallback);
+        }
+    }
+
+    record_timings(config, modules_ms, served_cached);
+
+    if (use_cache)
+        save_cache(config, cache, state->results);
+
+    report_lines(true);
+    return timed_out_modules.empty();
+}
+
+void explain(const Config& config)
+{
+    const timings_t& timings = load_timings();
+    if (timings.empty())
+    {
+        fmt::println("No module timings recorded in {} yet.\n"
+                     "They get recorded by each cufetch run (not by --daemon, --client or --from-snapshot)",
+                     get_timings_path());
+        return;
+    }
+
+    std::vector<std::pair<std::string, timing_t>> sorted(timings.begin(), timings.end());
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto& a, const auto& b) { return a.second.avg_ms > b.second.avg_ms; });
+
+    size_t width = std::string_view("module").length();
+    for (const auto& [module, timing] : sorted)
+        width = std::max(width, module.length());
+
+    fmt::println("Wall time of the modules, averaged over the last runs ({}):\n", get_timings_path());
+    fmt::println("{:<{}}  {:>10}  {:>10}  {:<8}  {}", "module", width, "average", "last", "lane", "mode");
+    for (const auto& [module, timing] : sorted)
+    {
+        std::string mode = "live";
+        if (is_slow(timing, config.slow_threshold))
+            mode = fmt::format("cached, over {} ms for {} runs (queried again in {} runs)", config.slow_threshold,
+                               timing.slow_runs, REFRESH_RUNS - timing.cached_runs);
+        else if (config.slow_threshold > 0 && timing.slow_runs > 0)
+            mode = fmt::format("live, over {} ms for {} runs (cached after {})", config.slow_threshold,
+                               timing.slow_runs, SLOW_RUNS);
+
+        fmt::println("{:<{}}  {:>7.1f} ms  {:>7.1f} ms  {:<8}  {}", module, width, timing.avg_ms, timing.last_ms,
+                     get_lane(module), mode);
+    }
+
+    fmt::println("\nThe lanes (modules sharing the same Query classes) with the longest average start first, "
+                 "on up to {} threads",
+                 std::max(MIN_WORKERS, std::thread::hardware_concurrency()));
+}
+
+}  // namespace Scheduler
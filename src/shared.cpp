@@ -0,0 +1,214 @@
+/* The values shared by the cufetch started at the same time, see Shared::get() */
+
+#include "shared.hpp"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "fmt/format.h"
+#include "parse.hpp"
+#include "scheduler.hpp"
+#include "snapshot.hpp"
+#include "util.hpp"
+
+// the values of a layout are a few KiBs in the snapshot encoding
+constexpr size_t DATA_SIZE = 256 * 1024;
+
+// how long the others wait for the run that queries the values, before querying them by themselves
+constexpr int WAIT_LEADER_MS = 3000;
+constexpr int WAIT_POLL_MS   = 2;
+
+// seq is odd while it's being written, the readers copy the rest and try again if seq changed meanwhile
+struct segment_t
+{
+    std::atomic<std::uint32_t> seq;
+    std::uint32_t              size;
+    std::uint64_t              key;
+    std::int64_t               time_ms;  // steady clock, the same for every process
+    char                       data[DATA_SIZE];
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+
+static std::int64_t now_ms()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// it's also the file we flock() for electing who queries the values
+static segment_t* open_segment(int& fd)
+{
+    const std::string& path = fmt::format("/dev/shm/customfetch-{}", getuid());
+
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd < 0)
+    {
+        debug("Failed to open the shared segment {}: {}", path, std::strerror(errno));
+        return nullptr;
+    }
+
+    // not ours, someone could feed us any values
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_uid != getuid() || (st.st_mode & 077) != 0 ||
+        (st.st_size < static_cast<off_t>(sizeof(segment_t)) && ftruncate(fd, sizeof(segment_t)) != 0))
+    {
+        debug("Can't use the shared segment {}", path);
+        close(fd);
+        return nullptr;
+    }
+
+    void* addr = mmap(nullptr, sizeof(segment_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        debug("Failed to map the shared segment {}: {}", path, std::strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+
+    return static_cast<segment_t*>(addr);
+}
+
+// copy the values if they're fresh and of our key, without locking
+static bool read_segment(const segment_t* segment, const std::uint64_t key, const std::uint16_t ttl,
+                         std::string& data)
+{
+    for (int tries = 0; tries < 100; ++tries)
+    {
+        const std::uint32_t seq = segment->seq.load(std::memory_order_acquire);
+        if (seq & 1)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        const std::uint64_t seg_key  = segment->key;
+        const std::int64_t  seg_time = segment->time_ms;
+        const std::uint32_t size     = segment->size;
+        const bool          fresh    = seg_key == key && size <= DATA_SIZE && now_ms() - seg_time < ttl;
+        if (fresh)
+            data.assign(segment->data, size);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (segment->seq.load(std::memory_order_relaxed) == seq)
+            return fresh;
+    }
+
+    return false;
+}
+
+// only called by who holds the exclusive flock(), so there's one writer at a time
+static void write_segment(segment_t* segment, const std::uint64_t key, const std::string& data)
+{
+    if (data.length() > DATA_SIZE)
+    {
+        debug("The shared values are too big ({} bytes)", data.length());
+        return;
+    }
+
+    const std::uint32_t seq = segment->seq.load(std::memory_order_relaxed);
+    segment->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    segment->size    = data.length();
+    segment->key     = key;
+    segment->time_ms = now_ms();
+    std::memcpy(segment->data, data.data(), data.length());
+
+    segment->seq.store(seq + 2, std::memory_order_release);
+}
+
+// the values that differ from one run to another
+static void erase_unshared(systemInfo_t& systemInfo, const std::vector<std::string>& layout)
+{
+    for (const std::string& line : layout)
+        for (const dynamic_tag_t& tag : get_dynamic_tags(line))
+            if (const auto& it = systemInfo.find(tag.module); it != systemInfo.end())
+                it->second.erase(tag.member);
+
+    // e.g a tmux pane and a tty, and the shell version comes from running it with the PATH of each run
+    if (const auto& it = systemInfo.find("user"); it != systemInfo.end())
+        std::erase_if(it->second, [](const auto& member) {
+            return hasStart(member.first, "terminal") || hasStart(member.first, "shell");
+        });
+}
+
+namespace Shared
+{
+
+systemInfo_t get(const Config& config, const colors_t& colors)
+{
+    if (config.m_shared_key == 0 || config.shared_results_ttl == 0)
+        return {};
+
+    int        fd      = -1;
+    segment_t* segment = open_segment(fd);
+    if (!segment)
+        return {};
+
+    const std::vector<std::string>& layout = config.m_args_layout.empty() ? config.layout : config.m_args_layout;
+
+    // not past the render deadline
+    const std::int64_t time_left = Scheduler::render_time_left(config);
+    const std::int64_t until =
+        now_ms() + (time_left >= 0 ? std::min<std::int64_t>(time_left, WAIT_LEADER_MS) : WAIT_LEADER_MS);
+
+    systemInfo_t systemInfo;
+    std::string  data;
+    while (true)
+    {
+        if (read_segment(segment, config.m_shared_key, config.shared_results_ttl, data))
+        {
+            debug("using the shared values");
+            systemInfo = Snapshot::decode(data, "shared values").systemInfo;
+            break;
+        }
+
+        // we're the first, the others wait for us
+        if (flock(fd, LOCK_EX | LOCK_NB) == 0)
+        {
+            if (read_segment(segment, config.m_shared_key, config.shared_results_ttl, data))
+            {
+                systemInfo = Snapshot::decode(data, "shared values").systemInfo;
+            }
+            else
+            {
+                debug("querying the shared values");
+                Scheduler::query(systemInfo, layout, config, colors);
+                erase_unshared(systemInfo, layout);
+                write_segment(segment, config.m_shared_key, Snapshot::encode({ "", "", systemInfo }));
+            }
+
+            flock(fd, LOCK_UN);
+            break;
+        }
+
+        // the first one may be stuck or rendering another config
+        if (now_ms() >= until)
+        {
+            debug("gave up waiting for the shared values");
+            break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(WAIT_POLL_MS));
+    }
+
+    munmap(segment, sizeof(segment_t));
+    close(fd);
+
+    erase_unshared(systemInfo, layout);
+    return systemInfo;
+}
+
+}  // namespace Shared
@@ -0,0 +1,338 @@
+#include "snapshot.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "display.hpp"
+#include "json.hpp"
+#include "parse.hpp"
+#include "query.hpp"
+#include "term_colors.hpp"
+#include "util.hpp"
+
+constexpr std::string_view MAGIC     = "CFSNAP";
+constexpr std::string_view EXTENSION = ".snapshot";
+
+enum value_type_t : std::uint8_t
+{
+    VALUE_STRING,
+    VALUE_SIZE,
+    VALUE_DOUBLE
+};
+
+// the numbers are little endian, whatever the host that dumped it
+static void put_num(std::string& out, const std::uint64_t n, const size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+        out += static_cast<char>(n >> (i * 8));
+}
+
+static void put_str(std::string& out, const std::string_view str)
+{
+    put_num(out, str.length(), sizeof(std::uint32_t));
+    out += str;
+}
+
+// thrown by Reader and try_decode(), for reporting what's wrong with the snapshot
+struct decode_error : public std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+};
+
+class Reader
+{
+public:
+    Reader(const std::string_view data, const std::string_view path) : m_data(data), m_path(path) {}
+
+    std::uint64_t num(const size_t size)
+    {
+        const std::string_view bytes = take(size);
+
+        std::uint64_t n = 0;
+        for (size_t i = 0; i < size; ++i)
+            n |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes.at(i))) << (i * 8);
+        return n;
+    }
+
+    std::string str()
+    { return std::string(take(num(sizeof(std::uint32_t)))); }
+
+    std::string_view take(const size_t len)
+    {
+        if (len > m_data.length() - m_pos)
+            throw decode_error(fmt::format("Snapshot '{}' is truncated or corrupted", m_path));
+
+        const std::string_view ret = m_data.substr(m_pos, len);
+        m_pos += len;
+        return ret;
+    }
+
+private:
+    std::string_view m_data;
+    std::string_view m_path;
+    size_t           m_pos = 0;
+};
+
+static bool try_load(const std::string& path, Snapshot::snapshot_t& snapshot, std::string& error)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        error = fmt::format("Could not open the snapshot '{}'", path);
+        return false;
+    }
+
+    const std::string data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    return Snapshot::try_decode(data, path, snapshot, error);
+}
+
+static Snapshot::snapshot_t load(const std::string& path)
+{
+    Snapshot::snapshot_t snapshot;
+    std::string          error;
+    if (!try_load(path, snapshot, error))
+        die("{}", error);
+
+    return snapshot;
+}
+
+// the module of each tag, e.g disk(/home) from $<disk(/home).used>
+static std::vector<std::string> get_layout_modules(const std::vector<std::string>& layout)
+{
+    std::vector<std::string> modules;
+    for (const std::string& line : layout)
+    {
+        size_t start = 0;
+        while ((start = line.find("$<", start)) != line.npos)
+        {
+            const size_t end = line.find('>', start);
+            if (end == line.npos)
+                break;
+
+            const std::string_view tag       = std::string_view(line).substr(start + 2, end - start - 2);
+            const size_t           closebrak = tag.find(')');
+            const size_t           dot_pos   = tag.find('.', closebrak == tag.npos ? 0 : closebrak);
+            const std::string      module(tag.substr(0, dot_pos));
+            if (std::find(modules.begin(), modules.end(), module) == modules.end())
+                modules.push_back(module);
+
+            start = end + 1;
+        }
+    }
+
+    return modules;
+}
+
+// render it as if it was on the host that dumped it
+static void prepare_config(Config& config, const Snapshot::snapshot_t& snapshot)
+{
+    // there's no GTK window to draw in
+    config.gui = false;
+
+    // the distro of the snapshot, not of this host
+    if (config.source_path == "os" && config.m_custom_distro.empty())
+    {
+        config.m_custom_distro = "linux";
+        for (const std::string& name : { snapshot.os_id, snapshot.os_name })
+        {
+            if (std::filesystem::exists(fmt::format("{}/ascii/{}.txt", config.data_dir, str_tolower(name))))
+            {
+                config.m_custom_distro = str_tolower(name);
+                break;
+            }
+        }
+    }
+}
+
+static std::vector<std::string> render_snapshot(Config& config, const colors_t& colors,
+                                                const Snapshot::snapshot_t& snapshot)
+{
+    prepare_config(config, snapshot);
+
+    const std::string& path = Display::get_source_path(config);
+    if (!config.m_disable_source && is_file_image(path))
+        config.m_disable_source = true;
+
+    clear_auto_colors();
+    return Display::render(config, colors, true, path, snapshot.systemInfo);
+}
+
+namespace Snapshot
+{
+
+std::string encode(const snapshot_t& snapshot)
+{
+    std::string out{ MAGIC };
+    put_num(out, FORMAT_VERSION, sizeof(FORMAT_VERSION));
+    put_str(out, snapshot.os_id);
+    put_str(out, snapshot.os_name);
+
+    std::uint32_t count = 0;
+    for (const auto& [module, members] : snapshot.systemInfo)
+        count += members.size();
+    put_num(out, count, sizeof(count));
+
+    for (const auto& [module, members] : snapshot.systemInfo)
+    {
+        for (const auto& [member, value] : members)
+        {
+            put_str(out, module);
+            put_str(out, member);
+            if (std::holds_alternative<std::string>(value))
+            {
+                put_num(out, VALUE_STRING, sizeof(value_type_t));
+                put_str(out, std::get<std::string>(value));
+            }
+            else if (std::holds_alternative<size_t>(value))
+            {
+                put_num(out, VALUE_SIZE, sizeof(value_type_t));
+                put_num(out, std::get<size_t>(value), sizeof(std::uint64_t));
+            }
+            else
+            {
+                put_num(out, VALUE_DOUBLE, sizeof(value_type_t));
+                put_num(out, std::bit_cast<std::uint64_t>(std::get<double>(value)), sizeof(std::uint64_t));
+            }
+        }
+    }
+
+    return out;
+}
+
+static snapshot_t decode_snapshot(const std::string_view data, const std::string_view name)
+{
+    Reader reader(data, name);
+    if (data.substr(0, MAGIC.length()) != MAGIC)
+        throw decode_error(fmt::format("'{}' is not a customfetch snapshot", name));
+    reader.take(MAGIC.length());
+
+    if (const std::uint16_t version = reader.num(sizeof(std::uint16_t)); version != FORMAT_VERSION)
+        throw decode_error(fmt::format("Snapshot '{}' is of version {}, only version {} is supported", name,
+                                       version, FORMAT_VERSION));
+
+    snapshot_t snapshot;
+    snapshot.os_id   = reader.str();
+    snapshot.os_name = reader.str();
+
+    for (std::uint32_t count = reader.num(sizeof(std::uint32_t)); count > 0; --count)
+    {
+        const std::string& module = reader.str();
+        const std::string& member = reader.str();
+        variant            value;
+        switch (reader.num(sizeof(value_type_t)))
+        {
+            case VALUE_STRING: value = reader.str(); break;
+            case VALUE_SIZE:   value = static_cast<size_t>(reader.num(sizeof(std::uint64_t))); break;
+            case VALUE_DOUBLE: value = std::bit_cast<double>(reader.num(sizeof(std::uint64_t))); break;
+            default:           throw decode_error(fmt::format("Snapshot '{}' is truncated or corrupted", name));
+        }
+
+        snapshot.systemInfo[module].insert({ member, std::move(value) });
+    }
+
+    return snapshot;
+}
+
+bool try_decode(const std::string_view data, const std::string_view name, snapshot_t& snapshot, std::string& error)
+{
+    try
+    {
+        snapshot = decode_snapshot(data, name);
+        return true;
+    }
+    catch (const decode_error& e)
+    {
+        error = e.what();
+        return false;
+    }
+}
+
+snapshot_t decode(const std::string_view data, const std::string_view name)
+{
+    snapshot_t  snapshot;
+    std::string error;
+    if (!try_decode(data, name, snapshot, error))
+        die("{}", error);
+
+    return snapshot;
+}
+
+void dump(const Config& config, const colors_t& colors, const std::string& path)
+{
+    const std::vector<std::string>& layout = config.m_args_layout.empty() ? config.layout : config.m_args_layout;
+
+    systemInfo_t systemInfo;
+    JSON::query(systemInfo, config, colors, get_layout_modules(layout));
+
+    // the members used in the layout that aren't in --format json, e.g used-GiB
+    for (const std::string& line : layout)
+        parse(line, systemInfo, config, colors, true);
+
+    // builtin is only the layout
+    systemInfo.erase("builtin");
+
+    Query::System system;
+    const std::string& out = encode({ system.os_id(), system.os_name(), std::move(systemInfo) });
+
+    if (path == "-" ? !write_all(STDOUT_FILENO, out) : !write_file_atomic(path, out))
+        die("Failed to write the snapshot '{}': {}", path, std::strerror(errno));
+}
+
+int render(const Config& config, const colors_t& colors)
+{
+    const std::string& path = config.m_from_snapshot;
+    if (!std::filesystem::is_directory(path))
+    {
+        Config render_config{ config };
+        Display::display(render_snapshot(render_config, colors, load(path)));
+        return 0;
+    }
+
+    std::vector<std::filesystem::path> snapshots;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(path))
+        if (entry.is_regular_file() && entry.path().extension() == EXTENSION)
+            snapshots.push_back(entry.path());
+
+    // it's detected once and for all
+    get_color_depth(config.color_depth);
+
+    // a bad snapshot is reported, the others still get rendered
+    std::atomic<bool> failed = false;
+    parallel_for(snapshots.size(), [&](const size_t i) {
+        Snapshot::snapshot_t snapshot;
+        std::string          load_error;
+        if (!try_load(snapshots.at(i).string(), snapshot, load_error))
+        {
+            error("{}", load_error);
+            failed = true;
+            return;
+        }
+
+        Config render_config{ config };
+        const std::string& output =
+            std::filesystem::path(snapshots.at(i)).replace_extension(".txt").string();
+        const std::string& frame = Display::to_string(render_snapshot(render_config, colors, std::move(snapshot)));
+
+        if (!write_file_atomic(output, frame))
+        {
+            error("Failed to write '{}': {}", output, std::strerror(errno));
+            failed = true;
+        }
+    });
+
+    return failed ? 1 : 0;
+}
+
+}  // namespace Snapshot
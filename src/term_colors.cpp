@@ -0,0 +1,533 @@
+/* Implementation of the terminal colors detection and the colors downsampling */
+
+#include "term_colors.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include "display_width.hpp"
+#include "fmt/format.h"
+#include "switch_fnv1a.hpp"
+#include "util.hpp"
+
+// the 6 values of each channel in the 256 colors cube (16-231)
+constexpr std::array<std::uint8_t, 6> cube_levels = { 0, 95, 135, 175, 215, 255 };
+
+// xterm default colors of the ANSI 16 palette
+constexpr std::array<std::uint32_t, 16> ansi16_palette = {
+    0x000000, 0xcd0000, 0x00cd00, 0xcdcd00, 0x0000ee, 0xcd00cd, 0x00cdcd, 0xe5e5e5,
+    0x7f7f7f, 0xff0000, 0x00ff00, 0xffff00, 0x5c5cff, 0xff00ff, 0x00ffff, 0xffffff,
+};
+
+static constexpr int sq(const int n)
+{ return n * n; }
+
+// channel value -> index of the nearest level in the colors cube
+static constexpr std::array<std::uint8_t, 256> cube_index = []() {
+    std::array<std::uint8_t, 256> ret{};
+    for (int v = 0; v < 256; ++v)
+    {
+        std::uint8_t best = 0;
+        for (std::uint8_t i = 1; i < cube_levels.size(); ++i)
+            if (sq(v - cube_levels[i]) < sq(v - cube_levels[best]))
+                best = i;
+        ret[v] = best;
+    }
+    return ret;
+}();
+
+// gray value -> index of the nearest level in the grayscale ramp (232-255, from 8 to 238 by 10)
+static constexpr std::array<std::uint8_t, 256> gray_index = []() {
+    std::array<std::uint8_t, 256> ret{};
+    for (int v = 0; v < 256; ++v)
+        ret[v] = static_cast<std::uint8_t>(v < 8 ? 0 : v > 238 ? 23 : (v - 3) / 10);
+    return ret;
+}();
+
+// 4 bits per channel -> nearest color of the ANSI 16 palette
+static constexpr std::array<std::uint8_t, 4096> ansi16_index = []() {
+    std::array<std::uint8_t, 4096> ret{};
+    for (int i = 0; i < 4096; ++i)
+    {
+        // the center of the cell
+        const int r = ((i >> 8) << 4) | 8, g = (((i >> 4) & 0xf) << 4) | 8, b = ((i & 0xf) << 4) | 8;
+
+        std::uint8_t best      = 0;
+        int          best_dist = -1;
+        for (std::uint8_t c = 0; c < ansi16_palette.size(); ++c)
+        {
+            const int dist = sq(r - static_cast<int>(ansi16_palette[c] >> 16)) +
+                             sq(g - static_cast<int>((ansi16_palette[c] >> 8) & 0xff)) +
+                             sq(b - static_cast<int>(ansi16_palette[c] & 0xff));
+            if (best_dist < 0 || dist < best_dist)
+            {
+                best      = c;
+                best_dist = dist;
+            }
+        }
+        ret[i] = best;
+    }
+    return ret;
+}();
+
+static std::uint8_t rgb_to_256(const fmt::rgb rgb)
+{
+    const std::uint8_t ri = cube_index[rgb.r], gi = cube_index[rgb.g], bi = cube_index[rgb.b];
+    const int cube_dist = sq(rgb.r - cube_levels[ri]) + sq(rgb.g - cube_levels[gi]) + sq(rgb.b - cube_levels[bi]);
+
+    const std::uint8_t gi_ramp   = gray_index[(rgb.r + rgb.g + rgb.b) / 3];
+    const int          gray      = 8 + gi_ramp * 10;
+    const int          gray_dist = sq(rgb.r - gray) + sq(rgb.g - gray) + sq(rgb.b - gray);
+
+    if (gray_dist < cube_dist)
+        return 232 + gi_ramp;
+
+    return 16 + 36 * ri + 6 * gi + bi;
+}
+
+static std::uint8_t rgb_to_16(const fmt::rgb rgb)
+{ return ansi16_index[((rgb.r >> 4) << 8) | ((rgb.g >> 4) << 4) | (rgb.b >> 4)]; }
+
+// https://invisible-island.net/ncurses/man/term.5.html
+// returns -1 if the terminal entry couldn't be read
+static int get_terminfo_colors(const std::string_view term)
+{
+    std::vector<std::string> dirs;
+    if (const char* env = std::getenv("TERMINFO"))
+        dirs.push_back(env);
+
+    dirs.push_back(expandVar("~/.terminfo"));
+    if (const char* env = std::getenv("TERMINFO_DIRS"))
+        for (const std::string& dir : split(env, ':'))
+            dirs.push_back(dir.empty() ? "/usr/share/terminfo" : dir);
+
+    for (const char* dir : { "/etc/terminfo", "/lib/terminfo", "/usr/share/terminfo" })
+        dirs.push_back(dir);
+
+    for (const std::string& dir : dirs)
+    {
+        // "x/xterm", or "78/xterm" on case-insensitive filesystems
+        std::ifstream f(fmt::format("{}/{}/{}", dir, term.front(), term), std::ios::binary);
+        if (!f.is_open())
+            f.open(fmt::format("{}/{:x}/{}", dir, term.front(), term), std::ios::binary);
+        if (!f.is_open())
+            continue;
+
+        // magic, names size, bools count, numbers count, strings count, strings table size
+        std::array<unsigned char, 12> header;
+        if (!f.read(reinterpret_cast<char*>(header.data()), header.size()))
+            return -1;
+
+        const auto& read_i16 = [&header](const size_t i) { return header[i * 2] | (header[i * 2 + 1] << 8); };
+        const int   magic    = read_i16(0);
+        if (magic != 0432 && magic != 01036)
+            return -1;
+
+        // the extended format has 32 bits numbers
+        const size_t number_size = magic == 01036 ? 4 : 2;
+        const size_t names_size = read_i16(1), bools_count = read_i16(2), numbers_count = read_i16(3);
+
+        // "colors" is the 14th number, a terminal without the capability (e.g vt100) is monochrome
+        constexpr size_t colors_index = 13;
+        if (numbers_count <= colors_index)
+            return 0;
+
+        // the numbers are aligned to an even byte
+        const size_t numbers_start = header.size() + names_size + bools_count + ((names_size + bools_count) % 2);
+        std::array<unsigned char, 4> number{};
+        f.seekg(numbers_start + colors_index * number_size);
+        if (!f.read(reinterpret_cast<char*>(number.data()), number_size))
+            return -1;
+
+        const int colors = number_size == 2
+                               ? static_cast<std::int16_t>(number[0] | (number[1] << 8))
+                               : static_cast<std::int32_t>(number[0] | (number[1] << 8) | (number[2] << 16) | (number[3] << 24));
+
+        return colors < 0 ? 0 : colors;
+    }
+
+    return -1;
+}
+
+static color_depth_t detect_color_depth()
+{
+    const char* colorterm = std::getenv("COLORTERM");
+    if (colorterm && (std::string_view(colorterm) == "truecolor" || std::string_view(colorterm) == "24bit"))
+        return COLOR_DEPTH_TRUECOLOR;
+
+    // no terminal to ask (e.g piped to a file), keep the colors as they are
+    const char* term_env = std::getenv("TERM");
+    if (!term_env || !*term_env)
+        return COLOR_DEPTH_TRUECOLOR;
+
+    const std::string_view term = term_env;
+    if (term.find("-direct") != std::string_view::npos || hasEnding(term, "truecolor"))
+        return COLOR_DEPTH_TRUECOLOR;
+
+    if (hasEnding(term, "256color"))
+        return COLOR_DEPTH_256;
+
+    const int colors = get_terminfo_colors(term);
+    debug("terminfo colors of {} = {}", term, colors);
+    if (colors < 0 || colors >= (1 << 24))
+        return COLOR_DEPTH_TRUECOLOR;
+
+    return colors >= 256 ? COLOR_DEPTH_256 : COLOR_DEPTH_16;
+}
+
+color_depth_t get_color_depth(const std::string_view depth)
+{
+    switch (fnv1a16::hash(str_tolower(std::string(depth))))
+    {
+        case "truecolor"_fnv1a16:
+        case "24bit"_fnv1a16:     return COLOR_DEPTH_TRUECOLOR;
+        case "256"_fnv1a16:       return COLOR_DEPTH_256;
+        case "16"_fnv1a16:        return COLOR_DEPTH_16;
+        case "auto"_fnv1a16:      break;
+        default:
+        {
+            static std::once_flag warned;
+            std::call_once(warned, [depth]() {
+                warn("Invalid color depth '{}', only 'auto', 'truecolor', '256' and '16' are supported", depth);
+            });
+        }
+    }
+
+    // the terminal is the same for every render
+    static const color_depth_t detected = detect_color_depth();
+    debug("color depth = {}", static_cast<int>(detected));
+    return detected;
+}
+
+std::string get_color_sgr(const fmt::rgb rgb, const bool bg, const color_depth_t depth)
+{
+    switch (depth)
+    {
+        case COLOR_DEPTH_16:
+        {
+            const std::uint8_t i = rgb_to_16(rgb);
+            // 30-37 and 90-97 for foreground, 40-47 and 100-107 for background
+            return fmt::format("\033[{}m", (i < 8 ? 30 : 82) + (bg ? 10 : 0) + i);
+        }
+
+        case COLOR_DEPTH_256:
+            return fmt::format("\033[{};5;{}m", bg ? 48 : 38, rgb_to_256(rgb));
+
+        default:
+            return fmt::format("\033[{};2;{};{};{}m", bg ? 48 : 38, rgb.r, rgb.g, rgb.b);
+    }
+}
+
+constexpr std::uint16_t SGR_BOLD_DIM = (1 << 1) | (1 << 2);
+
+// normalizes the number (e.g "038" -> "38"),
+// returns -1 if it's not a plain number (e.g "4:3")
+static int sgr_number(const std::string_view param)
+{
+    if (param.empty())
+        return 0;
+
+    int n = -1;
+    const auto& [ptr, ec] = std::from_chars(param.data(), param.data() + param.length(), n);
+    if (ec != std::errc() || ptr != param.data() + param.length())
+        return -1;
+
+    return n;
+}
+
+// applies the parameters of a SGR sequence (what's between "\033[" and "m") to the state
+static void apply_sgr(const std::string_view sequence, sgr_state_t& state)
+{
+    std::vector<std::string_view> params;
+    for (size_t start = 0, end;; start = end + 1)
+    {
+        end = sequence.find(';', start);
+        params.push_back(sequence.substr(start, end - start));
+        if (end == std::string_view::npos)
+            break;
+    }
+
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+        const int n = sgr_number(params.at(i));
+        if ((n >= 30 && n <= 37) || (n >= 90 && n <= 97))
+        {
+            state.fg = fmt::to_string(n);
+            continue;
+        }
+        if ((n >= 40 && n <= 47) || (n >= 100 && n <= 107))
+        {
+            state.bg = fmt::to_string(n);
+            continue;
+        }
+
+        switch (n)
+        {
+            case 0: state = {}; break;
+
+            case 1: case 2: case 3: case 4: case 5: case 7: case 8: case 9:
+                state.attributes |= 1 << n; break;
+
+            case 22:
+                state.attributes &= ~SGR_BOLD_DIM; break;
+
+            case 23: case 24: case 25: case 27: case 28: case 29:
+                state.attributes &= ~(1 << (n - 20)); break;
+
+            case 39: state.fg.clear(); break;
+            case 49: state.bg.clear(); break;
+
+            case 38:
+            case 48:
+            {
+                std::string& color = n == 38 ? state.fg : state.bg;
+                const int    type  = i + 1 < params.size() ? sgr_number(params.at(i + 1)) : -1;
+                if (type == 5 && i + 2 < params.size())
+                {
+                    color = fmt::format("{};5;{}", n, sgr_number(params.at(i + 2)));
+                    i += 2;
+                }
+                else if (type == 2 && i + 4 < params.size())
+                {
+                    color = fmt::format("{};2;{};{};{}", n, sgr_number(params.at(i + 2)), sgr_number(params.at(i + 3)),
+                                        sgr_number(params.at(i + 4)));
+                    i += 4;
+                }
+            } break;
+
+            default:
+            {
+                const std::string& param = n < 0 ? std::string(params.at(i)) : fmt::to_string(n);
+                if (std::find(state.others.begin(), state.others.end(), param) == state.others.end())
+                    state.others.push_back(param);
+            }
+        }
+    }
+}
+
+// the parameters for setting the whole state after a reset
+static std::string sgr_state_params(const sgr_state_t& state)
+{
+    std::string ret;
+    for (int n = 1; n <= 9; ++n)
+        if (state.attributes & (1 << n))
+            ret += fmt::format(";{}", n);
+
+    if (!state.fg.empty())
+        ret += ';' + state.fg;
+    if (!state.bg.empty())
+        ret += ';' + state.bg;
+
+    for (const std::string& param : state.others)
+        ret += ';' + param;
+
+    return ret;
+}
+
+// the shortest parameters to go from a state to another
+static std::string sgr_transition(const sgr_state_t& from, const sgr_state_t& to)
+{
+    const std::string& reset = "0" + sgr_state_params(to);
+
+    // the other parameters can't be turned off without a reset
+    if (from.others.size() > to.others.size() || !std::equal(from.others.begin(), from.others.end(), to.others.begin()))
+        return reset;
+
+    std::string         ret;
+    const std::uint16_t off = from.attributes & ~to.attributes;
+    std::uint16_t       on  = to.attributes & ~from.attributes;
+
+    // 22 turns off both bold and dim, so the one that stays has to be set again
+    if (off & SGR_BOLD_DIM)
+    {
+        ret += ";22";
+        on |= to.attributes & SGR_BOLD_DIM;
+    }
+
+    for (int n = 3; n <= 9; ++n)
+        if (off & (1 << n))
+            ret += fmt::format(";{}", n + 20);
+
+    for (int n = 1; n <= 9; ++n)
+        if (on & (1 << n))
+            ret += fmt::format(";{}", n);
+
+    if (from.fg != to.fg)
+        ret += to.fg.empty() ? ";39" : ';' + to.fg;
+    if (from.bg != to.bg)
+        ret += to.bg.empty() ? ";49" : ';' + to.bg;
+
+    for (size_t i = from.others.size(); i < to.others.size(); ++i)
+        ret += ';' + to.others.at(i);
+
+    // without the first ';'
+    return ret.length() - 1 < reset.length() ? ret.substr(1) : reset;
+}
+
+// if spaces are rendered the same with both states
+static bool same_on_spaces(const sgr_state_t& a, const sgr_state_t& b)
+{
+    // underline, reverse and strikethrough
+    constexpr std::uint16_t visible_on_spaces = (1 << 4) | (1 << 7) | (1 << 9);
+    constexpr std::uint16_t reverse           = 1 << 7;
+
+    // with reverse video the foreground color is the background of the cell
+    if (((a.attributes | b.attributes) & reverse) && a.fg != b.fg)
+        return false;
+
+    return (a.attributes & visible_on_spaces) == (b.attributes & visible_on_spaces) &&
+           a.bg == b.bg && a.others == b.others;
+}
+
+void minimize_sgr(std::string& line, sgr_state_t& state)
+{
+    std::string ret;
+    ret.reserve(line.length());
+
+    // the state after the sequences read so far, which is emitted only before some text
+    sgr_state_t target = state;
+    const auto& flush  = [&]() {
+        if (target == state)
+            return;
+
+        ret += "\033[" + sgr_transition(state, target) + 'm';
+        state = target;
+    };
+
+    for (size_t i = 0; i < line.length(); ++i)
+    {
+        if (line[i] == '\033' && i + 1 < line.length() && line[i + 1] == '[')
+        {
+            // CSI parameters bytes are in the range 0x30-0x3F
+            size_t end = i + 2;
+            while (end < line.length() && line[end] >= 0x30 && line[end] <= 0x3F)
+                ++end;
+
+            if (end < line.length() && line[end] == 'm')
+            {
+                apply_sgr(std::string_view(line).substr(i + 2, end - i - 2), target);
+                i = end;
+                continue;
+            }
+        }
+
+        // a space looks the same with any foreground color, bold, italic, ...
+        // so there's no need to emit the sequences before it
+        if (line[i] != ' ' || !same_on_spaces(state, target))
+            flush();
+
+        ret += line[i];
+    }
+
+    flush();
+    line = std::move(ret);
+}
+
+// a character on the terminal, with the rendition it's printed with
+struct cell_t
+{
+    std::string text;
+    sgr_state_t state;
+    size_t      col;
+};
+
+static bool same_cell(const cell_t& a, const cell_t& b)
+{
+    if (a.col != b.col || a.text != b.text)
+        return false;
+
+    return a.text == " " ? same_on_spaces(a.state, b.state) : a.state == b.state;
+}
+
+// the cells of a line, and its width
+static size_t split_cells(const std::string_view line, std::vector<cell_t>& cells)
+{
+    sgr_state_t state;
+    size_t      col = 0;
+    for (size_t i = 0; i < line.length();)
+    {
+        if (line[i] == '\033' && i + 1 < line.length() && line[i + 1] == '[')
+        {
+            size_t end = i + 2;
+            while (end < line.length() && line[end] >= 0x30 && line[end] <= 0x3F)
+                ++end;
+
+            // other sequences than SGR don't take any cell
+            if (end < line.length() && line[end] == 'm')
+                apply_sgr(line.substr(i + 2, end - i - 2), state);
+
+            i = end + 1;
+            continue;
+        }
+
+        // the length of the UTF-8 character from its first byte
+        const unsigned char byte = line[i];
+        const size_t        len  = std::min(line.length() - i, static_cast<size_t>(byte < 0xC0   ? 1
+                                                                                  : byte < 0xE0 ? 2
+                                                                                  : byte < 0xF0 ? 3
+                                                                                                : 4));
+
+        const std::string_view ch    = line.substr(i, len);
+        const size_t           width = display_width(ch);
+
+        // combining marks go with the character before them
+        if (width == 0 && !cells.empty())
+            cells.back().text += ch;
+        else
+            cells.push_back({ std::string(ch), state, col });
+
+        col += width;
+        i += len;
+    }
+
+    return col;
+}
+
+std::string diff_line(const std::string_view from, const std::string_view to, const size_t row)
+{
+    std::vector<cell_t> from_cells, to_cells;
+    const size_t        from_width = split_cells(from, from_cells);
+    const size_t        to_width   = split_cells(to, to_cells);
+
+    size_t first = 0;
+    while (first < from_cells.size() && first < to_cells.size() && same_cell(from_cells[first], to_cells[first]))
+        ++first;
+
+    if (first == from_cells.size() && first == to_cells.size())
+        return {};
+
+    // the cells at the end that are still in the same place, e.g " GiB" after a number of the same length
+    size_t from_end = from_cells.size(), to_end = to_cells.size();
+    while (from_end > first && to_end > first && same_cell(from_cells[from_end - 1], to_cells[to_end - 1]))
+    {
+        --from_end;
+        --to_end;
+    }
+
+    const size_t col = first < to_cells.size() ? to_cells[first].col : to_width;
+    std::string  ret = fmt::format("\033[{};{}H", row + 1, col + 1);
+
+    std::string cells;
+    for (size_t i = first; i < to_end; ++i)
+    {
+        cells += "\033[0" + sgr_state_params(to_cells[i].state) + 'm';
+        cells += to_cells[i].text;
+    }
+
+    sgr_state_t state;
+    minimize_sgr(cells, state);
+    ret += cells;
+    if (state != sgr_state_t{})
+        ret += "\033[0m";
+
+    // the new line is shorter, clear what's left of the old one
+    if (to_width < from_width)
+        ret += "\033[K";
+
+    return ret;
+}
@@ -7,7 +7,10 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <cmath>
 #include <cerrno>
+#include <cstdio>
 #include <cstdint>
 #include <cstring>
 #include <filesystem>
@@ -17,6 +20,7 @@
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <tuple>
 #include <vector>
 
@@ -142,17 +146,26 @@ byte_units_t auto_devide_bytes(const double num, const std::uint16_t base, const
 
 byte_units_t devide_bytes(const double num, const std::string_view prefix)
 {
-    if (prefix != "B")
-    {
-        // GiB
-        // 012
-        if (prefix.size() == 3 && prefix.at(1) == 'i')
-            return auto_devide_bytes(num, 1024, prefix);
-        else
-            return auto_devide_bytes(num, 1000, prefix);
-    }
+    // GiB
+    // 012
+    const std::uint16_t base = (prefix.size() == 3 && prefix.at(1) == 'i') ? 1024 : 1000;
+
+    // always divide until the prefix, e.g 512 MiB in GiB is 0.5,
+    // unlike auto_devide_bytes() which stops when the number gets smaller than the base
+    constexpr std::string_view prefixes = "BKMGTPEZY";
+    const size_t               exponent = prefixes.find(std::toupper(prefix.front()));
+    if (exponent == prefixes.npos)
+        return { "B", num };
+
+    return { prefix.data(), num / std::pow(base, exponent) };
+}
 
-    return auto_devide_bytes(num, 0);
+bool is_file_image(const std::string_view path)
+{
+    std::ifstream                 file(path.data(), std::ios::binary);
+    std::array<unsigned char, 32> buffer{};
+    file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    return is_file_image(buffer.data());
 }
 
 bool is_file_image(const unsigned char* bytes)
@@ -432,6 +445,98 @@ std::string str_toupper(std::string str)
     return str;
 }
 
+// https://www.json.org/json-en.html
+void json_escape(std::string& out, const std::string_view str)
+{
+    for (const char c : str)
+    {
+        switch (c)
+        {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                    out += fmt::format("\\u{:04x}", static_cast<int>(c));
+                else
+                    out += c;
+        }
+    }
+}
+
+bool write_all(const int fd, const std::string_view str)
+{
+    for (size_t written = 0; written < str.length();)
+    {
+        const ssize_t ret = write(fd, str.data() + written, str.length() - written);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            return false;
+        }
+
+        written += ret;
+    }
+
+    return true;
+}
+
+// write to a temporary file then rename it, so whoever reads it never sees it half written.
+// The temporary file is our own (e.g the cufetch started at the same time write the same timings)
+bool write_file_atomic(const std::string& path, const std::string_view str, const mode_t mode)
+{
+    static std::atomic<unsigned> counter = 0;
+
+    std::string tmp;
+    int         fd = -1;
+    for (int i = 0; i < 16 && fd < 0; ++i)
+    {
+        // one of a dead process with the same pid may still be there
+        tmp = fmt::format("{}.{}.{}.tmp", path, getpid(), counter++);
+        fd  = open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, mode);
+        if (fd < 0 && errno != EEXIST)
+            return false;
+    }
+    if (fd < 0)
+        return false;
+
+    const bool written = write_all(fd, str);
+    if (close(fd) != 0 || !written || std::rename(tmp.c_str(), path.c_str()) != 0)
+    {
+        const int err = errno;
+        unlink(tmp.c_str());
+        errno = err;
+        return false;
+    }
+
+    return true;
+}
+
+// call fn(i) for each i in [0, count), on a thread for each CPU
+void parallel_for(const size_t count, const std::function<void(size_t i)>& fn)
+{
+    const size_t threads_count = std::min<size_t>(count, std::max<size_t>(1, std::thread::hardware_concurrency()));
+
+    std::atomic<size_t> next = 0;
+    const auto&         work = [&]() {
+        for (size_t i; (i = next++) < count;)
+            fn(i);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threads_count; ++i)
+        threads.emplace_back(work);
+    work();
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
 // Function to perform binary search on the pci vendors array to find a device from a vendor.
 std::string binarySearchPCIArray(const std::string_view vendor_id_s, const std::string_view pci_id_s)
 {
@@ -605,3 +710,34 @@ std::string getHomeConfigDir()
  */
 std::string getConfigDir()
 { return getHomeConfigDir() + "/customfetch"; }
+
+/*
+ * Get the user cache directory
+ * either from $XDG_CACHE_HOME or from $HOME/.cache/
+ * @return user's cache directory
+ */
+std::string getHomeCacheDir()
+{
+    const char* dir = std::getenv("XDG_CACHE_HOME");
+    if (dir != NULL && dir[0] != '\0' && std::filesystem::exists(dir))
+    {
+        std::string str_dir(dir);
+        return str_dir.back() == '/' ? str_dir.substr(0, str_dir.rfind('/')) : str_dir;
+    }
+    else
+    {
+        const char* home = std::getenv("HOME");
+        if (home == nullptr)
+            die("Failed to find $HOME, set it to your home directory!");
+
+        return std::string(home) + "/.cache";
+    }
+}
+
+/*
+ * Get the customfetch cache directory
+ * from getHomeCacheDir()
+ * @return customfetch's cache directory
+ */
+std::string getCacheDir()
+{ return getHomeCacheDir() + "/customfetch"; }